@@ -0,0 +1,204 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "approximate_transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+namespace OpenOrienteering {
+
+ApproximateTransform::ApproximateTransform(Function exact, const QRectF& domain, double max_error, int max_depth)
+: exact(std::move(exact))
+, grid_domain(domain.normalized())
+, max_error(max_error)
+, grid_size(2u << qBound(0, max_depth, 20))
+{
+	// The finest cells have a size of two units, so that the midpoints
+	// of their edges are on the grid, too.
+	if (grid_domain.width() > 0 && grid_domain.height() > 0)
+	{
+		cells.push_back({ 0, 0, grid_size });
+	}
+}
+
+ApproximateTransform::~ApproximateTransform() = default;
+
+
+
+bool ApproximateTransform::transform(const QPointF& in, QPointF& out)
+{
+	if (cells.empty() || !grid_domain.contains(in))
+		return evaluate(in, out);
+	
+	auto const grid_pos = QPointF {
+	    (in.x() - grid_domain.left()) * grid_size / grid_domain.width(),
+	    (in.y() - grid_domain.top()) * grid_size / grid_domain.height()
+	};
+	
+	std::size_t index = 0;
+	for (;;)
+	{
+		if (cells[index].state == Cell::Unchecked)
+			check(index);
+		
+		const auto& cell = cells[index];
+		switch (cell.state)
+		{
+		case Cell::Interpolated:
+			out = interpolate(cell, grid_pos);
+			return true;
+		
+		case Cell::Subdivided:
+		{
+			auto const half = cell.size / 2;
+			index = cell.children;
+			if (grid_pos.x() >= cell.x + half)
+				index += 1;
+			if (grid_pos.y() >= cell.y + half)
+				index += 2;
+			break;
+		}
+		
+		case Cell::Unchecked:
+			Q_UNREACHABLE();
+		
+		case Cell::Exact:
+			return evaluate(in, out);
+		}
+	}
+}
+
+
+bool ApproximateTransform::transform(const std::vector<QPointF>& in, std::vector<QPointF>& out)
+{
+	out.resize(in.size());
+	auto success = true;
+	for (std::size_t i = 0; i < in.size(); ++i)
+	{
+		if (!transform(in[i], out[i]))
+			success = false;
+	}
+	return success;
+}
+
+
+
+const ApproximateTransform::ControlPoint& ApproximateTransform::controlPoint(quint32 x, quint32 y)
+{
+	auto const key = quint64(x) * (grid_size + 1) + y;
+	auto found = control_points.find(key);
+	if (found == end(control_points))
+	{
+		ControlPoint point;
+		point.valid = evaluate(toDomain(x, y), point.value);
+		found = control_points.emplace(key, point).first;
+	}
+	return found->second;
+}
+
+
+QPointF ApproximateTransform::interpolate(const Cell& cell, const QPointF& grid_pos)
+{
+	auto const u = (grid_pos.x() - cell.x) / cell.size;
+	auto const v = (grid_pos.y() - cell.y) / cell.size;
+	auto const& p00 = controlPoint(cell.x, cell.y).value;
+	auto const& p10 = controlPoint(cell.x + cell.size, cell.y).value;
+	auto const& p01 = controlPoint(cell.x, cell.y + cell.size).value;
+	auto const& p11 = controlPoint(cell.x + cell.size, cell.y + cell.size).value;
+	return (1 - v) * ((1 - u) * p00 + u * p10) + v * ((1 - u) * p01 + u * p11);
+}
+
+
+void ApproximateTransform::check(std::size_t index)
+{
+	// Copy: cells may grow.
+	auto const cell = cells[index];
+	auto const x0 = cell.x;
+	auto const y0 = cell.y;
+	auto const x1 = cell.x + cell.size;
+	auto const y1 = cell.y + cell.size;
+	
+	auto const& p00 = controlPoint(x0, y0);
+	auto const& p10 = controlPoint(x1, y0);
+	auto const& p01 = controlPoint(x0, y1);
+	auto const& p11 = controlPoint(x1, y1);
+	if (!p00.valid || !p10.valid || !p01.valid || !p11.valid)
+	{
+		cells[index].state = Cell::Exact;
+		return;
+	}
+	
+	// At the midpoints, bilinear interpolation is just the mean.
+	auto const half = cell.size / 2;
+	struct { quint32 x, y; QPointF interpolated; } const tests[] = {
+	    { x0 + half, y0,        (p00.value + p10.value) / 2 },
+	    { x0,        y0 + half, (p00.value + p01.value) / 2 },
+	    { x1,        y0 + half, (p10.value + p11.value) / 2 },
+	    { x0 + half, y1,        (p01.value + p11.value) / 2 },
+	    { x0 + half, y0 + half, (p00.value + p10.value + p01.value + p11.value) / 4 },
+	};
+	auto const tolerance = max_error / 2;
+	auto const accurate = std::all_of(std::begin(tests), std::end(tests), [this, tolerance](const auto& test) {
+		const auto& exact = controlPoint(test.x, test.y);
+		if (!exact.valid)
+			return false;
+		auto const error = exact.value - test.interpolated;
+		return std::hypot(error.x(), error.y()) <= tolerance;
+	});
+	
+	if (accurate)
+	{
+		cells[index].state = Cell::Interpolated;
+	}
+	else if (half < 2)
+	{
+		cells[index].state = Cell::Exact;
+	}
+	else
+	{
+		auto const children = quint32(cells.size());
+		cells.push_back({ x0,        y0,        half });
+		cells.push_back({ x0 + half, y0,        half });
+		cells.push_back({ x0,        y0 + half, half });
+		cells.push_back({ x0 + half, y0 + half, half });
+		cells[index].children = children;
+		cells[index].state = Cell::Subdivided;
+	}
+}
+
+
+bool ApproximateTransform::evaluate(const QPointF& in, QPointF& out)
+{
+	++exact_evaluations;
+	return exact(in, out);
+}
+
+
+QPointF ApproximateTransform::toDomain(double x, double y) const
+{
+	return { grid_domain.left() + grid_domain.width() * x / grid_size,
+	         grid_domain.top() + grid_domain.height() * y / grid_size };
+}
+
+
+}  // namespace OpenOrienteering
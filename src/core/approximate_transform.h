@@ -0,0 +1,164 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_APPROXIMATE_TRANSFORM_H
+#define OPENORIENTEERING_APPROXIMATE_TRANSFORM_H
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <QtGlobal>
+#include <QPointF>
+#include <QRectF>
+
+namespace OpenOrienteering {
+
+
+/**
+ * An approximation of an expensive coordinate transformation, with an
+ * estimated error bound.
+ * 
+ * The approximation interpolates bilinearly between exact control points on
+ * a grid over a rectangular domain. The grid is refined lazily, as a quadtree:
+ * When a point is transformed for the first time in a cell, the exact
+ * transformation is evaluated at the cell's center and edge midpoints. If the
+ * interpolation deviates by more than half the maximum error at any of these
+ * points, the cell is subdivided. Cells which reach the maximum depth without
+ * meeting the error bound use the exact transformation.
+ * 
+ * The error bound is an estimate: Only these five points per cell are
+ * checked. For the smooth transformations between coordinate reference
+ * systems, this is a good estimate of the interpolation error. Points outside
+ * of the domain also use the exact transformation.
+ * 
+ * This class is meant for bulk conversion of coordinates for display, such as
+ * reprojecting tracks or vector data. It is not thread-safe.
+ */
+class ApproximateTransform
+{
+public:
+	/**
+	 * The exact transformation.
+	 * 
+	 * Returns false if the point cannot be transformed.
+	 */
+	using Function = std::function<bool (const QPointF& /* in */, QPointF& /* out */)>;
+	
+	/**
+	 * Constructs an approximation of the given function.
+	 * 
+	 * The estimated max_error is measured in the units of the function's output.
+	 * The max_depth limits the number of grid levels.
+	 */
+	ApproximateTransform(Function exact, const QRectF& domain, double max_error, int max_depth = 10);
+	
+	ApproximateTransform(const ApproximateTransform&) = delete;
+	ApproximateTransform(ApproximateTransform&&) = default;
+	
+	~ApproximateTransform();
+	
+	ApproximateTransform& operator=(const ApproximateTransform&) = delete;
+	ApproximateTransform& operator=(ApproximateTransform&&) = default;
+	
+	
+	/**
+	 * Returns the domain of the grid.
+	 */
+	const QRectF& domain() const { return grid_domain; }
+	
+	/**
+	 * Returns the estimated maximum error of the approximation.
+	 */
+	double maxError() const { return max_error; }
+	
+	/**
+	 * Returns the number of evaluations of the exact function so far.
+	 * 
+	 * This includes control points and points which are transformed exactly.
+	 */
+	int exactEvaluations() const { return exact_evaluations; }
+	
+	
+	/**
+	 * Transforms a single point.
+	 * 
+	 * Returns false if the point cannot be transformed.
+	 */
+	bool transform(const QPointF& in, QPointF& out);
+	
+	/**
+	 * Transforms multiple points.
+	 * 
+	 * The output has the same size as the input. Returns false if any point
+	 * could not be transformed.
+	 */
+	bool transform(const std::vector<QPointF>& in, std::vector<QPointF>& out);
+
+
+private:
+	/**
+	 * A grid cell.
+	 * 
+	 * The position of a cell is given in units of the finest grid level.
+	 */
+	struct Cell
+	{
+		enum State : quint8 { Unchecked, Interpolated, Subdivided, Exact };
+		
+		quint32 x;
+		quint32 y;
+		quint32 size;
+		quint32 children = 0;  ///< The index of the first of four children.
+		State state = Unchecked;
+	};
+	
+	/**
+	 * A control point of the grid.
+	 */
+	struct ControlPoint
+	{
+		QPointF value;
+		bool valid;
+	};
+	
+	const ControlPoint& controlPoint(quint32 x, quint32 y);
+	
+	QPointF interpolate(const Cell& cell, const QPointF& grid_pos);
+	
+	void check(std::size_t index);
+	
+	bool evaluate(const QPointF& in, QPointF& out);
+	
+	QPointF toDomain(double x, double y) const;
+	
+	Function exact;
+	QRectF grid_domain;
+	double max_error;
+	quint32 grid_size;
+	std::vector<Cell> cells;
+	std::unordered_map<quint64, ControlPoint> control_points;
+	int exact_evaluations = 0;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -34,6 +34,7 @@
 #include <QLatin1String>
 #include <QLocale>
 #include <QPoint>
+#include <QRectF>
 #include <QSignalBlocker>
 #include <QStandardPaths> // IWYU pragma: keep
 #include <QStringRef>
@@ -46,6 +47,7 @@
 #  include <proj.h>
 #endif
 
+#include "core/approximate_transform.h"
 #include "core/crs_template.h"
 #include "fileformats/file_format.h"
 #include "fileformats/xml_file_format.h"
@@ -284,6 +286,46 @@ LatLon ProjTransform::inverse(const QPointF& projected_coords, bool* ok) const
 	return LatLon::fromRadiant(northing, easting);
 }
 
+bool ProjTransform::forward(const std::vector<LatLon>& lat_lon, std::vector<QPointF>& projected) const
+{
+	static auto const geographic_crs = ProjTransform(Georeferencing::geographic_crs_spec);
+	
+	auto const count = lat_lon.size();
+	std::vector<double> easting(count), northing(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		easting[i] = qDegreesToRadians(lat_lon[i].longitude());
+		northing[i] = qDegreesToRadians(lat_lon[i].latitude());
+	}
+	auto ok = geographic_crs.isValid()
+	          && pj_transform(geographic_crs.pj, pj, long(count), 1, easting.data(), northing.data(), nullptr) == 0;
+	
+	projected.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+		projected[i] = {easting[i], northing[i]};
+	return ok;
+}
+
+bool ProjTransform::inverse(const std::vector<QPointF>& projected, std::vector<LatLon>& lat_lon) const
+{
+	static auto const geographic_crs = ProjTransform(Georeferencing::geographic_crs_spec);
+	
+	auto const count = projected.size();
+	std::vector<double> easting(count), northing(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		easting[i] = projected[i].x();
+		northing[i] = projected[i].y();
+	}
+	auto ok = geographic_crs.isValid()
+	          && pj_transform(pj, geographic_crs.pj, long(count), 1, easting.data(), northing.data(), nullptr) == 0;
+	
+	lat_lon.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+		lat_lon[i] = LatLon::fromRadiant(northing[i], easting[i]);
+	return ok;
+}
+
 QString ProjTransform::errorText() const
 {
 	auto err_no = *pj_get_errno_ref();
@@ -354,6 +396,60 @@ LatLon ProjTransform::inverse(const QPointF& projected_coords, bool* ok) const
 	return {pj_coord.lp.phi, pj_coord.lp.lam};
 }
 
+bool ProjTransform::forward(const std::vector<LatLon>& lat_lon, std::vector<QPointF>& projected) const
+{
+	auto const count = lat_lon.size();
+	std::vector<double> x(count), y(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		x[i] = lat_lon[i].longitude();
+		y[i] = lat_lon[i].latitude();
+	}
+	auto const ok = transformGeneric(PJ_FWD, x, y);
+	
+	projected.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+		projected[i] = {x[i], y[i]};
+	return ok;
+}
+
+bool ProjTransform::inverse(const std::vector<QPointF>& projected, std::vector<LatLon>& lat_lon) const
+{
+	auto const count = projected.size();
+	std::vector<double> x(count), y(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		x[i] = projected[i].x();
+		y[i] = projected[i].y();
+	}
+	auto const ok = transformGeneric(PJ_INV, x, y);
+	
+	lat_lon.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+		lat_lon[i] = {y[i], x[i]};
+	return ok;
+}
+
+bool ProjTransform::transformGeneric(int direction, std::vector<double>& x, std::vector<double>& y) const
+{
+	Q_ASSERT(x.size() == y.size());
+	if (x.empty())
+		return true;
+	
+	// Like the single point variants: z = 0, t = HUGE_VAL for all points.
+	auto z = 0.0;
+	auto t = HUGE_VAL;
+	auto const stride = sizeof(double);
+	proj_errno_reset(pj);
+	proj_trans_generic(pj, PJ_DIRECTION(direction),
+	                   x.data(), stride, x.size(),
+	                   y.data(), stride, y.size(),
+	                   &z, 0, 1,
+	                   &t, 0, 1);
+	return proj_errno(pj) == 0
+	       && std::all_of(begin(x), end(x), [](auto value) { return std::isfinite(value); });
+}
+
 QString ProjTransform::errorText() const
 {
 	auto err_no = proj_errno(pj);
@@ -1081,6 +1177,86 @@ MapCoordF Georeferencing::toMapCoordF(const LatLon& lat_lon, bool* ok) const
 	return toMapCoordF(toProjectedCoords(lat_lon, ok));
 }
 
+std::vector<MapCoordF> Georeferencing::toMapCoordF(const std::vector<LatLon>& lat_lon, bool* ok) const
+{
+	std::vector<QPointF> projected;
+	auto const success = proj_transform.isValid() && proj_transform.forward(lat_lon, projected);
+	if (ok)
+		*ok = success;
+	
+	std::vector<MapCoordF> map_coords;
+	map_coords.reserve(lat_lon.size());
+	if (projected.size() == lat_lon.size())
+	{
+		for (const auto& point : projected)
+			map_coords.emplace_back(toMapCoordF(point));
+	}
+	else
+	{
+		map_coords.resize(lat_lon.size(), toMapCoordF(QPointF{}));
+	}
+	return map_coords;
+}
+
+std::vector<LatLon> Georeferencing::toGeographicCoords(const std::vector<MapCoordF>& map_coords, bool* ok) const
+{
+	std::vector<QPointF> projected;
+	projected.reserve(map_coords.size());
+	for (const auto& map_coord : map_coords)
+		projected.emplace_back(toProjectedCoords(map_coord));
+	
+	std::vector<LatLon> lat_lon;
+	auto const success = proj_transform.isValid() && proj_transform.inverse(projected, lat_lon);
+	if (ok)
+		*ok = success;
+	lat_lon.resize(map_coords.size());
+	return lat_lon;
+}
+
+std::vector<MapCoordF> Georeferencing::toMapCoordFApproximate(const std::vector<LatLon>& lat_lon, double max_error, bool* ok) const
+{
+	// Below this size, the control points would cost more than they save.
+	if (lat_lon.size() < 100)
+		return toMapCoordF(lat_lon, ok);
+	
+	auto const minmax_lat = std::minmax_element(begin(lat_lon), end(lat_lon), [](const auto& a, const auto& b) {
+		return a.latitude() < b.latitude();
+	});
+	auto const minmax_lon = std::minmax_element(begin(lat_lon), end(lat_lon), [](const auto& a, const auto& b) {
+		return a.longitude() < b.longitude();
+	});
+	auto domain = QRectF { QPointF{minmax_lon.first->longitude(), minmax_lat.first->latitude()},
+	                       QPointF{minmax_lon.second->longitude(), minmax_lat.second->latitude()} };
+	// Avoid a degenerated domain for points on a meridian or parallel.
+	auto const margin = 0.001 * std::max(domain.width(), domain.height()) + 1e-6;
+	domain.adjust(-margin, -margin, margin, margin);
+	
+	auto transform = approximateMapTransform(domain, max_error);
+	auto success = true;
+	std::vector<MapCoordF> map_coords;
+	map_coords.reserve(lat_lon.size());
+	for (const auto& point : lat_lon)
+	{
+		QPointF map_coord;
+		if (!transform.transform({ point.longitude(), point.latitude() }, map_coord))
+			success = false;
+		map_coords.emplace_back(map_coord);
+	}
+	if (ok)
+		*ok = success;
+	return map_coords;
+}
+
+ApproximateTransform Georeferencing::approximateMapTransform(const QRectF& geographic_domain, double max_error) const
+{
+	auto exact = [this](const QPointF& lon_lat, QPointF& map_coord) {
+		bool ok;
+		map_coord = toMapCoordF(LatLon(lon_lat.y(), lon_lat.x()), &ok);
+		return ok;
+	};
+	return { exact, geographic_domain, max_error };
+}
+
 MapCoordF Georeferencing::toMapCoordF(const Georeferencing* other, const MapCoordF& map_coords, bool* ok) const
 {
 	if (!other)
@@ -26,6 +26,7 @@
 
 #include <QObject>
 #include <QPointF>
+#include <QRectF>
 #include <QString>
 #include <QTransform>
 
@@ -45,6 +46,7 @@ using ProjTransformData = struct PJconsts;
 
 namespace OpenOrienteering {
 
+class ApproximateTransform;
 
 /**
  * A utility which encapsulates PROJ API variants and resource management.
@@ -66,11 +68,29 @@ struct ProjTransform
 	QPointF forward(const LatLon& lat_lon, bool* ok) const;
 	LatLon inverse(const QPointF& projected, bool* ok) const;
 	
+	/**
+	 * Transforms multiple points with a single PROJ call.
+	 * 
+	 * Returns false if any point could not be transformed.
+	 */
+	bool forward(const std::vector<LatLon>& lat_lon, std::vector<QPointF>& projected) const;
+	
+	/**
+	 * Transforms multiple points with a single PROJ call.
+	 * 
+	 * Returns false if any point could not be transformed.
+	 */
+	bool inverse(const std::vector<QPointF>& projected, std::vector<LatLon>& lat_lon) const;
+	
 	QString errorText() const;
 	
 private:
 	ProjTransform(ProjTransformData* pj) noexcept;
 	
+#ifndef ACCEPT_USE_OF_DEPRECATED_PROJ_API_H
+	bool transformGeneric(int direction, std::vector<double>& x, std::vector<double>& y) const;
+#endif
+	
 	ProjTransformData* pj = nullptr;
 	
 };
@@ -499,6 +519,46 @@ public:
 	 */
 	MapCoordF toMapCoordF(const LatLon& lat_lon, bool* ok = nullptr) const;
 	
+	/**
+	 * Transforms multiple geographic coordinates (lat/lon) to map coordinates.
+	 * 
+	 * This is much faster than transforming the points one by one.
+	 * The returned vector has the same size as the input.
+	 */
+	std::vector<MapCoordF> toMapCoordF(const std::vector<LatLon>& lat_lon, bool* ok = nullptr) const;
+	
+	/**
+	 * Transforms multiple map (paper) coordinates to geographic coordinates (lat/lon).
+	 * 
+	 * This is much faster than transforming the points one by one.
+	 * The returned vector has the same size as the input.
+	 */
+	std::vector<LatLon> toGeographicCoords(const std::vector<MapCoordF>& map_coords, bool* ok = nullptr) const;
+	
+	/**
+	 * Transforms multiple geographic coordinates (lat/lon) to map coordinates,
+	 * approximately.
+	 * 
+	 * The estimated deviation from the exact transformation is at most
+	 * max_error millimeters on the map. The error is estimated from sample
+	 * points, so it is not a strict bound. This uses an
+	 * approximateMapTransform() over the extent of the input, so it is much
+	 * faster than exact transformation for large numbers of points, e.g. for
+	 * display.
+	 */
+	std::vector<MapCoordF> toMapCoordFApproximate(const std::vector<LatLon>& lat_lon, double max_error, bool* ok = nullptr) const;
+	
+	/**
+	 * Returns an approximation of the transformation from geographic
+	 * coordinates to map coordinates.
+	 * 
+	 * The domain is given by longitude (x) and latitude (y) in degrees.
+	 * The estimated maximum error is given in millimeters on the map.
+	 * The approximation refers to this object which must not be modified or
+	 * destroyed while the approximation is in use.
+	 */
+	ApproximateTransform approximateMapTransform(const QRectF& geographic_domain, double max_error) const;
+	
 	
 	/**
 	 * Transforms map coordinates from the other georeferencing to
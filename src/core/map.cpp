@@ -32,6 +32,8 @@
 #include <QtMath>
 #include <QByteArray>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QIODevice>
 #include <QPaintEngine>
 #include <QPainter>
@@ -116,6 +118,45 @@ struct MapColorSetMergeItem
 typedef std::vector<MapColorSetMergeItem> MapColorSetMergeList;
 
 
+/**
+ * The time in milliseconds which may be spent on deferred object updates
+ * before returning to the event loop.
+ */
+constexpr qint64 deferred_update_budget = 20;
+
+/**
+ * Returns the area in which an object with outdated renderables may be visible.
+ * 
+ * The area must not rely on the object's extent, because it is outdated, too.
+ * Instead, it is the bounding box of the coordinates (which contains any
+ * curves) plus a margin derived from the symbol. The margin is generous, and
+ * it is cached per symbol.
+ * 
+ * Returns a null rectangle for objects which must always be considered
+ * visible, e.g. text objects whose extent depends on the text layout.
+ */
+QRectF deferredUpdateBounds(const Object& object, QHash<const Symbol*, qreal>& margins)
+{
+	const auto* symbol = object.getSymbol();
+	const auto& coords = object.getRawCoordinateVector();
+	if (!symbol || coords.empty() || object.getType() == Object::Text)
+		return {};
+	
+	auto margin_it = margins.find(symbol);
+	if (margin_it == margins.end())
+	{
+		auto margin = 1 + 2 * std::max(symbol->dimensionForIcon(), symbol->calculateLargestLineExtent());
+		margin_it = margins.insert(symbol, margin);
+	}
+	auto const margin = *margin_it;
+	
+	QRectF bounds;
+	for (const auto& coord : coords)
+		rectIncludeSafe(bounds, MapCoordF(coord));
+	return bounds.adjusted(-margin, -margin, margin, margin);
+}
+
+
 }  // namespace
 
 
@@ -456,11 +497,13 @@ void Map::clear()
 	closed_templates.clear();
 	
 	object_selection.clear();
+	selected_symbol_counts.clear();
 	first_selected_object = nullptr;
 	selection_renderables->clear();
 	
 	renderables->clear();
 	
+	deferred_objects.clear();
 	for (MapPart* part : parts)
 		delete part;
 	parts.clear();
@@ -469,6 +512,7 @@ void Map::clear()
 	for (auto symbol : symbols)
 		delete symbol;
 	symbols.clear();
+	invalidateSymbolIndex();
 	
 	// Don't clear() color_set: It is shared.
 }
@@ -798,8 +842,8 @@ bool Map::importFromIODevice(QIODevice& device)
 
 void Map::draw(QPainter* painter, const RenderConfig& config)
 {
-	// Update the renderables of all objects marked as dirty
-	updateObjects();
+	// Update the renderables of the visible objects marked as dirty
+	updateObjects(config.bounding_box);
 	
 	// The actual drawing
 	renderables->draw(painter, config);
@@ -807,8 +851,8 @@ void Map::draw(QPainter* painter, const RenderConfig& config)
 
 void Map::drawOverprintingSimulation(QPainter* painter, const RenderConfig& config)
 {
-	// Update the renderables of all objects marked as dirty
-	updateObjects();
+	// Update the renderables of the visible objects marked as dirty
+	updateObjects(config.bounding_box);
 	
 	// The actual drawing
 	renderables->drawOverprintingSimulation(painter, config);
@@ -816,13 +860,19 @@ void Map::drawOverprintingSimulation(QPainter* painter, const RenderConfig& conf
 
 void Map::drawColorSeparation(QPainter* painter, const RenderConfig& config, const MapColor* spot_color, bool use_color)
 {
-	// Update the renderables of all objects marked as dirty
-	updateObjects();
+	// Update the renderables of the visible objects marked as dirty
+	updateObjects(config.bounding_box);
 	
 	// The actual drawing
 	renderables->drawColorSeparation(painter, config, spot_color, use_color);
 }
 
+std::vector<ColorSeparationIndex> Map::prepareColorSeparations(const std::vector<const MapColor*>& spot_colors, const std::vector<QRectF>& tiles)
+{
+	updateObjects();
+	return ColorSeparationIndex::create(*renderables, spot_colors, tiles);
+}
+
 void Map::drawGrid(QPainter* painter, const QRectF& bounding_box)
 {
 	grid.draw(painter, bounding_box, this);
@@ -856,18 +906,116 @@ void Map::drawTemplates(QPainter* painter, const QRectF& bounding_box, int first
 
 void Map::updateObjects()
 {
-	// TODO: It maybe would be better if the objects entered themselves into a separate list when they get dirty so not all objects have to be traversed here
+	// Objects may also be changed without deferral, so traverse all of them.
 	applyOnAllObjects(&Object::update);
+	deferred_objects.clear();
+}
+
+void Map::updateObjects(const QRectF& area)
+{
+	auto margins = QHash<const Symbol*, qreal>{};
+	for (const auto* part : parts)
+	{
+		for (int i = 0, n = part->getNumObjects(); i < n; ++i)
+		{
+			const auto* object = part->getObject(i);
+			if (!object->isOutputDirty())
+				continue;
+			
+			auto deferred = deferred_objects.find(object);
+			if (deferred == deferred_objects.end())
+			{
+				// Changed after loading, e.g. by an edit
+				object->update();
+				continue;
+			}
+			
+			// The bounds are determined once, not on every call.
+			auto& bounds = deferred->second;
+			if (bounds.isNull())
+				bounds = deferredUpdateBounds(*object, margins);
+			if (bounds.isNull() || bounds.intersects(area))
+			{
+				deferred_objects.erase(deferred);
+				object->update();
+			}
+		}
+	}
+	
+	if (!deferred_objects.empty())
+		scheduleDeferredObjectUpdates();
+}
+
+void Map::setObjectUpdatesDeferred(bool deferred)
+{
+	object_updates_deferred = deferred;
+	if (!deferred)
+		scheduleDeferredObjectUpdates();
+}
+
+void Map::updateOrDeferObject(const Object* object)
+{
+	if (areObjectUpdatesDeferred())
+		deferred_objects[object] = {};  // The bounds may have changed.
+	else
+		object->update();
+}
+
+bool Map::hasDeferredObjectUpdates() const
+{
+	return std::any_of(begin(deferred_objects), end(deferred_objects), [](const auto& deferred) {
+		return deferred.first->isOutputDirty();
+	});
+}
+
+void Map::setDataOnly(bool enabled)
+{
+	Q_ASSERT(getNumObjects() == 0);
+	data_only = enabled;
+}
+
+void Map::scheduleDeferredObjectUpdates()
+{
+	if (!deferred_updates_scheduled && !data_only)
+	{
+		deferred_updates_scheduled = true;
+		QTimer::singleShot(0, this, &Map::updateDeferredObjects);
+	}
+}
+
+void Map::updateDeferredObjects()
+{
+	deferred_updates_scheduled = false;
+	if (areObjectUpdatesDeferred())
+		return;  // setObjectUpdatesDeferred(false) will reschedule.
+	
+	QElapsedTimer timer;
+	timer.start();
+	for (auto it = begin(deferred_objects); it != end(deferred_objects); )
+	{
+		if (timer.hasExpired(deferred_update_budget))
+		{
+			scheduleDeferredObjectUpdates();
+			return;
+		}
+		const auto* object = it->first;
+		it = deferred_objects.erase(it);
+		object->update();
+	}
 }
 
 void Map::removeRenderablesOfObject(const Object* object, bool mark_area_as_dirty)
 {
+	deferred_objects.erase(object);  // The object may be about to be deleted.
 	renderables->removeRenderablesOfObject(object, mark_area_as_dirty);
 	if (isObjectSelected(object))
 		removeSelectionRenderables(object);
 }
 void Map::insertRenderablesOfObject(const Object* object)
 {
+	if (data_only)
+		return;
+	
 	renderables->insertRenderablesOfObject(object);
 	if (isObjectSelected(object))
 		addSelectionRenderables(object);
@@ -1001,6 +1149,7 @@ void Map::addObjectToSelection(Object* object, bool emit_selection_changed)
 		return;
 
 	object_selection.insert(object);
+	++selected_symbol_counts[object_symbol];
 	addSelectionRenderables(object);
 	if (!first_selected_object)
 		first_selected_object = object;
@@ -1013,6 +1162,7 @@ void Map::removeObjectFromSelection(Object* object, bool emit_selection_changed)
 	bool removed = object_selection.erase(object);
 	Q_ASSERT(removed && "Map::removeObjectFromSelection: object was not selected!");
 	Q_UNUSED(removed);
+	removeSelectedSymbolCount(object->getSymbol());
 	removeSelectionRenderables(object);
 	if (first_selected_object == object)
 		first_selected_object = object_selection.empty() ? nullptr : *object_selection.begin();
@@ -1020,6 +1170,56 @@ void Map::removeObjectFromSelection(Object* object, bool emit_selection_changed)
 		emit objectSelectionChanged();
 }
 
+std::size_t Map::addObjectsToSelection(const std::vector<Object*>& objects, bool emit_selection_changed)
+{
+	object_selection.reserve(object_selection.size() + objects.size());
+	
+	std::size_t num_added = 0;
+	for (auto* object : objects)
+	{
+		// we omit hidden and protected objects from any kind of selection
+		const auto* object_symbol = object->getSymbol();
+		if (object_symbol->isProtected() || object_symbol->isHidden())
+			continue;
+		
+		if (!object_selection.insert(object).second)
+			continue;
+		
+		++selected_symbol_counts[object_symbol];
+		addSelectionRenderables(object);
+		if (!first_selected_object)
+			first_selected_object = object;
+		++num_added;
+	}
+	
+	if (emit_selection_changed && num_added > 0)
+		emit objectSelectionChanged();
+	return num_added;
+}
+
+std::size_t Map::removeObjectsFromSelection(const std::vector<Object*>& objects, bool emit_selection_changed)
+{
+	std::size_t num_removed = 0;
+	for (auto* object : objects)
+	{
+		if (object_selection.erase(object) == 0)
+			continue;
+		
+		removeSelectedSymbolCount(object->getSymbol());
+		removeSelectionRenderables(object);
+		++num_removed;
+	}
+	
+	if (num_removed > 0)
+	{
+		if (first_selected_object && !isObjectSelected(first_selected_object))
+			first_selected_object = object_selection.empty() ? nullptr : *object_selection.begin();
+		if (emit_selection_changed)
+			emit objectSelectionChanged();
+	}
+	return num_removed;
+}
+
 bool Map::removeSymbolFromSelection(const Symbol* symbol, bool emit_selection_changed)
 {
 	bool removed_at_least_one_object = false;
@@ -1039,11 +1239,28 @@ bool Map::removeSymbolFromSelection(const Symbol* symbol, bool emit_selection_ch
 		if (first_selected_object == removed_object)
 			first_selected_object = object_selection.empty() ? nullptr : *object_selection.begin();
 	}
+	selected_symbol_counts.remove(symbol);
 	if (emit_selection_changed && removed_at_least_one_object)
 		emit objectSelectionChanged();
 	return removed_at_least_one_object;
 }
 
+void Map::objectSymbolChanged(const Object* object, const Symbol* old_symbol)
+{
+	if (old_symbol == object->getSymbol() || !isObjectSelected(object))
+		return;
+	
+	removeSelectedSymbolCount(old_symbol);
+	++selected_symbol_counts[object->getSymbol()];
+}
+
+void Map::removeSelectedSymbolCount(const Symbol* symbol)
+{
+	auto count = selected_symbol_counts.find(symbol);
+	if (count != selected_symbol_counts.end() && --*count <= 0)
+		selected_symbol_counts.erase(count);
+}
+
 bool Map::isObjectSelected(const Object* object) const
 {
 	return object_selection.find(const_cast<Object*>(object)) != object_selection.end();
@@ -1067,6 +1284,7 @@ void Map::clearObjectSelection(bool emit_selection_changed)
 {
 	selection_renderables->clear();
 	object_selection.clear();
+	selected_symbol_counts.clear();
 	first_selected_object = nullptr;
 	
 	if (emit_selection_changed)
@@ -1287,13 +1505,25 @@ void Map::deleteColor(int pos)
 
 int Map::findColorIndex(const MapColor* color) const
 {
+	if (!color)
+		return -1;
+	
+	// The priority is the index unless the color set is being modified.
+	auto const priority = color->getPriority();
+	if (priority >= 0
+	    && std::size_t(priority) < color_set->colors.size()
+	    && color_set->colors[std::size_t(priority)] == color)
+	{
+		return priority;
+	}
+	
 	std::size_t size = color_set->colors.size();
 	for (std::size_t i = 0; i < size; ++i)
 	{
 		if (color_set->colors[i] == color)
 			return (int)i;
 	}
-	if (color && color->getPriority() == MapColor::Registration)
+	if (priority == MapColor::Registration)
 	{
 		return MapColor::Registration;
 	}
@@ -1530,6 +1760,7 @@ void Map::initStatic()
 void Map::addSymbol(Symbol* symbol, int pos)
 {
 	symbols.insert(symbols.begin() + pos, symbol);
+	invalidateSymbolIndex();
 	if (symbols.size() == 1)
 	{
 		// This is the first symbol - the help text in the map widget(s) should be updated
@@ -1546,6 +1777,7 @@ void Map::moveSymbol(int from, int to)
 	if (from > to)
 		++from;
 	symbols.erase(symbols.begin() + from);
+	invalidateSymbolIndex();
 	// TODO: emit symbolChanged(pos, symbol); ?
 	setSymbolsDirty();
 }
@@ -1601,6 +1833,8 @@ void Map::setSymbol(Symbol* symbol, int pos)
 	
 	// Change the symbol
 	symbols[pos] = symbol;
+	if (symbol_index.remove(old_symbol))
+		symbol_index.insert(symbol, pos);
 	emit symbolChanged(pos, symbol, old_symbol);
 	setSymbolsDirty();
 	delete old_symbol;
@@ -1628,6 +1862,7 @@ void Map::deleteSymbol(int pos)
 	Symbol* temp = symbols[pos];
 	delete symbols[pos];
 	symbols.erase(symbols.begin() + pos);
+	invalidateSymbolIndex();
 	
 	if (symbols.empty())
 	{
@@ -1643,11 +1878,30 @@ int Map::findSymbolIndex(const Symbol* symbol) const
 {
 	if (!symbol)
 		return -1;
-	int size = (int)symbols.size();
-	for (int i = 0; i < size; ++i)
+	
+	auto const rebuild_index = [this]() {
+		symbol_index.clear();
+		symbol_index.reserve(int(symbols.size()));
+		for (int i = int(symbols.size()) - 1; i >= 0; --i)
+			symbol_index.insert(symbols[std::size_t(i)], i);
+	};
+	
+	// Importers may modify the symbol vector directly,
+	// so a size mismatch also triggers a rebuild.
+	if (symbol_index.size() != int(symbols.size()))
+		rebuild_index();
+	
+	auto found = symbol_index.constFind(symbol);
+	if (found != symbol_index.constEnd())
 	{
-		if (symbols[i] == symbol)
-			return i;
+		if (symbols[std::size_t(*found)] == symbol)
+			return *found;
+		
+		// A stale entry: The symbol vector was reordered directly.
+		rebuild_index();
+		found = symbol_index.constFind(symbol);
+		if (found != symbol_index.constEnd())
+			return *found;
 	}
 	
 	if (symbol == undefined_point)
@@ -1661,6 +1915,11 @@ int Map::findSymbolIndex(const Symbol* symbol) const
 	return -1;
 }
 
+void Map::invalidateSymbolIndex() const
+{
+	symbol_index.clear();
+}
+
 void Map::setSymbolsDirty()
 {
 	if (symbol_icon_scale > 0)
@@ -2251,12 +2510,18 @@ void Map::rotateAllObjects(double rotation, const MapCoord& center)
 
 void Map::updateAllObjects()
 {
-	applyOnAllObjects(&Object::forceUpdate);
+	if (areObjectUpdatesDeferred())
+		applyOnAllObjects([this](Object* object) { object->setOutputDirty(); updateOrDeferObject(object); });
+	else
+		applyOnAllObjects(&Object::forceUpdate);
 }
 
 void Map::updateAllObjectsWithSymbol(const Symbol* symbol)
 {
-	applyOnMatchingObjects(&Object::forceUpdate, ObjectOp::HasSymbol{symbol});
+	if (areObjectUpdatesDeferred())
+		applyOnMatchingObjects([this](Object* object) { object->setOutputDirty(); updateOrDeferObject(object); }, ObjectOp::HasSymbol{symbol});
+	else
+		applyOnMatchingObjects(&Object::forceUpdate, ObjectOp::HasSymbol{symbol});
 }
 
 void Map::changeSymbolForAllObjects(const Symbol* old_symbol, const Symbol* new_symbol)
@@ -26,6 +26,8 @@
 #include <cstddef>
 #include <functional>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <QtGlobal>
@@ -53,6 +55,7 @@ class QWidget;
 
 namespace OpenOrienteering {
 
+class ColorSeparationIndex;
 class CombinedSymbol;
 class Georeferencing;
 class LineSymbol;
@@ -93,8 +96,12 @@ friend class OCAD8FileImport;
 friend class XMLFileImporter;
 friend class XMLFileExporter;
 public:
-	/** A set of selected objects represented by a std::set of object pointers. */
-	typedef std::set<Object*> ObjectSelection;
+	/**
+	 * A set of selected objects represented by a hash set of object pointers.
+	 * 
+	 * The iteration order is unspecified.
+	 */
+	typedef std::unordered_set<Object*> ObjectSelection;
 	
 	/**
 	 * Different strategies for importing elements from another map.
@@ -265,6 +272,18 @@ public:
 	void drawColorSeparation(QPainter* painter, const RenderConfig& config,
 		const MapColor* spot_color, bool use_color = false);
 	
+	/**
+	 * Prepares drawing the separations for the given spot colors to many tiles.
+	 * 
+	 * Updates all objects, and creates an index for each separation on
+	 * multiple threads. The indexes become invalid when objects are modified.
+	 * 
+	 * @param spot_colors The spot colors to prepare the separations for.
+	 * @param tiles       The areas to be drawn, given in map coordinates.
+	 */
+	std::vector<ColorSeparationIndex> prepareColorSeparations(
+		const std::vector<const MapColor*>& spot_colors, const std::vector<QRectF>& tiles);
+	
 	/**
 	 * Draws the map grid.
 	 * 
@@ -296,10 +315,79 @@ public:
 	
 	/**
 	 * Updates the renderables and extent of all objects which have changed.
-	 * This is automatically called by draw(), you normally do not need to call it directly.
 	 */
 	void updateObjects();
 	
+	/**
+	 * Updates the renderables and extent of the changed objects which may be
+	 * visible in the given area.
+	 * 
+	 * Objects with deferred updates outside of the area are updated later,
+	 * in small chunks, when the event loop is idle. Other changed objects
+	 * are updated immediately.
+	 * This is automatically called by draw(), you normally do not need to call it directly.
+	 */
+	void updateObjects(const QRectF& area);
+	
+	/**
+	 * Enables or disables deferred object updates.
+	 * 
+	 * While enabled, objects added to the map do not generate their
+	 * renderables immediately, and importers skip the final update of all
+	 * objects. This way, loading a large map does not wait for renderables
+	 * which are not visible. They are generated on demand instead: by draw()
+	 * for the drawn area, by hit-testing and extent calculation for the
+	 * tested objects, and by exporters for all objects.
+	 * 
+	 * Disabling this mode schedules the update of the remaining objects.
+	 */
+	void setObjectUpdatesDeferred(bool deferred);
+	
+	/**
+	 * Returns true if object updates are deferred.
+	 * 
+	 * This is always true for data-only maps.
+	 * 
+	 * @see setObjectUpdatesDeferred()
+	 */
+	bool areObjectUpdatesDeferred() const { return object_updates_deferred || data_only; }
+	
+	/**
+	 * Updates the given object, or defers its update if object updates are deferred.
+	 * 
+	 * The object must belong to one of the map's parts. Deferred objects are
+	 * kept in a list until they are updated or removed from the map.
+	 */
+	void updateOrDeferObject(const Object* object);
+	
+	/**
+	 * Returns true if there are objects whose deferred update is still pending.
+	 * 
+	 * Exporters which need the renderables or extents of the objects require
+	 * that this returns false, cf. updateObjects().
+	 */
+	bool hasDeferredObjectUpdates() const;
+	
+	/**
+	 * Enables or disables the data-only mode.
+	 * 
+	 * A data-only map is a container for map data which is never displayed,
+	 * e.g. for clipboard operations, imports, and file format conversions.
+	 * Its object updates are deferred, and the map does not collect the
+	 * renderables of updated objects. Objects can still be updated explicitly,
+	 * e.g. for calculating extents or for exporting.
+	 * 
+	 * This must be set before adding objects.
+	 */
+	void setDataOnly(bool enabled);
+	
+	/**
+	 * Returns true if this is a data-only map.
+	 * 
+	 * @see setDataOnly()
+	 */
+	bool isDataOnly() const { return data_only; }
+	
 	/** 
 	 * Calculates the extent of all map elements. 
 	 * 
@@ -446,8 +534,10 @@ public:
 	void deleteColor(int pos);
 	
 	/**
-	 * Loops through the color list, looking for the given color pointer.
-	 * Returns the index of the color, or -1 if it is not found.
+	 * Returns the index of the given color pointer, or -1 if it is not found.
+	 * 
+	 * Normally, the color's priority is its index, so this is a constant-time
+	 * operation. Otherwise the function falls back to searching the color list.
 	 */
 	int findColorIndex(const MapColor* color) const;
 	
@@ -536,9 +626,11 @@ public:
 	void deleteSymbol(int pos);
 	
 	/**
-	 * Loops over all symbols, looking for the given symbol pointer.
-	 * Returns the index of the symbol, or -1 if the symbol is not found.
+	 * Returns the index of the given symbol pointer, or -1 if it is not found.
 	 * For the "undefined" symbols, returns special indices smaller than -1.
+	 * 
+	 * The lookup uses an index hash which is rebuilt on demand after
+	 * the symbol list was modified.
 	 */
 	int findSymbolIndex(const Symbol* symbol) const;
 	
@@ -1043,6 +1135,23 @@ public:
 	 */
 	Object* getFirstSelectedObject();
 	
+	/**
+	 * Returns the number of selected objects for each symbol in the selection.
+	 * 
+	 * This information is updated incrementally when objects are added to or
+	 * removed from the selection, or when a selected object's symbol changes.
+	 * Properties which depend only on the symbols (types, rotatability) can
+	 * be derived from it without iterating over the selected objects.
+	 */
+	const QHash<const Symbol*, int>& selectedSymbolCounts() const;
+	
+	/**
+	 * Updates the selection's symbol counts after the symbol of an object changed.
+	 * 
+	 * This is called by Object; there is no need to call it explicitly.
+	 */
+	void objectSymbolChanged(const Object* object, const Symbol* old_symbol);
+	
  	/**
 	 * Checks the selected objects for compatibility with the given symbol.
 	 * @param symbol the symbol to check compatibility for
@@ -1094,6 +1203,32 @@ public:
 	 */
 	void removeObjectFromSelection(Object* object, bool emit_selection_changed);
 	
+	/**
+	 * Adds the given objects to the selection.
+	 * 
+	 * Objects which are already selected, and objects with hidden or protected
+	 * symbols, are skipped. This is much faster than adding many objects
+	 * one by one.
+	 * 
+	 * @param objects The objects to add.
+	 * @param emit_selection_changed Set to true if objectSelectionChanged()
+	 *     should be emitted when at least one object was added.
+	 * @return The number of objects which were added to the selection.
+	 */
+	std::size_t addObjectsToSelection(const std::vector<Object*>& objects, bool emit_selection_changed);
+	
+	/**
+	 * Removes the given objects from the selection.
+	 * 
+	 * Objects which are not selected are skipped.
+	 * 
+	 * @param objects The objects to remove.
+	 * @param emit_selection_changed Set to true if objectSelectionChanged()
+	 *     should be emitted when at least one object was removed.
+	 * @return The number of objects which were removed from the selection.
+	 */
+	std::size_t removeObjectsFromSelection(const std::vector<Object*>& objects, bool emit_selection_changed);
+	
 	/**
 	 * Removes from the selection all objects with the given symbol.
 	 * Returns true if at least one object has been removed.
@@ -1497,22 +1632,47 @@ private:
 	);
 	
 	
+	/**
+	 * Schedules updateDeferredObjects() for when the event loop is idle.
+	 */
+	void scheduleDeferredObjectUpdates();
+	
+	/**
+	 * Updates deferred objects until a small time budget is used up.
+	 * 
+	 * Reschedules itself as long as there are deferred objects.
+	 */
+	void updateDeferredObjects();
+	
+	
 	void addSelectionRenderables(const Object* object);
 	void updateSelectionRenderables(const Object* object);
 	void removeSelectionRenderables(const Object* object);
 	
+	/**
+	 * Decrements the selection's count for the given symbol.
+	 */
+	void removeSelectedSymbolCount(const Symbol* symbol);
+	
 	static void initStatic();
 	
+	/**
+	 * Discards the symbol index hash, forcing a rebuild on next use.
+	 */
+	void invalidateSymbolIndex() const;
+	
 	QExplicitlySharedDataPointer<MapColorSet> color_set;
 	bool has_spot_colors;
 	QString symbol_set_id;
 	SymbolVector symbols;
+	mutable QHash<const Symbol*, int> symbol_index;  // rebuilt by findSymbolIndex()
 	mutable qreal symbol_icon_scale = 0;
 	TemplateVector templates;
 	TemplateVector closed_templates;
 	int first_front_template = 0;		// index of the first template in templates which should be drawn in front of the map
 	PartVector parts;
 	ObjectSelection object_selection;
+	QHash<const Symbol*, int> selected_symbol_counts;
 	Object* first_selected_object = nullptr;
 	QScopedPointer<UndoManager> undo_manager;
 	std::size_t current_part_index = 0;
@@ -1527,6 +1687,10 @@ private:
 	MapGrid grid;
 	
 	int renderable_options;
+	bool object_updates_deferred = false;
+	bool data_only = false;
+	bool deferred_updates_scheduled = false;
+	std::unordered_map<const Object*, QRectF> deferred_objects;  ///< Objects with pending updates, and their cached visibility bounds
 	
 	QScopedPointer<MapPrinterConfig> printer_config;
 	
@@ -1626,6 +1790,7 @@ template<typename T>
 void Map::sortSymbols(T compare)
 {
 	std::stable_sort(symbols.begin(), symbols.end(), compare);
+	invalidateSymbolIndex();
 	// TODO: emit symbolChanged(pos, symbol); ? s/b same choice as for moveSymbol()
 	setSymbolsDirty();
 }
@@ -1744,6 +1909,12 @@ Map::ObjectSelection::const_iterator Map::selectedObjectsEnd() const
 	return object_selection.cend();
 }
 
+inline
+const QHash<const Symbol*, int>& Map::selectedSymbolCounts() const
+{
+	return selected_symbol_counts;
+}
+
 inline
 const Object* Map::getFirstSelectedObject() const
 {
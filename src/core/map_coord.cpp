@@ -20,6 +20,7 @@
 
 #include "map_coord.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <iterator>
 #include <limits>
@@ -140,7 +141,9 @@ namespace
 constexpr qint64 min_coord = -50000000;
 constexpr qint64 max_coord = +50000000;
 
-MapCoord::BoundsOffset bounds_offset;
+// Each thread has its own bounds offset, so that objects can be loaded
+// in parallel.
+thread_local MapCoord::BoundsOffset bounds_offset;
 
 inline
 void applyBoundsOffset(qint64& x64, qint64& y64)
@@ -184,6 +187,107 @@ void ensureBoundsForQint32(qint64 x64, qint64 y64)
 	}
 }
 
+
+/// Pairs of decimal digits, for writing two digits per division.
+const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+template <class Char>
+Char* writeUnsigned(quint32 value, Char* out)
+{
+	// For efficiency, we construct the digits from the back.
+	Char digits[10];
+	auto first = std::end(digits);
+	while (value >= 100)
+	{
+		auto const pair = 2 * (value % 100);
+		value /= 100;
+		*--first = Char(ushort(digit_pairs[pair + 1]));
+		*--first = Char(ushort(digit_pairs[pair]));
+	}
+	if (value >= 10)
+	{
+		*--first = Char(ushort(digit_pairs[2 * value + 1]));
+		*--first = Char(ushort(digit_pairs[2 * value]));
+	}
+	else
+	{
+		*--first = Char(ushort('0' + value));
+	}
+	return std::copy(first, std::end(digits), out);
+}
+
+template <class Char>
+Char* writeSigned(qint32 value, Char* out)
+{
+	if (value < 0)
+	{
+		*out++ = Char(ushort('-'));
+		return writeUnsigned(0u - quint32(value), out);
+	}
+	return writeUnsigned(quint32(value), out);
+}
+
+template <class Char>
+Char* writeCoord(const MapCoord& coord, Char* out)
+{
+	out = writeSigned(coord.nativeX(), out);
+	*out++ = Char(ushort(' '));
+	out = writeSigned(coord.nativeY(), out);
+	if (auto const flags = coord.flags())
+	{
+		*out++ = Char(ushort(' '));
+		out = writeUnsigned(quint32(flags), out);
+	}
+	*out++ = Char(ushort(';'));
+	return out;
+}
+
+/**
+ * Scans a decimal number with an optional minus sign, and moves p behind it.
+ * 
+ * Returns false if there are no digits, or too many digits for qint64.
+ */
+inline
+bool scanDecimal(const ushort*& p, const ushort* end, qint64& value)
+{
+	auto const negative = (p != end && *p == '-');
+	if (negative)
+		++p;
+	
+	auto const first = p;
+	quint64 result = 0;
+	for (; p != end; ++p)
+	{
+		auto const digit = ushort(*p - '0');
+		if (digit > 9)
+			break;
+		result = 10 * result + digit;
+	}
+	
+	auto const num_digits = p - first;
+	if (Q_UNLIKELY(num_digits == 0 || num_digits > 18))
+		return false;
+	
+	value = negative ? -qint64(result) : qint64(result);
+	return true;
+}
+
+[[noreturn]]
+void throwParseError(const ushort* p, const ushort* end)
+{
+	throw std::invalid_argument(p == end ? "Premature end of data" : "Invalid data");
+}
+
 }  // namespace
 
 
@@ -267,128 +371,24 @@ QString MapCoord::toString() const
 
 QString MapCoord::toString(MapCoord::StringBuffer<QChar>& buffer) const
 {
-	static const QChar encoded[10] = {
-	    QLatin1Char{'0'}, QLatin1Char{'1'},
-	    QLatin1Char{'2'}, QLatin1Char{'3'},
-	    QLatin1Char{'4'}, QLatin1Char{'5'},
-	    QLatin1Char{'6'}, QLatin1Char{'7'},
-	    QLatin1Char{'8'}, QLatin1Char{'9'}
-	};
-	
-	// For efficiency, we construct the string from the back,
-	// using a bidirectional iterator.
-	auto const last = end(buffer) - 1;
-	auto first = last;
-	*first-- = QLatin1Char{';'};
-	
-	auto div = std::div_t{static_cast<int>(fp), 0};
-	static_assert(sizeof(div.quot) >= sizeof(fp),
-	              "div.quot must be large enough to hold the flags" );
-	if (div.quot > 0)
-	{
-		do
-		{
-			div = std::div(div.quot, 10);
-			*first-- = encoded[div.rem];
-		}
-		while (div.quot != 0);
-		
-		*first-- = QChar::Space;
-	}
-	
-	static_assert(sizeof(div.quot) >= sizeof(MapCoord::yp),
-	              "div.quot must be large enough to hold"
-	              "-std::numeric_limits<decltype(MapCoord::yp)>::min()" );
-	div.quot = yp;
-	do
-	{
-		div = std::div(div.quot, 10);
-		*first-- = encoded[std::abs(div.rem)];
-	}
-	while (div.quot != 0);
-	if (yp < 0)
-	{
-		*first-- = QLatin1Char{'-'};
-	}
-	
-	*first-- = QChar::Space;
-	
-	static_assert(sizeof(div.quot) >= sizeof(MapCoord::xp),
-	              "div.quot must be large enough to hold"
-	              "-std::numeric_limits<decltype(MapCoord::xp)>::min()" );
-	div.quot = xp;
-	do
-	{
-		div = std::div(div.quot, 10);
-		*first-- = encoded[std::abs(div.rem)];
-	}
-	while (div.quot != 0);
-	if (xp < 0)
-	{
-		*first-- = QLatin1Char{'-'};
-	}
-	
-	return QString::fromRawData(&*(first+1), int(std::distance(first, last)));
+	auto const last = write(buffer.data());
+	return QString::fromRawData(buffer.data(), int(std::distance(buffer.data(), last)));
 }
 
 QByteArray MapCoord::toUtf8(MapCoord::StringBuffer<char>& buffer) const
 {
-	static auto* encoded = "0123456789";
-	
-	// For efficiency, we construct the string from the back,
-	// using a bidirectional iterator.
-	auto const last = end(buffer) - 1;
-	auto first = last;
-	*first-- = ';';
-	
-	auto div = std::div_t{static_cast<int>(fp), 0};
-	static_assert(sizeof(div.quot) >= sizeof(fp),
-	              "div.quot must be large enough to hold the flags" );
-	if (div.quot > 0)
-	{
-		do
-		{
-			div = std::div(div.quot, 10);
-			*first-- = encoded[div.rem];
-		}
-		while (div.quot != 0);
-		
-		*first-- = ' ';
-	}
-	
-	static_assert(sizeof(div.quot) >= sizeof(MapCoord::yp),
-	              "div.quot must be large enough to hold"
-	              "-std::numeric_limits<decltype(MapCoord::yp)>::min()" );
-	div.quot = yp;
-	do
-	{
-		div = std::div(div.quot, 10);
-		*first-- = encoded[std::abs(div.rem)];
-	}
-	while (div.quot != 0);
-	if (yp < 0)
-	{
-		*first-- = '-';
-	}
-	
-	*first-- = ' ';
+	auto const last = write(buffer.data());
+	return QByteArray::fromRawData(buffer.data(), int(std::distance(buffer.data(), last)));
+}
 	
-	static_assert(sizeof(div.quot) >= sizeof(MapCoord::xp),
-	              "div.quot must be large enough to hold"
-	              "-std::numeric_limits<decltype(MapCoord::xp)>::min()" );
-	div.quot = xp;
-	do
-	{
-		div = std::div(div.quot, 10);
-		*first-- = encoded[std::abs(div.rem)];
-	}
-	while (div.quot != 0);
-	if (xp < 0)
-	{
-		*first-- = '-';
-	}
+char* MapCoord::write(char* out) const
+{
+	return writeCoord(*this, out);
+}
 	
-	return QByteArray::fromRawData(&*(first+1), int(std::distance(first, last)));
+QChar* MapCoord::write(QChar* out) const
+{
+	return writeCoord(*this, out);
 }
 
 MapCoord::MapCoord(QStringRef& text)
@@ -470,15 +470,20 @@ MapCoord::MapCoord(QStringRef& text)
 			throw std::invalid_argument("Premature end of data");
 		
 		// there are no negative flags
-		fp = Flags(data[i].unicode() - '0');
+		int flags = data[i].unicode() - '0';
 		for (++i; i < len; ++i)
 		{
 			auto c = data[i].unicode();
 			if (c < '0' || c > '9')
 				break;
 			else
-				fp = Flags(10*int(fp) + c - '0');
+				flags = 10*flags + c - '0';
+			if (Q_UNLIKELY(flags > max_flags))
+				break;
 		}
+		if (Q_UNLIKELY(flags < 0 || flags > max_flags))
+			throw std::invalid_argument("Invalid data");
+		fp = Flags(flags);
 	}
 	
 	if (Q_UNLIKELY(i >= len || data[i] != QLatin1Char{';'}))
@@ -488,5 +493,46 @@ MapCoord::MapCoord(QStringRef& text)
 	text = text.mid(i, len-i);
 }
 
+// static
+void MapCoord::parse(const QStringRef& text, std::vector<MapCoord>& coords)
+{
+	auto p = text.utf16();
+	auto const end = p + text.size();
+	for (;;)
+	{
+		while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+			++p;
+		if (p == end)
+			break;
+		
+		qint64 x64, y64;
+		if (Q_UNLIKELY(!scanDecimal(p, end, x64) || p == end || *p != ' '))
+			throwParseError(p, end);
+		++p;
+		if (Q_UNLIKELY(!scanDecimal(p, end, y64)))
+			throwParseError(p, end);
+		
+		handleBoundsOffset(x64, y64);
+		ensureBoundsForQint32(x64, y64);
+		
+		qint64 flags = 0;
+		if (p != end && *p == ' ')
+		{
+			// there are no negative flags
+			++p;
+			if (Q_UNLIKELY(p == end || *p == '-' || !scanDecimal(p, end, flags)))
+				throwParseError(p, end);
+			if (Q_UNLIKELY(flags > max_flags))
+				throw std::invalid_argument("Invalid data");
+		}
+		
+		if (Q_UNLIKELY(p == end || *p != ';'))
+			throwParseError(p, end);
+		++p;
+		
+		coords.push_back(MapCoord::fromNative(static_cast<qint32>(x64), static_cast<qint32>(y64), Flags(int(flags))));
+	}
+}
+
 
 }  // namespace OpenOrienteering
@@ -95,6 +95,13 @@ public:
 	};
 	Q_DECLARE_FLAGS(Flags, Flag)
 	
+	/**
+	 * The largest flags value which is accepted in import and export.
+	 * 
+	 * Flags are stored in one byte, cf. StringBuffer.
+	 */
+	static constexpr Flags::Int max_flags = 0xff;
+	
 	/**
 	 * Offset and flag for importing and moving out-of-bounds MapCoords.
 	 *
@@ -115,9 +122,10 @@ public:
 	 * all other coordinates. After that adjustment, anything up to 1000 m of
 	 * paper away from the first point will be in the printable area.
 	 * 
-	 * The current implementation uses a global variable and thus can handle
-	 * only one file at the same time. However, the global variables is
-	 * initially configured to a neutral value. Any code activating the tracking
+	 * The current implementation uses a thread-local variable and thus can
+	 * handle only one file at the same time in each thread. Threads which
+	 * help with loading a file must copy the offset from the loading thread.
+	 * The variable is initially configured to a neutral value. Any code activating the tracking
 	 * of out-of-bounds coordinates it responsible to rollback this neutral
 	 * configuration when finished.
 	 * 
@@ -148,7 +156,7 @@ private:
 	Flags  fp;
 	
 public:
-	/** Returns the global bounds offset.
+	/** Returns the bounds offset of the current thread.
 	 *
 	 * It is returned as a non-const reference, so that it can be used in
 	 * QScopedValueRollack.
@@ -421,6 +429,25 @@ public:
 	 */
 	QByteArray toUtf8(StringBuffer<char>& buffer) const;
 	
+	/**
+	 * Writes the raw coordinates and flags to the given array, and returns
+	 * a pointer behind the last character written.
+	 * 
+	 * The array must have space for at least the size of a StringBuffer.
+	 * The text is the same as from toString(), but this function neither
+	 * allocates nor constructs intermediate objects. So it is the most
+	 * efficient way to write many coordinates.
+	 */
+	char* write(char* out) const;
+	
+	/**
+	 * Writes the raw coordinates and flags to the given array, and returns
+	 * a pointer behind the last character written.
+	 * 
+	 * \see write(char*)
+	 */
+	QChar* write(QChar* out) const;
+	
 	/**
 	 * Constructs the MapCoord from the beginning of text, and moves the 
 	 * reference to behind the this coordinates data.
@@ -435,6 +462,17 @@ public:
 	 */
 	MapCoord(QStringRef& text);
 	
+	/**
+	 * Parses all coordinates from text, and appends them to coords.
+	 * 
+	 * This is equivalent to calling MapCoord(QStringRef&) repeatedly until the
+	 * text is exhausted, but it scans the UTF-16 data in a single pass.
+	 * Whitespace between coordinates is ignored. Errors are reported by the
+	 * same exceptions as from MapCoord(QStringRef&). Flags greater than
+	 * max_flags are invalid data.
+	 */
+	static void parse(const QStringRef& text, std::vector<MapCoord>& coords);
+	
 	
 	/** Saves the MapCoord in xml format to the stream. */
 	void save(QXmlStreamWriter& xml) const;
@@ -35,6 +35,7 @@
 #include "core/map_coord.h"
 #include "core/objects/object.h"
 #include "core/symbols/symbol.h"
+#include "fileformats/xml_object_loader.h"
 #include "undo/object_undo.h"
 #include "util/util.h"
 #include "util/xml_stream_util.h"
@@ -93,7 +94,7 @@ void MapPart::save(QXmlStreamWriter& xml) const
 	}
 }
 
-MapPart* MapPart::load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol_dict)
+MapPart* MapPart::load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol_dict, XmlObjectLoader* object_loader)
 {
 	Q_ASSERT(xml.name() == literal::part);
 	
@@ -104,6 +105,9 @@ MapPart* MapPart::load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol
 	{
 		if (xml.name() == literal::objects)
 		{
+			if (object_loader && object_loader->load(xml, map, part->objects))
+				continue;
+			
 			XmlElementReader objects_element(xml);
 			
 			std::size_t num_objects = objects_element.attribute<std::size_t>(literal::count);
@@ -145,7 +149,7 @@ void MapPart::setObject(Object* object, int pos, bool delete_old)
 	
 	objects[pos] = object;
 	object->setMap(map);
-	object->update();
+	map->updateOrDeferObject(object);
 	map->setObjectsDirty(); // TODO: remove from here, dirty state handling should be separate
 }
 
@@ -158,7 +162,7 @@ void MapPart::addObject(Object* object, int pos)
 {
 	objects.insert(objects.begin() + pos, object);
 	object->setMap(map);
-	object->update();
+	map->updateOrDeferObject(object);
 	
 	if (objects.size() == 1 && map->getNumObjects() == 1)
 		map->updateAllMapWidgets();
@@ -222,7 +226,7 @@ std::unique_ptr<UndoStep> MapPart::importPart(const MapPart* other, const QHash<
 		
 		objects.push_back(new_object);
 		new_object->setMap(map);
-		new_object->update();
+		map->updateOrDeferObject(new_object);
 		
 		undo_step->addObject((int)objects.size() - 1);
 		if (select_new_objects)
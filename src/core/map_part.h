@@ -43,6 +43,7 @@ namespace OpenOrienteering {
 class Map;
 class MapCoordF;
 class Object;
+class XmlObjectLoader;
 class Symbol;
 using SymbolDictionary = QHash<qint32, Symbol*>; // from symbol.h
 class UndoStep;
@@ -94,8 +95,9 @@ public:
 	 * Loads the map part in xml format from the given stream.
 	 * 
 	 * Needs a dictionary to map symbol ids to symbol pointers.
+	 * If an object loader is given, it is tried first for loading objects.
 	 */
-	static MapPart* load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol_dict);
+	static MapPart* load(QXmlStreamReader& xml, Map& map, SymbolDictionary& symbol_dict, XmlObjectLoader* object_loader = nullptr);
 	
 	/**
 	 * Returns the part's name.
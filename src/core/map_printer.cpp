@@ -1211,6 +1211,13 @@ void MapPrinter::drawPage(QPainter* device_painter, const QRectF& page_extent, Q
 }
 
 void MapPrinter::drawSeparationPages(QPrinter* printer, QPainter* device_painter, const QRectF& page_extent) const
+{
+	auto const separations = map.prepareColorSeparations(separationColors(), { page_extent });
+	drawSeparationPages(printer, device_painter, page_extent, separations, 0);
+}
+
+void MapPrinter::drawSeparationPages(QPrinter* printer, QPainter* device_painter, const QRectF& page_extent,
+                                     const std::vector<ColorSeparationIndex>& separations, std::size_t tile) const
 {
 	Q_ASSERT(printer->colorMode() == QPrinter::GrayScale);
 	
@@ -1235,25 +1242,33 @@ void MapPrinter::drawSeparationPages(QPrinter* printer, QPainter* device_painter
 	device_painter->setClipRect(page_extent.intersected(print_area), Qt::ReplaceClip);
 	
 	bool need_new_page = false;
-	for (int i = map.getNumColors() - 1; i >= 0; --i)
+	for (const auto& separation : separations)
 	{
-		const MapColor* color = map.getColor(i);
-		if (color->getSpotColorMethod() == MapColor::SpotColor)
+		if (need_new_page)
 		{
-			if (need_new_page)
-			{
-				printer->newPage();
-			}
-			
-			RenderConfig config = { map, page_extent, scale, RenderConfig::NoOptions, 1.0 };
-			map.drawColorSeparation(device_painter, config, color);
-			need_new_page = true;
+			printer->newPage();
 		}
+		
+		RenderConfig config = { map, page_extent, scale, RenderConfig::NoOptions, 1.0 };
+		separation.draw(device_painter, config, tile);
+		need_new_page = true;
 	}
 	
 	device_painter->restore();
 }
 
+std::vector<const MapColor*> MapPrinter::separationColors() const
+{
+	std::vector<const MapColor*> colors;
+	for (int i = map.getNumColors() - 1; i >= 0; --i)
+	{
+		const MapColor* color = map.getColor(i);
+		if (color->getSpotColorMethod() == MapColor::SpotColor)
+			colors.push_back(color);
+	}
+	return colors;
+}
+
 bool MapPrinter::printMap(QPrinter* printer)
 {
 	// Printer settings may have been changed by preview or application.
@@ -1326,6 +1341,28 @@ bool MapPrinter::printMap(QPrinter* printer)
 	const QString message_template( (options.mode == MapPrinterOptions::Separations) ?
 	  ::OpenOrienteering::MapPrinter::tr("Processing separations of page %1...") :
 	  ::OpenOrienteering::MapPrinter::tr("Processing page %1...") );
+	
+	// In separations mode, each page is drawn once per spot color.
+	// Selecting the renderables of each separation for all pages at once
+	// avoids traversing all objects for each page and color.
+	std::vector<QRectF> page_extents;
+	std::vector<ColorSeparationIndex> separations;
+	if (separationsModeSelected())
+	{
+		emit printProgress(0, ::OpenOrienteering::MapPrinter::tr("Preparing separations..."));
+		if (!cancel_print_map) /* during printProgress handling */
+		{
+			page_extents.reserve(num_steps);
+			for (auto vpos : v_page_pos)
+			{
+				for (auto hpos : h_page_pos)
+					page_extents.emplace_back(QPointF(hpos, vpos), extent_size);
+			}
+			separations = map.prepareColorSeparations(separationColors(), page_extents);
+		}
+	}
+	
+	// Cancelation is checked before drawing the first page.
 	auto message = message_template.arg(1);
 	emit printProgress(0, message);
 	
@@ -1362,7 +1399,7 @@ bool MapPrinter::printMap(QPrinter* printer)
 			QRectF page_extent = QRectF(QPointF(hpos, vpos), extent_size);
 			if (separationsModeSelected())
 			{
-				drawSeparationPages(printer, &painter, page_extent);
+				drawSeparationPages(printer, &painter, page_extent, separations, std::size_t(step - 1));
 			}
 			else
 			{
@@ -22,6 +22,7 @@
 #ifndef OPENORIENTEERING_MAP_PRINTER_H
 #define OPENORIENTEERING_MAP_PRINTER_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -49,7 +50,9 @@ class QXmlStreamWriter;
 
 namespace OpenOrienteering {
 
+class ColorSeparationIndex;
 class Map;
+class MapColor;
 class MapView;
 class Template;
 
@@ -474,6 +477,14 @@ protected:
 	/** Updates the scale adjustment and page breaks. */
 	void mapScaleChanged();
 	
+	/** Draws the separations for a single tile of the indexes as distinct
+	 *  pages to the printer. */
+	void drawSeparationPages(QPrinter* printer, QPainter* device_painter, const QRectF& page_extent,
+	                         const std::vector<ColorSeparationIndex>& separations, std::size_t tile) const;
+	
+	/** Returns the spot colors which are printed as separations, in printing order. */
+	std::vector<const MapColor*> separationColors() const;
+	
 	Map& map;
 	const MapView* view;
 	const QPrinterInfo* target = nullptr;
@@ -55,6 +55,7 @@
 #include "core/virtual_coord_vector.h"
 #include "fileformats/file_format.h"
 #include "fileformats/file_import_export.h"
+#include "util/profiler.h"
 #include "util/util.h"
 #include "util/xml_stream_util.h"
 
@@ -124,6 +125,7 @@ void Object::copyFrom(const Object& other)
 	if (type != other.type)
 		throw std::invalid_argument(Q_FUNC_INFO);
 	
+	const auto* old_symbol = symbol;
 	symbol = other.symbol;
 	coords = other.coords;
 	rotation = other.rotation;
@@ -131,6 +133,9 @@ void Object::copyFrom(const Object& other)
 	object_tags = other.object_tags;
 	output_dirty = true;
 	extent = other.extent;
+	
+	if (map && symbol != old_symbol)
+		map->objectSymbolChanged(this, old_symbol);
 }
 
 bool Object::equals(const Object* other, bool compare_symbol) const
@@ -478,6 +483,8 @@ bool Object::update() const
 	if (!output_dirty)
 		return false;
 	
+	Profiler::Scope profile("Object::update");
+	
 	Symbol::RenderableOptions options = Symbol::RenderNormal;
 	if (map)
 	{
@@ -487,6 +494,7 @@ bool Object::update() const
 	}
 	
 	output.deleteRenderables();
+	simplified_output.reset();
 	
 	extent = QRectF();
 	
@@ -640,9 +648,25 @@ void Object::takeRenderables()
 void Object::clearRenderables()
 {
 	output.deleteRenderables();
+	simplified_output.reset();
 	extent = QRectF();
 }
 
+const ObjectRenderables& Object::simplifiedRenderables() const
+{
+	if (!simplified_output)
+	{
+		Symbol::RenderableOptions options = Symbol::RenderNormal;
+		if (map)
+			options = QFlag(map->renderableOptions());
+		
+		simplified_extent = QRectF();
+		simplified_output.reset(new ObjectRenderables(simplified_extent));
+		createRenderables(*simplified_output, options | Symbol::RenderSimplified);
+	}
+	return *simplified_output;
+}
+
 bool Object::setSymbol(const Symbol* new_symbol, bool no_checks)
 {
 	if (!no_checks && new_symbol)
@@ -651,8 +675,11 @@ bool Object::setSymbol(const Symbol* new_symbol, bool no_checks)
 			return false;
 	}
 	
+	const auto* old_symbol = symbol;
 	symbol = new_symbol;
 	setOutputDirty();
+	if (map && symbol != old_symbol)
+		map->objectSymbolChanged(this, old_symbol);
 	return true;
 }
 
@@ -3025,6 +3052,24 @@ void PathObject::assignCoordinates(const PathObject& proto, MapCoordVector::size
 	setOutputDirty();
 }
 
+void PathObject::replaceCoordinates(MapCoordVector::size_type first, MapCoordVector::size_type last, const MapCoordVector& replacement)
+{
+	Q_ASSERT(first <= last);
+	Q_ASSERT(last <= coords.size());
+	
+	auto const first_it = coords.begin() + MapCoordVector::difference_type(first);
+	if (last - first == replacement.size())
+	{
+		std::copy(begin(replacement), end(replacement), first_it);
+	}
+	else
+	{
+		auto const last_it = coords.begin() + MapCoordVector::difference_type(last);
+		coords.insert(coords.erase(first_it, last_it), begin(replacement), end(replacement));
+	}
+	recalculateParts();
+}
+
 void PathObject::updatePathCoords() const
 {
 	auto part_start = VirtualPath::size_type { 0 };
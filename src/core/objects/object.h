@@ -23,6 +23,7 @@
 #define OPENORIENTEERING_OBJECT_H
 
 #include <limits>
+#include <memory>
 #include <vector>
 #include <utility>
 
@@ -250,6 +251,16 @@ public:
 	/** Returns the renderables, read-only */
 	const ObjectRenderables& renderables() const;
 	
+	/**
+	 * Returns simplified renderables for drawing at small scales.
+	 * 
+	 * The simplified renderables are created on demand and dropped when the
+	 * output is regenerated. They are not registered with the map.
+	 * 
+	 * \see Symbol::RenderSimplified
+	 */
+	const ObjectRenderables& simplifiedRenderables() const;
+	
 	// Getters / Setters
 	
 	/**
@@ -331,6 +342,8 @@ private:
 	mutable bool output_dirty = true; // does the output have to be re-generated because of changes?
 	mutable QRectF extent;            // only valid after calling update()
 	mutable ObjectRenderables output; // only valid after calling update()
+	mutable QRectF simplified_extent;
+	mutable std::unique_ptr<ObjectRenderables> simplified_output; // created by simplifiedRenderables()
 };
 
 
@@ -598,6 +611,14 @@ public:
 	 */
 	void assignCoordinates(const PathObject& proto, MapCoordVector::size_type first, MapCoordVector::size_type last);
 	
+	/**
+	 * Replaces the coordinates in the range [first, last) by the given coordinates.
+	 * 
+	 * The replacement is taken verbatim, including all flags. The path parts
+	 * are recalculated afterwards.
+	 */
+	void replaceCoordinates(MapCoordVector::size_type first, MapCoordVector::size_type last, const MapCoordVector& replacement);
+	
 	
 	/** Finds the path part containing the given coord index. */
 	PathPartVector::const_iterator findPartForIndex(MapCoordVector::size_type coords_index) const;
@@ -21,7 +21,11 @@
 #include "renderable.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
 #include <iterator>
+#include <memory>
 #include <utility>
 
 #include <Qt>
@@ -32,6 +36,9 @@
 #include <QPainterPath>
 #include <QPen>
 #include <QRgb>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
 #include <QTransform>
 
 #include "core/image_transparency_fixup.h"
@@ -39,6 +46,7 @@
 #include "core/map.h"
 #include "core/objects/object.h"
 #include "core/symbols/symbol.h"
+#include "util/profiler.h"
 #include "util/util.h"
 
 #if defined(Q_OS_ANDROID) && defined(QT_PRINTSUPPORT_LIB)
@@ -84,12 +92,81 @@ namespace OpenOrienteering {
 
 
 
+// ### RenderConfig ###
+
+bool RenderConfig::simplifies(const Symbol* symbol) const
+{
+	if (!testFlag(Screen) || level_of_detail <= 0)
+		return false;
+	
+	// Symbol details smaller than level_of_detail pixels are drawn simplified.
+	auto const detail_size = symbol->detailSize();
+	return detail_size > 0 && detail_size * scaling < level_of_detail;
+}
+
+
+
 // ### Renderable ###
 
 Renderable::~Renderable() = default;
 
 
 
+// ### RenderableArena ###
+
+namespace {
+
+/// The alignment of all allocations from a RenderableArena.
+constexpr std::size_t arena_alignment = alignof(std::max_align_t);
+
+/// The size of the first block of a RenderableArena.
+constexpr std::size_t arena_min_block_size = 256;
+
+/// The limit for growing the blocks of a RenderableArena.
+constexpr std::size_t arena_max_block_size = 65536;
+
+}  // namespace
+
+
+RenderableArena::~RenderableArena() = default;
+
+void* RenderableArena::allocate(std::size_t size)
+{
+	size = (size + arena_alignment - 1) & ~(arena_alignment - 1);
+	if (blocks.empty() || used + size > block_size)
+	{
+		// Memory from new[] is aligned for any fundamental type.
+		block_size = std::max({ size, next_block_size, arena_min_block_size });
+		blocks.emplace_back(new char[block_size]);
+		total_size += block_size;
+		next_block_size = std::min(2 * block_size, arena_max_block_size);
+		used = 0;
+	}
+	auto* memory = blocks.back().get() + used;
+	used += size;
+	return memory;
+}
+
+void RenderableArena::reset()
+{
+	if (blocks.size() > 1)
+	{
+		// The next time, a single block shall take all renderables.
+		next_block_size = total_size;
+		blocks.clear();
+		block_size = 0;
+		total_size = 0;
+	}
+	used = 0;
+}
+
+std::size_t RenderableArena::capacity() const
+{
+	return total_size;
+}
+
+
+
 // ### SharedRenderables ###
 
 SharedRenderables::~SharedRenderables()
@@ -97,32 +174,37 @@ SharedRenderables::~SharedRenderables()
 	deleteRenderables();
 }
 
+RenderableVector& SharedRenderables::operator[](const PainterConfig& config)
+{
+	auto group = std::lower_bound(begin(), end(), config, [](const value_type& item, const PainterConfig& key) {
+		return item.first < key;
+	});
+	if (group == end() || config < group->first)
+		group = insert(group, { config, {} });
+	return group->second;
+}
+
 void SharedRenderables::deleteRenderables()
 {
-	for (auto renderables = begin(); renderables != end(); )
+	for (auto& renderables : *this)
 	{
-		for (auto renderable : renderables->second)
+		for (auto renderable : renderables.second)
 		{
-			delete renderable;
+			// The memory is owned by the arena.
+			renderable->~Renderable();
 		}
-		
-		renderables->second.clear();
-		if (renderables->first.clip_path)
-			renderables = erase(renderables);
-		else
-			++renderables;
+		renderables.second.clear();
 	}
+	erase(std::remove_if(begin(), end(), [](const value_type& item) {
+		return item.first.clip_path != nullptr;
+	}), end());
 }
 
 void SharedRenderables::compact()
 {
-	for (auto renderables = begin(); renderables != end(); )
-	{
-		if (renderables->second.empty())
-			renderables = erase(renderables);
-		else
-			++renderables;
-	}
+	erase(std::remove_if(begin(), end(), [](const value_type& item) {
+		return item.second.empty();
+	}), end());
 }
 
 
@@ -134,6 +216,12 @@ ObjectRenderables::ObjectRenderables(Object& object)
 	// nothing else
 }
 
+ObjectRenderables::ObjectRenderables(QRectF& extent)
+: extent(extent)
+{
+	// nothing else
+}
+
 ObjectRenderables::~ObjectRenderables() = default;
 
 void ObjectRenderables::draw(int map_color, const QColor& color, QPainter* painter, const RenderConfig& config) const
@@ -177,7 +265,10 @@ void ObjectRenderables::insertRenderable(Renderable* r, const PainterConfig& sta
 {
 	SharedRenderables::Pointer& container(operator[](state.color_priority));
 	if (!container)
+	{
 		container = new SharedRenderables();
+		container->arena = arena;
+	}
 	container->operator[](state).push_back(r);
 	if (!clip_path)
 	{
@@ -188,21 +279,17 @@ void ObjectRenderables::insertRenderable(Renderable* r, const PainterConfig& sta
 	}
 }
 
-void ObjectRenderables::clear()
-{
-	for (auto& renderables : *this)
-	{
-		renderables.second->clear();
-	}
-}
-
 void ObjectRenderables::takeRenderables()
 {
+	// The old containers keep the old arena.
+	arena = new RenderableArena();
 	for (auto& color : *this)
 	{
 		auto new_container = new SharedRenderables();
+		new_container->arena = arena;
 		
 		// Pre-allocate as much space as in the original container
+		new_container->reserve(color.second->size());
 		for (const auto& renderables : *color.second)
 		{
 			(*new_container)[renderables.first].reserve(renderables.second.size());
@@ -217,6 +304,8 @@ void ObjectRenderables::deleteRenderables()
 	{
 		color.second->deleteRenderables();
 	}
+	if (arena)
+		arena->reset();
 }
 
 
@@ -237,6 +326,8 @@ MapRenderables::MapRenderables(Map* map)
 
 void MapRenderables::draw(QPainter *painter, const RenderConfig &config) const
 {
+	Profiler::Scope profile("MapRenderables::draw");
+	
 	// TODO: improve performance by using some spatial acceleration structure?
 	
 #ifdef Q_OS_ANDROID
@@ -273,7 +364,17 @@ void MapRenderables::draw(QPainter *painter, const RenderConfig &config) const
 			if (!object.first->getExtent().intersects(config.bounding_box))
 				continue;
 			
-			for (const auto& renderables : *object.second)
+			const SharedRenderables* object_renderables = object.second.constData();
+			if (config.simplifies(symbol))
+			{
+				const auto& simplified = object.first->simplifiedRenderables();
+				auto color_renderables = simplified.find(color->first);
+				if (color_renderables == simplified.end())
+					continue;
+				object_renderables = color_renderables->second.constData();
+			}
+			
+			for (const auto& renderables : *object_renderables)
 			{
 				// Render the renderables
 				const PainterConfig& state = renderables.first;
@@ -415,6 +516,197 @@ void MapRenderables::drawOverprintingSimulation(QPainter* painter, const RenderC
 	}
 }
 
+namespace {
+
+/**
+ * Determines how the renderables of a color contribute to a separation.
+ * 
+ * Returns false if they are not drawn to the separation. Otherwise, sets the
+ * spot color component to draw with. A factor of zero means a knockout, which
+ * only matters after drawing to the separation has started.
+ */
+bool getSeparationComponent(const Map& map, int color_priority, const MapColor* separation, SpotColorComponent& drawing_color)
+{
+	drawing_color = SpotColorComponent(map.getColor(color_priority), 1.0f);
+	
+	if (color_priority > MapColor::Reserved)
+	{
+		if (separation->getPriority() == MapColor::Reserved)
+		{
+			// Don't process regular colors for the "Reserved" separation.
+			return false;
+		}
+		
+		switch (drawing_color.spot_color->getSpotColorMethod())
+		{
+			case MapColor::UndefinedMethod:
+				return false;
+			
+			case MapColor::SpotColor:
+				if (drawing_color.spot_color == separation)
+				{
+					return true;
+				}
+				else if (drawing_color.spot_color->getKnockout())
+				{
+					drawing_color.factor = 0.0f;
+					return true;
+				}
+				return false;
+			
+			case MapColor::CustomColor:
+			{
+				// First, check if the renderables draw color to this separation
+				const SpotColorComponents& components = drawing_color.spot_color->getComponents();
+				for (const auto& component : components)
+				{
+					if (component.spot_color == separation)
+					{
+						// The renderables do draw the current spot color
+						drawing_color = component;
+						return true;
+					}
+				}
+				// If the renderables do not explicitly draw color to this separation,
+				// check if they need a knockout.
+				if (drawing_color.spot_color->getKnockout())
+				{
+					drawing_color = SpotColorComponent(separation, 0.0f);
+					return true;
+				}
+				return false;
+			}
+			
+			default:
+				Q_ASSERT(false); // in development builds
+				return false;    // in release build
+		}
+	}
+	else if (separation->getPriority() == MapColor::Reserved)
+	{
+		if (color_priority == MapColor::Registration)
+			return false; // treated per spot color
+		else if (color_priority == MapColor::Reserved)
+			return false; // never drawn
+		else if (!drawing_color.spot_color)
+		{
+			Q_ASSERT(!"Invalid reserved color!");                // in development build
+			drawing_color.spot_color = Map::getUndefinedColor(); // in release build
+		}
+		return true;
+	}
+	else if (color_priority == MapColor::Registration)
+	{
+		// Draw Registration Black as fulltone of regular spot color
+		drawing_color.spot_color = separation;
+		return true;
+	}
+	
+	// Don't draw reserved color in regular separation.
+	return false;
+}
+
+
+/**
+ * Returns true if the object's symbol is to be drawn with the given config.
+ */
+bool isDrawn(const Object& object, const RenderConfig& config)
+{
+	const Symbol* symbol = object.getSymbol();
+	if (!config.testFlag(RenderConfig::HelperSymbols) && symbol->isHelperSymbol())
+		return false;
+	return !symbol->isHidden();
+}
+
+
+/**
+ * Draws the renderables of a single object and color to a separation.
+ * 
+ * As soon as the spot color is actually used for drawing (i.e. drawing_started = true),
+ * knockouts need to be drawn, too.
+ */
+void drawSeparationRenderables(QPainter* painter, const RenderConfig& config,
+                               const SharedRenderables& object_renderables,
+                               const SpotColorComponent& drawing_color, bool use_color,
+                               bool& drawing_started,
+                               const QPainterPath*& current_clip, const QPainterPath& initial_clip)
+{
+	QColor color = *drawing_color.spot_color;
+	bool drawing = (drawing_color.factor >= 0.0005f);
+	if (!drawing)
+	{
+		if (!drawing_started)
+			return;
+		color = Qt::white;
+	}
+	else if (use_color)
+	{
+		qreal c, m, y, k;
+		color.getCmykF(&c, &m, &y, &k);
+		color.setCmykF(c*drawing_color.factor, m*drawing_color.factor, y*drawing_color.factor, k*drawing_color.factor, 1.0);
+	}
+	else
+	{
+		color.setCmykF(0.0, 0.0, 0.0, drawing_color.factor, 1.0);
+	}
+	
+	// For each pair of common rendering attributes and collection of renderables...
+	for (const auto& renderables : object_renderables)
+	{
+		const PainterConfig& state = renderables.first;
+		if (!state.activate(painter, current_clip, config, color, initial_clip))
+			continue;
+		
+		// For each renderable that uses the current painter configuration...
+		// Render the renderable
+		for (const auto* renderable : renderables.second)
+		{
+			if (renderable->intersects(config.bounding_box))
+			{
+				renderable->render(*painter, config);
+				drawing_started |= drawing;
+			}
+		}
+	}
+}
+
+
+/**
+ * The shared state of a ColorSeparationIndex::create() batch.
+ * 
+ * All workers take the index of the next separation from a shared counter.
+ */
+struct SeparationBatch
+{
+	const MapRenderables& renderables;
+	const std::vector<const MapColor*>& separations;
+	const std::vector<QRectF>& tiles;
+	std::vector<ColorSeparationIndex>& indexes;
+	std::atomic<std::size_t> next { 0 };
+	
+	void build()
+	{
+		for (auto i = next++; i < separations.size(); i = next++)
+			indexes[i] = ColorSeparationIndex(renderables, separations[i], tiles);
+	}
+};
+
+
+class SeparationJob : public QRunnable
+{
+public:
+	explicit SeparationJob(SeparationBatch& batch) : batch(batch) {}
+	
+	void run() override { batch.build(); }
+	
+private:
+	SeparationBatch& batch;
+};
+
+}  // namespace
+
+
+
 void MapRenderables::drawColorSeparation(QPainter* painter, const RenderConfig& config, const MapColor* separation, bool use_color) const
 {
 	painter->save();
@@ -435,148 +727,26 @@ void MapRenderables::drawColorSeparation(QPainter* painter, const RenderConfig&
 	}
 	for (; color != end_of_colors; ++color)
 	{
-		SpotColorComponent drawing_color(map->getColor(color->first), 1.0f);
-		
 		// Check whether the current color [priority] applies to the current separation.
-		if (color->first > MapColor::Reserved)
-		{
-			if (separation->getPriority() == MapColor::Reserved)
-			{
-				// Don't process regular colors for the "Reserved" separation.
-				continue;
-			}
-			
-			switch (drawing_color.spot_color->getSpotColorMethod())
-			{
-				case MapColor::UndefinedMethod:
-					continue;
-				
-				case MapColor::SpotColor:
-					if (drawing_color.spot_color == separation)
-					{
-						; // okay
-					}
-					else if (drawing_started && drawing_color.spot_color->getKnockout())
-					{
-						drawing_color.factor = 0.0f;
-					}
-					else
-					{
-						continue;
-					}
-					break;
-				
-				case MapColor::CustomColor:
-				{
-					// First, check if the renderables draw color to this separation
-					// TODO: Use an efficient data structure to avoid reiterating each time a separation is drawn
-					const SpotColorComponents& components = drawing_color.spot_color->getComponents();
-					for (const auto& component : components)
-					{
-						if (component.spot_color == separation)
-						{
-							// The renderables do draw the current spot color
-							drawing_color = component;
-							break;
-						}
-					}
-					if (drawing_color.spot_color != separation)
-					{
-						// If the renderables do not explicitly draw color to this separation,
-						// check if they need a knockout.
-						if (drawing_started && drawing_color.spot_color->getKnockout())
-						{
-							drawing_color = SpotColorComponent(separation, 0.0f);
-						}
-						else
-						{
-							continue;
-						}
-					}
-					break;
-				}
-				
-				default:
-					Q_ASSERT(false); // in development builds
-					continue;        // in release build
-			}
-		}
-		else if (separation->getPriority() == MapColor::Reserved)
-		{
-			if (color->first == MapColor::Registration)
-				continue; // treated per spot color
-			else if (color->first == MapColor::Reserved)
-				continue; // never drawn
-			else if (!drawing_color.spot_color)
-			{
-				Q_ASSERT(!"Invalid reserved color!");                // in development build
-				drawing_color.spot_color = Map::getUndefinedColor(); // in release build
-			}
-			painter->setRenderHint(QPainter::Antialiasing, true);
-		}
-		else if (color->first == MapColor::Registration)
-		{
-			// Draw Registration Black as fulltone of regular spot color
-			drawing_color.spot_color = separation;
-		}
-		else
-		{
-			// Don't draw reserved color in regular separation.
+		SpotColorComponent drawing_color;
+		if (!getSeparationComponent(*map, color->first, separation, drawing_color))
 			continue;
-		}
+		
+		if (separation->getPriority() == MapColor::Reserved)
+			painter->setRenderHint(QPainter::Antialiasing, true);
 		
 		// For each pair of object and its renderables [states] for a particular map color...
 		for (const auto& object : color->second)
 		{
 			// Check whether the symbol and object is to be drawn at all.
-			const Symbol* symbol = object.first->getSymbol();
-			if (!config.testFlag(RenderConfig::HelperSymbols) && symbol->isHelperSymbol())
-				continue;
-			if (symbol->isHidden())
+			if (!isDrawn(*object.first, config))
 				continue;
 			
 			if (!object.first->getExtent().intersects(config.bounding_box))
 				continue;
 			
-			// For each pair of common rendering attributes and collection of renderables...
-			for (const auto& renderables : *object.second)
-			{
-				const PainterConfig& state = renderables.first;
-				
-				QColor color = *drawing_color.spot_color;
-				bool drawing = (drawing_color.factor >= 0.0005f);
-				if (!drawing)
-				{
-					if (!drawing_started)
-						continue;
-					color = Qt::white;
-				}
-				else if (use_color)
-				{
-					qreal c, m, y, k;
-					color.getCmykF(&c, &m, &y, &k);
-					color.setCmykF(c*drawing_color.factor, m*drawing_color.factor, y*drawing_color.factor, k*drawing_color.factor, 1.0);
-				}
-				else
-				{
-					color.setCmykF(0.0, 0.0, 0.0, drawing_color.factor, 1.0);
-				}
-				
-				if (!state.activate(painter, current_clip, config, color, initial_clip))
-					continue;
-				
-				// For each renderable that uses the current painter configuration...
-				// Render the renderable
-				for (const auto* renderable : renderables.second)
-				{
-					if (renderable->intersects(config.bounding_box))
-					{
-						renderable->render(*painter, config);
-						drawing_started |= drawing;
-					}
-				}
-				
-			} // each common render attributes
+			drawSeparationRenderables(painter, config, *object.second, drawing_color, use_color,
+			                          drawing_started, current_clip, initial_clip);
 			
 		} // each object
 		
@@ -646,6 +816,99 @@ void MapRenderables::clear(bool mark_area_as_dirty)
 	std::map<int, ObjectRenderablesMap>::clear();
 }
 
+// ### ColorSeparationIndex ###
+
+ColorSeparationIndex::ColorSeparationIndex(const MapRenderables& renderables, const MapColor* separation, const std::vector<QRectF>& tiles)
+: spot_color(separation)
+, tile_entries(tiles.size())
+{
+	const auto& map = *renderables.map;
+	auto end_of_colors = renderables.rend();
+	auto color = renderables.rbegin();
+	while (color != end_of_colors && color->first >= map.getNumColors())
+	{
+		++color;
+	}
+	for (; color != end_of_colors; ++color)
+	{
+		SpotColorComponent drawing_color;
+		if (!getSeparationComponent(map, color->first, separation, drawing_color))
+			continue;
+		
+		for (const auto& object : color->second)
+		{
+			// Helper symbols depend on the config, and are checked when drawing.
+			if (object.first->getSymbol()->isHidden())
+				continue;
+			
+			const auto& extent = object.first->getExtent();
+			auto const index = entries.size();
+			auto used = false;
+			for (std::size_t i = 0; i < tiles.size(); ++i)
+			{
+				if (extent.intersects(tiles[i]))
+				{
+					tile_entries[i].push_back(index);
+					used = true;
+				}
+			}
+			if (used)
+				entries.push_back({ object.first, object.second.data(), drawing_color });
+		}
+	}
+}
+
+
+// static
+std::vector<ColorSeparationIndex> ColorSeparationIndex::create(const MapRenderables& renderables, const std::vector<const MapColor*>& separations, const std::vector<QRectF>& tiles)
+{
+	auto indexes = std::vector<ColorSeparationIndex>(separations.size());
+	SeparationBatch batch { renderables, separations, tiles, indexes };
+	
+	auto const num_helpers = std::min(QThread::idealThreadCount(), int(separations.size())) - 1;
+	if (num_helpers <= 0)
+	{
+		batch.build();
+		return indexes;
+	}
+	
+	QThreadPool pool;
+	pool.setMaxThreadCount(num_helpers);
+	for (int i = 0; i < num_helpers; ++i)
+		pool.start(new SeparationJob(batch));
+	batch.build();  // The calling thread takes its share, too.
+	pool.waitForDone();
+	return indexes;
+}
+
+
+void ColorSeparationIndex::draw(QPainter* painter, const RenderConfig& config, std::size_t tile, bool use_color) const
+{
+	if (!spot_color || tile >= tile_entries.size())
+		return;
+	
+	painter->save();
+	
+	const QPainterPath initial_clip(painter->clipPath());
+	const QPainterPath* current_clip = nullptr;
+	bool drawing_started = false;
+	
+	if (spot_color->getPriority() == MapColor::Reserved)
+		painter->setRenderHint(QPainter::Antialiasing, true);
+	
+	for (auto index : tile_entries[tile])
+	{
+		const auto& entry = entries[index];
+		if (!isDrawn(*entry.object, config))
+			continue;
+		
+		drawSeparationRenderables(painter, config, *entry.renderables, entry.drawing_color, use_color,
+		                          drawing_started, current_clip, initial_clip);
+	}
+	
+	painter->restore();
+}
+
 // ### PainterConfig ###
 
 namespace {
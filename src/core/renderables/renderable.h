@@ -21,7 +21,11 @@
 #ifndef OPENORIENTEERING_RENDERABLE_H
 #define OPENORIENTEERING_RENDERABLE_H
 
+#include <cstddef>
 #include <map>
+#include <memory>
+#include <new>
+#include <utility>
 #include <vector>
 
 #include <QtGlobal>
@@ -42,6 +46,7 @@ namespace OpenOrienteering {
 class Map;
 class Object;
 class PainterConfig;
+class Symbol;
 
 
 /**
@@ -98,12 +103,24 @@ public:
 	
 	qreal   opacity;      ///< The opacity.
 	
+	qreal   level_of_detail = 0; ///< The size in pixels below which symbol details
+	                             ///  are drawn simplified. Zero disables simplification.
+	                             ///  Used only with the Screen option.
+	
 	/**
 	 * A convenience method for testing flags in the options value.
 	 * 
 	 * \see QFlags::testFlag()
 	 */
 	bool testFlag(const Option flag) const;
+	
+	/**
+	 * Returns true if objects with the given symbol are drawn simplified.
+	 * 
+	 * This is the case for screen output when the symbol's detailSize()
+	 * is smaller than level_of_detail pixels.
+	 */
+	bool simplifies(const Symbol* symbol) const;
 };
 
 
@@ -170,7 +187,9 @@ protected:
  * When painting a renderable item, the QPainter shall be configured according
  * to this information.
  * 
- * A PainterConfig is an immutable values, constructed with initializer lists.
+ * A PainterConfig is a value type, constructed with initializer lists.
+ * It is not meant to be modified after construction, but it is assignable
+ * so that it can be stored in sorted vectors.
  */
 class PainterConfig
 {
@@ -182,9 +201,9 @@ public:
 		Reserved  = -1	///< Not used.
 	};
 	
-	const int color_priority;       ///< The color priority which determines rendering order
-	const PainterMode mode;         ///< The mode of painting
-	const qreal pen_width;          ///< The width of the pen
+	int color_priority;             ///< The color priority which determines rendering order
+	PainterMode mode;               ///< The mode of painting
+	qreal pen_width;                ///< The width of the pen
 	const QPainterPath* clip_path;  ///< A clip_path which may be shared by several Renderables
 	
 	/**
@@ -230,23 +249,92 @@ typedef std::vector<Renderable*> RenderableVector;
 
 
 
+/**
+ * The memory for the renderables of a single object.
+ * 
+ * An object may have many small renderables. They are constructed in a few
+ * blocks of memory per object, instead of one heap allocation each, so that
+ * they take less memory and are close together when drawing. The blocks are
+ * released when the last container which refers to the arena is deleted.
+ * 
+ * The arena doesn't destroy the renderables. This must be done before the
+ * memory is reset or released.
+ */
+class RenderableArena : public QSharedData
+{
+public:
+	typedef QExplicitlySharedDataPointer<RenderableArena> Pointer;
+	
+	RenderableArena() = default;
+	RenderableArena(const RenderableArena&) = delete;
+	RenderableArena& operator=(const RenderableArena&) = delete;
+	~RenderableArena();
+	
+	/**
+	 * Returns uninitialized memory of the given size.
+	 * 
+	 * The memory is aligned for any type with fundamental alignment.
+	 */
+	void* allocate(std::size_t size);
+	
+	/**
+	 * Makes all memory available again.
+	 * 
+	 * When the memory is spread over multiple blocks, these blocks are
+	 * replaced by a single block on the next allocation.
+	 */
+	void reset();
+	
+	/**
+	 * Returns the size of all blocks of memory.
+	 */
+	std::size_t capacity() const;
+	
+private:
+	std::vector<std::unique_ptr<char[]>> blocks;
+	std::size_t block_size = 0;       ///< The size of the last block
+	std::size_t used = 0;             ///< The used part of the last block
+	std::size_t total_size = 0;       ///< The size of all blocks
+	std::size_t next_block_size = 0;  ///< The minimum size of the next block
+};
+
+
+
 /**
  * A shared high-level container for renderables
  * grouped by common render attributes.
  * 
+ * The groups are kept in a vector sorted by PainterConfig. An object has only
+ * a few groups, so this is more compact and faster to iterate than a map.
+ * 
  * This shared container can be used in different collections. When the last
- * reference to this container is dropped, it will delete the renderables.
+ * reference to this container is dropped, it will destroy the renderables.
+ * The renderables are constructed in the arena of their ObjectRenderables,
+ * which is kept alive by the container.
  */
-class SharedRenderables : public QSharedData, public std::map< PainterConfig, RenderableVector >
+class SharedRenderables : public QSharedData, public std::vector< std::pair<PainterConfig, RenderableVector> >
 {
+friend class ObjectRenderables;
 public:
 	typedef QExplicitlySharedDataPointer<SharedRenderables> Pointer;
 	SharedRenderables() = default;
 	SharedRenderables(const SharedRenderables&) = delete;
 	SharedRenderables& operator=(const SharedRenderables&) = delete;
 	~SharedRenderables();
+	
+	/**
+	 * Returns the renderables for the given configuration.
+	 * 
+	 * Inserts an empty group if there is no group for this configuration yet.
+	 * References to other groups may be invalidated by the insertion.
+	 */
+	RenderableVector& operator[](const PainterConfig& config);
+	
 	void deleteRenderables();
 	void compact(); // release memory which is occupied by unused PainterConfig, FIXME: maybe call this regularly...
+	
+private:
+	RenderableArena::Pointer arena;
 };
 
 
@@ -254,21 +342,38 @@ public:
 /**
  * A high-level container for all renderables of a single object, 
  * grouped by color priority and common render attributes.
+ * 
+ * The renderables are constructed in the object's RenderableArena.
  */
 class ObjectRenderables : protected std::map<int, SharedRenderables::Pointer>
 {
 friend class MapRenderables;
 public:
 	ObjectRenderables(Object& object);
+	explicit ObjectRenderables(QRectF& extent);
 	ObjectRenderables(const ObjectRenderables&) = delete;
 	ObjectRenderables& operator=(const ObjectRenderables&) = delete;
 	~ObjectRenderables();
 	
-	inline void insertRenderable(Renderable* r);
-	void insertRenderable(Renderable* r, const PainterConfig& state);
+	/**
+	 * Constructs a renderable of type T from the given arguments, and inserts it.
+	 * 
+	 * Returns the new renderable. It is owned by this container.
+	 */
+	template <class T, class... Args>
+	T* emplaceRenderable(Args&&... args);
 	
-	void clear();
+	/**
+	 * Destroys all renderables, and makes their memory available again.
+	 */
 	void deleteRenderables();
+	
+	/**
+	 * Replaces the containers and the arena by new ones.
+	 * 
+	 * The renderables stay in the old containers, for other collections
+	 * which refer to these containers.
+	 */
 	void takeRenderables();
 	
 	/**
@@ -286,8 +391,12 @@ public:
 	const QRectF& getExtent() const;
 	
 private:
+	inline void insertRenderable(Renderable* r);
+	void insertRenderable(Renderable* r, const PainterConfig& state);
+	
 	QRectF& extent;
 	const QPainterPath* clip_path = nullptr; // no memory management here!
+	RenderableArena::Pointer arena;
 };
 
 
@@ -369,11 +478,73 @@ public:
 	inline bool empty() const;
 	
 private:
+	friend class ColorSeparationIndex;
+	
 	Map* const map;
 };
 
 
 
+/**
+ * The renderables of a single color separation, sorted into tiles.
+ * 
+ * MapRenderables::drawColorSeparation() determines the contribution of each
+ * color to the separation, and it visits all objects, each time it is called.
+ * When the same separation is drawn for many tiles (e.g. printed pages), an
+ * index does this work only once, and each tile gets the list of objects
+ * which intersect with it.
+ * 
+ * The index refers to the renderables without owning them. It must not be
+ * used after the objects of the map were modified.
+ */
+class ColorSeparationIndex
+{
+public:
+	/**
+	 * Constructs an empty index which draws nothing.
+	 */
+	ColorSeparationIndex() = default;
+	
+	/**
+	 * Constructs an index for the given separation and tiles.
+	 * 
+	 * The tiles are given in map coordinates.
+	 */
+	ColorSeparationIndex(const MapRenderables& renderables, const MapColor* separation, const std::vector<QRectF>& tiles);
+	
+	/**
+	 * Constructs the indexes for multiple separations, on multiple threads.
+	 */
+	static std::vector<ColorSeparationIndex> create(const MapRenderables& renderables, const std::vector<const MapColor*>& separations, const std::vector<QRectF>& tiles);
+	
+	/**
+	 * Returns the spot color of this separation.
+	 */
+	const MapColor* separation() const { return spot_color; }
+	
+	/**
+	 * Draws the separation for the tile with the given index.
+	 * 
+	 * This is equivalent to MapRenderables::drawColorSeparation() with the
+	 * tile's extent as config.bounding_box.
+	 */
+	void draw(QPainter* painter, const RenderConfig& config, std::size_t tile, bool use_color = false) const;
+	
+private:
+	struct Entry
+	{
+		const Object* object;
+		const SharedRenderables* renderables;
+		SpotColorComponent drawing_color;
+	};
+	
+	const MapColor* spot_color = nullptr;
+	std::vector<Entry> entries;
+	std::vector<std::vector<std::size_t>> tile_entries;
+};
+
+
+
 // ### RenderConfig ###
 
 inline
@@ -448,6 +619,17 @@ bool operator<(const PainterConfig& lhs, const PainterConfig& rhs)
 
 // ### ObjectRenderables ###
 
+template <class T, class... Args>
+T* ObjectRenderables::emplaceRenderable(Args&&... args)
+{
+	Q_STATIC_ASSERT(alignof(T) <= alignof(std::max_align_t));
+	if (!arena)
+		arena = new RenderableArena();
+	auto* renderable = new (arena->allocate(sizeof(T))) T(std::forward<Args>(args)...);
+	insertRenderable(renderable);
+	return renderable;
+}
+
 inline
 void ObjectRenderables::insertRenderable(Renderable* r)
 {
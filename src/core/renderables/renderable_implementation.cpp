@@ -736,7 +736,7 @@ TextRenderable::TextRenderable(const TextSymbol* symbol, const TextObject* text_
 				}
 				underline_x0 = part.part_x;
 			}
-			path.addText(part.part_x, line_y, font, part.part_text);
+			symbol->addTextOutline(path, part.part_x, line_y, part.part_text);
 		}
 	}
 	
@@ -244,7 +244,7 @@ void AreaSymbol::FillPattern::createLine<AreaSymbol::FillPattern::LinePattern>(
         ObjectRenderables& output ) const
 {
 	// out of inlining
-	output.insertRenderable(new LineRenderable(line, first, second));
+	output.emplaceRenderable<LineRenderable>(line, first, second);
 }
 
 
@@ -623,6 +623,10 @@ void AreaSymbol::createRenderables(
 	{
 		createRenderablesNormal(object, path_parts, output);
 	}
+	else if (options == Symbol::RenderSimplified)
+	{
+		createRenderablesSimplified(object, path_parts, output);
+	}
 	else
 	{
 		const MapColor* dominant_color = guessDominantColor();
@@ -642,8 +646,7 @@ void AreaSymbol::createRenderablesNormal(
 {
 	// The shape output is even created if the area is not filled with a color
 	// because the QPainterPath created by it is needed as clip path for the fill objects
-	auto color_fill = new AreaRenderable(this, path_parts);
-	output.insertRenderable(color_fill);
+	auto color_fill = output.emplaceRenderable<AreaRenderable>(this, path_parts);
 	
 	auto rotation = object->getPatternRotation();
 	auto origin = object->getPatternOrigin();
@@ -653,6 +656,25 @@ void AreaSymbol::createRenderablesNormal(
 	}
 }
 
+void AreaSymbol::createRenderablesSimplified(
+        const PathObject* object,
+        const PathPartVector& path_parts,
+        ObjectRenderables& output) const
+{
+	auto color_fill = output.emplaceRenderable<AreaRenderable>(this, path_parts);
+	
+	if (color)
+		return;
+	
+	auto rotation = object->getPatternRotation();
+	auto origin = object->getPatternOrigin();
+	for (const auto& pattern : patterns)
+	{
+		if (pattern.type == FillPattern::LinePattern)
+			pattern.createRenderables(*color_fill, rotation, origin, output);
+	}
+}
+
 void AreaSymbol::createHatchingRenderables(
         const PathObject* object,
         const PathPartVector& path_parts,
@@ -771,6 +793,23 @@ qreal AreaSymbol::dimensionForIcon() const
 }
 
 
+qreal AreaSymbol::detailSize() const
+{
+	auto size = qreal(0);
+	for (const auto& pattern : patterns)
+	{
+		auto spacing = 0;
+		if (pattern.type == FillPattern::PointPattern)
+			spacing = std::min(pattern.line_spacing, pattern.point_distance);
+		else if (color)
+			spacing = pattern.line_spacing;
+		if (spacing > 0 && (size == 0 || 0.001 * spacing < size))
+			size = 0.001 * spacing;
+	}
+	return size;
+}
+
+
 
 bool AreaSymbol::hasRotatableFillPattern() const
 {
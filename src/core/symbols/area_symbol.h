@@ -257,6 +257,17 @@ public:
 	        const PathPartVector& path_parts,
 	        ObjectRenderables& output) const;
 	
+	/**
+	 * Creates simplified renderables for a path object.
+	 * 
+	 * Point patterns are omitted. Line patterns are omitted, too, unless
+	 * the area has no fill color.
+	 */
+	void createRenderablesSimplified(
+	        const PathObject* object,
+	        const PathPartVector& path_parts,
+	        ObjectRenderables& output) const;
+	
 	/**
 	 * Creates area hatching renderables for a path object.
 	 */
@@ -275,6 +286,12 @@ public:
 	
 	qreal dimensionForIcon() const override;
 	
+	/**
+	 * Returns the smallest spacing of the patterns which are omitted
+	 * in simplified output.
+	 */
+	qreal detailSize() const override;
+	
 	// Getters / Setters
 	inline const MapColor* getColor() const {return color;}
 	inline void setColor(const MapColor* color) {this->color = color;}
@@ -357,6 +357,16 @@ qreal CombinedSymbol::calculateLargestLineExtent() const
 }
 
 
+qreal CombinedSymbol::detailSize() const
+{
+	// The largest detail decides when the parts are simplified.
+	return std::accumulate(begin(parts), end(parts), qreal(0), [](qreal value, auto subsymbol)
+	{
+		return subsymbol ? qMax(value, subsymbol->detailSize()) : value;
+	});
+}
+
+
 
 void CombinedSymbol::setPart(int i, const Symbol* symbol, bool is_private)
 {
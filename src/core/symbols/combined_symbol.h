@@ -97,6 +97,8 @@ public:
 	
     qreal calculateLargestLineExtent() const override;
 	
+	qreal detailSize() const override;
+	
 	// Getters / Setter
 	inline int getNumParts() const {return (int)parts.size();}
 	inline void setNumParts(int num) {parts.resize(num, nullptr); private_parts.resize(num, false);}
@@ -276,6 +276,10 @@ void LineSymbol::createRenderables(
 	{
 		createBaselineRenderables(object, path_parts, output, guessDominantColor());
 	}
+	else if (options.testFlag(Symbol::RenderSimplified))
+	{
+		createSimplifiedRenderables(object, path_parts, output);
+	}
 	else
 	{
 		createStartEndSymbolRenderables(path_parts, output);
@@ -287,6 +291,33 @@ void LineSymbol::createRenderables(
 }
 
 
+void LineSymbol::createSimplifiedRenderables(
+        const PathObject* object,
+        const PathPartVector& path_parts,
+        ObjectRenderables& output) const
+{
+	auto create_line = color && line_width > 0;
+	auto create_border = have_border_lines && (border.isVisible() || right_border.isVisible());
+	if (!create_line && !create_border)
+	{
+		createBaselineRenderables(object, path_parts, output, guessDominantColor());
+		return;
+	}
+	
+	for (const auto& part : path_parts)
+	{
+		if (part.size() < 2)
+			continue;
+		
+		if (create_line)
+			output.emplaceRenderable<LineRenderable>(this, part, part.isClosed());
+		
+		if (create_border)
+			createBorderLines(part, SplitPathCoord::begin(part.path_coords), SplitPathCoord::end(part.path_coords), output);
+	}
+}
+
+
 void LineSymbol::createSinglePathRenderables(const VirtualPath& path, bool path_closed, ObjectRenderables& output) const
 {
 	if (path.size() < 2)
@@ -306,7 +337,7 @@ void LineSymbol::createSinglePathRenderables(const VirtualPath& path, bool path_
 		// This is a simple plain line (no pointed line ends, no dashes).
 		// It may be drawn directly from the given path.
 		if (create_line)
-			output.insertRenderable(new LineRenderable(this, path, path_closed));
+			output.emplaceRenderable<LineRenderable>(this, path, path_closed);
 		
 		auto create_mid_symbols = mid_symbol && !mid_symbol->isEmpty() && segment_length > 0;
 		if (create_mid_symbols || create_border)
@@ -406,7 +437,7 @@ void LineSymbol::createSinglePathRenderables(const VirtualPath& path, bool path_
 		processed_path.path_coords.update(path.first_index);
 		if (create_line)
 		{
-			output.insertRenderable(new LineRenderable(this, processed_path, path_closed));
+			output.emplaceRenderable<LineRenderable>(this, processed_path, path_closed);
 		}
 		if (create_border)
 		{
@@ -460,7 +491,7 @@ void LineSymbol::createBorderLines(
 		auto border_path = VirtualPath{border_flags, border_coords};
 		auto last = border_path.path_coords.update(0);
 		Q_ASSERT(last+1 == border_coords.size()); Q_UNUSED(last);
-		output.insertRenderable(new LineRenderable(&border_symbol, border_path, path_closed));
+		output.emplaceRenderable<LineRenderable>(&border_symbol, border_path, path_closed);
 	}
 		
 	if (right_border.isVisible())
@@ -490,7 +521,7 @@ void LineSymbol::createBorderLines(
 		auto border_path = VirtualPath{border_flags, border_coords};
 		auto last = border_path.path_coords.update(0);
 		Q_ASSERT(last+1 == border_coords.size()); Q_UNUSED(last);
-		output.insertRenderable(new LineRenderable(&border_symbol, border_path, path_closed));
+		output.emplaceRenderable<LineRenderable>(&border_symbol, border_path, path_closed);
 	}
 }
 
@@ -993,7 +1024,7 @@ void LineSymbol::createPointedLineCap(
 	
 	VirtualPath cap_path { cap_flags, cap_coords };
 	cap_path.path_coords.update(0);
-	output.insertRenderable(new AreaRenderable(&area_symbol, cap_path));
+	output.emplaceRenderable<AreaRenderable>(&area_symbol, cap_path);
 }
 
 void LineSymbol::processDashedLine(
@@ -1735,6 +1766,23 @@ qreal LineSymbol::calculateLargestLineExtent() const
 }
 
 
+qreal LineSymbol::detailSize() const
+{
+	auto size = qreal(0);
+	auto const include = [&size](qreal value) {
+		if (value > 0 && (size == 0 || value < size))
+			size = value;
+	};
+	if (dashed && dash_length > 0)
+		include(0.001 * (dash_length + break_length));
+	if (mid_symbol && !mid_symbol->isEmpty() && segment_length > 0)
+		include(0.001 * segment_length);
+	if (dash_symbol && !dash_symbol->isEmpty())
+		include(dash_symbol->dimensionForIcon());
+	return size;
+}
+
+
 
 void LineSymbol::setStartSymbol(PointSymbol* symbol)
 {
@@ -147,6 +147,18 @@ public:
 	        ObjectRenderables &output,
 	        Symbol::RenderableOptions options ) const override;
 	
+	/**
+	 * Creates simplified renderables for a path object.
+	 * 
+	 * Dashes, mid symbols, dash symbols, start and end symbols are omitted,
+	 * leaving a solid main line and the borders. Lines which consist only of
+	 * symbols are shown as baselines in the dominant color.
+	 */
+	void createSimplifiedRenderables(
+	        const PathObject* object,
+	        const PathPartVector& path_parts,
+	        ObjectRenderables& output) const;
+	
 	/**
 	 * Creates the renderables for a single path (i.e. a single part).
 	 * 
@@ -195,6 +207,12 @@ public:
 	 */
 	qreal calculateLargestLineExtent() const override;
 	
+	/**
+	 * Returns the smallest of dash pattern length, mid symbol segment length
+	 * and dash symbol size.
+	 */
+	qreal detailSize() const override;
+	
 	
 	
 	/**
@@ -134,9 +134,9 @@ void PointSymbol::createRenderables(
 void PointSymbol::createRenderablesScaled(const MapCoordF& coord, qreal rotation, ObjectRenderables& output, qreal coord_scale) const
 {
 	if (inner_color && inner_radius > 0)
-		output.insertRenderable(new DotRenderable(this, coord));
+		output.emplaceRenderable<DotRenderable>(this, coord);
 	if (outer_color && outer_width > 0)
-		output.insertRenderable(new CircleRenderable(this, coord));
+		output.emplaceRenderable<CircleRenderable>(this, coord);
 	
 	if (!elements.empty())
 	{
@@ -182,12 +182,12 @@ void PointSymbol::createRenderablesIfCenterInside(const MapCoordF& point_coord,
 	{
 		if (inner_color && inner_radius > 0)
 		{
-			output.insertRenderable(new DotRenderable(this, point_coord));
+			output.emplaceRenderable<DotRenderable>(this, point_coord);
 		}
 		
 		if (outer_color && outer_width > 0)
 		{
-			output.insertRenderable(new CircleRenderable(this, point_coord));
+			output.emplaceRenderable<CircleRenderable>(this, point_coord);
 		}
 	}
 	
@@ -245,7 +245,7 @@ void PointSymbol::createPrimitivesIfCompletelyInside(const MapCoordF& point_coor
 		    && outline->contains({point_coord.x()+r, point_coord.y()})
 		    && outline->contains({point_coord.x(), point_coord.y()+r}) )
 		{
-			output.insertRenderable(new DotRenderable(this, point_coord));
+			output.emplaceRenderable<DotRenderable>(this, point_coord);
 		}
 	}
 	
@@ -257,7 +257,7 @@ void PointSymbol::createPrimitivesIfCompletelyInside(const MapCoordF& point_coor
 		    && outline->contains({point_coord.x()+r, point_coord.y()})
 		    && outline->contains({point_coord.x(), point_coord.y()+r}) )
 		{
-			output.insertRenderable(new CircleRenderable(this, point_coord));
+			output.emplaceRenderable<CircleRenderable>(this, point_coord);
 		}
 	}
 }
@@ -332,7 +332,7 @@ void PointSymbol::createPrimitivesIfPartiallyInside(const MapCoordF& point_coord
 		    || outline->contains({point_coord.x()+r, point_coord.y()})
 		    || outline->contains({point_coord.x(), point_coord.y()+r}) )
 		{
-			output.insertRenderable(new DotRenderable(this, point_coord));
+			output.emplaceRenderable<DotRenderable>(this, point_coord);
 		}
 	}
 	
@@ -344,7 +344,7 @@ void PointSymbol::createPrimitivesIfPartiallyInside(const MapCoordF& point_coord
 		    || outline->contains({point_coord.x()+r, point_coord.y()})
 		    || outline->contains({point_coord.x(), point_coord.y()+r}) )
 		{
-			output.insertRenderable(new CircleRenderable(this, point_coord));
+			output.emplaceRenderable<CircleRenderable>(this, point_coord);
 		}
 	}
 }
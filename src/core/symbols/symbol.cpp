@@ -22,6 +22,7 @@
 #include "symbol.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
@@ -38,7 +39,10 @@
 #include <QPoint>
 #include <QPointF>
 #include <QRectF>
+#include <QRunnable>
 #include <QStringRef>
+#include <QThread>
+#include <QThreadPool>
 #include <QVariant>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
@@ -55,6 +59,7 @@
 #include "core/symbols/combined_symbol.h"
 #include "core/symbols/line_symbol.h"
 #include "core/symbols/point_symbol.h"
+#include "core/symbols/symbol_icon_cache.h"
 #include "core/symbols/text_symbol.h"
 #include "fileformats/file_format.h"
 #include "fileformats/file_import_export.h"
@@ -66,6 +71,47 @@
 
 namespace OpenOrienteering {
 
+namespace {
+
+/**
+ * The shared state of a Symbol::createIcons() batch.
+ * 
+ * All workers take the index of the next symbol from a shared counter,
+ * so each icon is rendered exactly once, into its own slot.
+ */
+struct IconBatch
+{
+	const Map& map;
+	const std::vector<const Symbol*>& symbols;
+	std::vector<QImage>& icons;
+	int side_length;
+	bool antialiasing;
+	qreal zoom;
+	std::atomic<std::size_t> next { 0 };
+	
+	void render()
+	{
+		for (auto i = next++; i < symbols.size(); i = next++)
+			icons[i] = symbols[i]->createIcon(map, side_length, antialiasing, zoom);
+	}
+};
+
+
+class IconJob : public QRunnable
+{
+public:
+	explicit IconJob(IconBatch& batch) : batch(batch) {}
+	
+	void run() override { batch.render(); }
+	
+private:
+	IconBatch& batch;
+};
+
+}  // namespace
+
+
+
 Symbol::Symbol(Type type) noexcept
 : number { { -1, -1, -1 } }
 , type { type }
@@ -434,7 +480,7 @@ void Symbol::createBaselineRenderables(
 		line_symbol.setLineWidth(0);
 		for (const auto& part : path_parts)
 		{
-			output.insertRenderable(new LineRenderable(&line_symbol, part, false));
+			output.emplaceRenderable<LineRenderable>(&line_symbol, part, false);
 		}
 	}
 }
@@ -470,12 +516,93 @@ QImage Symbol::getIcon(const Map* map) const
 		    && !custom_icon.isNull())
 			icon = custom_icon.scaled(size, size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
 		else if (map)
-			icon = createIcon(*map, size);
+		{
+			auto& cache = SymbolIconCache::instance();
+			auto const key = SymbolIconCache::key(*map, *this, size, true, map->symbolIconZoom());
+			icon = cache.load(key);
+			if (icon.isNull())
+			{
+				icon = createIcon(*map, size);
+				cache.store(key, icon);
+			}
+		}
 	}
 	return icon;
 }
 
 
+// static
+std::vector<QImage> Symbol::createIcons(const Map& map, const std::vector<const Symbol*>& symbols, int side_length, bool antialiasing, qreal zoom)
+{
+	// The map determines its icon zoom lazily. This must not race.
+	if (zoom <= 0)
+		zoom = map.symbolIconZoom();
+	
+	auto icons = std::vector<QImage>(symbols.size());
+	IconBatch batch { map, symbols, icons, side_length, antialiasing, zoom };
+	
+	auto const num_helpers = std::min(QThread::idealThreadCount(), int(symbols.size())) - 1;
+	if (num_helpers <= 0)
+	{
+		batch.render();
+		return icons;
+	}
+	
+	QThreadPool pool;
+	pool.setMaxThreadCount(num_helpers);
+	for (int i = 0; i < num_helpers; ++i)
+		pool.start(new IconJob(batch));
+	batch.render();  // The calling thread takes its share, too.
+	pool.waitForDone();
+	return icons;
+}
+
+
+// static
+void Symbol::prepareIcons(const Map& map, const std::vector<const Symbol*>& symbols)
+{
+	// Updating the icon zoom may reset all icons, so do it first.
+	auto const zoom = map.symbolIconZoom();
+	
+	auto& settings = Settings::getInstance();
+	auto const show_custom_icons = settings.getSetting(Settings::SymbolWidget_ShowCustomIcons).toBool();
+	auto missing = std::vector<const Symbol*>();
+	missing.reserve(symbols.size());
+	std::copy_if(begin(symbols), end(symbols), std::back_inserter(missing), [show_custom_icons](const Symbol* symbol) {
+		return symbol->icon.isNull() && !(show_custom_icons && !symbol->custom_icon.isNull());
+	});
+	if (missing.empty())
+		return;
+	
+	// Take what is available from the persistent cache.
+	auto& cache = SymbolIconCache::instance();
+	auto const size = settings.getSymbolWidgetIconSizePx();
+	auto keys = std::vector<QByteArray>();
+	keys.reserve(missing.size());
+	auto uncached = begin(missing);
+	for (const auto* symbol : missing)
+	{
+		auto key = SymbolIconCache::key(map, *symbol, size, true, zoom);
+		symbol->icon = cache.load(key);
+		if (symbol->icon.isNull())
+		{
+			*uncached++ = symbol;
+			keys.push_back(std::move(key));
+		}
+	}
+	missing.erase(uncached, end(missing));
+	if (missing.empty())
+		return;
+	
+	auto icons = createIcons(map, missing, size, true, zoom);
+	for (std::size_t i = 0; i < missing.size(); ++i)
+	{
+		missing[i]->icon = std::move(icons[i]);
+		cache.store(keys[i], missing[i]->icon);
+	}
+}
+
+
 QImage Symbol::createIcon(const Map& map, int side_length, bool antialiasing, qreal zoom) const
 {
 	// Desktop default used to be 2x zoom at 8 mm side length, plus/minus
@@ -840,6 +967,12 @@ qreal Symbol::calculateLargestLineExtent() const
 }
 
 
+qreal Symbol::detailSize() const
+{
+	return 0;
+}
+
+
 
 QString Symbol::getPlainTextName() const
 {
@@ -55,6 +55,7 @@ class PathPartVector;
 class PointSymbol;
 class Symbol;
 class SymbolPropertiesWidget;
+class SymbolIconCache;
 class SymbolSettingDialog;
 class TextSymbol;
 class VirtualCoordVector;
@@ -70,6 +71,7 @@ typedef QHash<qint32, Symbol*> SymbolDictionary;
  */
 class Symbol
 {
+friend class SymbolIconCache;
 public:
 	/** 
 	 * Enumeration of all possible symbol types.
@@ -96,6 +98,7 @@ public:
 	{
 		RenderBaselines    = 1 << 0,   ///< Paint cosmetique contours and baselines
 		RenderAreasHatched = 1 << 1,   ///< Paint hatching instead of opaque fill
+		RenderSimplified   = 1 << 2,   ///< Paint solid lines and plain fills instead of small details
 		RenderNormal       = 0         ///< Paint normally
 	};
 	Q_DECLARE_FLAGS(RenderableOptions, RenderableOption)
@@ -363,6 +366,24 @@ public:
 	 */
 	QImage createIcon(const Map& map, int side_length, bool antialiasing = true, qreal zoom = 0) const;
 	
+	/**
+	 * Creates icons for multiple symbols concurrently.
+	 * 
+	 * The icons are rendered on a thread pool and returned in the order of
+	 * the given symbols. The parameters are the same as for createIcon().
+	 * This function must be called from the map's thread, and neither the map
+	 * nor the symbols may be modified until it returns.
+	 */
+	static std::vector<QImage> createIcons(const Map& map, const std::vector<const Symbol*>& symbols, int side_length, bool antialiasing = true, qreal zoom = 0);
+	
+	/**
+	 * Fills the icon cache of the given symbols.
+	 * 
+	 * The icons which getIcon() would have to generate are created in a
+	 * single createIcons() batch, so that subsequent getIcon() calls are cheap.
+	 */
+	static void prepareIcons(const Map& map, const std::vector<const Symbol*>& symbols);
+	
 	/**
 	 * Clear the symbol's cached icon.
 	 * 
@@ -384,6 +405,20 @@ public:
 	 */
 	virtual qreal calculateLargestLineExtent() const;
 	
+	/**
+	 * Returns the size of the smallest detail which is omitted in simplified output.
+	 * 
+	 * The size is given in mm. Simplified output (Symbol::RenderSimplified) may
+	 * be used when this size becomes too small on screen. A value of zero means
+	 * that the symbol has no simplified output.
+	 */
+	virtual qreal detailSize() const;
+	
+	/**
+	 * The largest level of detail threshold, in pixels.
+	 */
+	static constexpr int max_level_of_detail = 50;
+	
 	
 	// Getters / Setters
 	
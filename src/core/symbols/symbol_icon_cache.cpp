@@ -0,0 +1,223 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "symbol_icon_cache.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFontInfo>
+#include <QIODevice>
+#include <QLatin1Char>
+#include <QLatin1String>
+#include <QRgb>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QXmlStreamWriter>
+
+#include "core/map.h"
+#include "core/map_color.h"
+#include "core/symbols/combined_symbol.h"
+#include "core/symbols/symbol.h"
+#include "core/symbols/text_symbol.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/// Must be increased when the icon generation changes.
+const char* const cache_version = "1";
+
+/// The number of stores after which the size limit is checked again.
+constexpr int stores_per_prune = 100;
+
+}  // namespace
+
+
+
+SymbolIconCache::SymbolIconCache(const QString& path, qint64 max_size)
+: path(path)
+, max_size(max_size)
+{
+	// nothing else
+}
+
+SymbolIconCache::~SymbolIconCache() = default;
+
+
+// static
+SymbolIconCache& SymbolIconCache::instance()
+{
+	static SymbolIconCache cache([]() -> QString {
+		auto location = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+		if (location.isEmpty())
+			return {};
+		return location + QLatin1String("/symbol-icons");
+	}());
+	return cache;
+}
+
+
+void SymbolIconCache::setDirectory(const QString& path)
+{
+	this->path = path;
+	stores_until_prune = 0;
+}
+
+
+// static
+QByteArray SymbolIconCache::key(const Map& map, const Symbol& symbol, int side_length, bool antialiasing, qreal zoom)
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(cache_version);
+	addSymbol(hash, map, symbol);
+	
+	QByteArray parameters;
+	{
+		QDataStream stream(&parameters, QIODevice::WriteOnly);
+		stream << side_length << antialiasing << double(zoom) << map.getScaleDenominator();
+		
+		// The symbol definition refers to colors by priority.
+		for (int i = 0; i < map.getNumColors(); ++i)
+		{
+			const auto* color = map.getColor(i);
+			if (symbol.containsColor(color))
+				stream << i << QRgb(*color) << color->getOpacity();
+		}
+	}
+	hash.addData(parameters);
+	
+	return hash.result();
+}
+
+
+// static
+void SymbolIconCache::addSymbol(QCryptographicHash& hash, const Map& map, const Symbol& symbol)
+{
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	{
+		QXmlStreamWriter xml(&buffer);
+		xml.writeStartElement(QLatin1String("symbol"));
+		xml.writeAttribute(QLatin1String("type"), QString::number(symbol.getType()));
+		symbol.saveImpl(xml, map);
+		xml.writeEndElement();
+	}
+	hash.addData(buffer.data());
+	
+	if (const auto* text = symbol.asText())
+	{
+		// The default icon text is translated.
+		hash.addData(text->getIconText().toUtf8());
+		// The font family may be substituted on this system.
+		hash.addData(QFontInfo(text->getQFont()).family().toUtf8());
+	}
+	else if (const auto* combined = symbol.asCombined())
+	{
+		// Shared parts are saved as references only.
+		for (int i = 0; i < combined->getNumParts(); ++i)
+		{
+			if (const auto* part = combined->getPart(i))
+				addSymbol(hash, map, *part);
+		}
+	}
+}
+
+
+QString SymbolIconCache::filePath(const QByteArray& key) const
+{
+	return path + QLatin1Char('/') + QString::fromLatin1(key.toHex()) + QLatin1String(".png");
+}
+
+
+QImage SymbolIconCache::load(const QByteArray& key) const
+{
+	if (!isEnabled())
+		return {};
+	
+	auto const file_path = filePath(key);
+	QImage icon;
+	if (!icon.load(file_path, "PNG"))
+		return {};
+	
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+	// The modification time tracks the last use, for pruning.
+	QFile file(file_path);
+	if (file.open(QIODevice::ReadWrite))
+		file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+#endif
+	
+	// Match the format of Symbol::createIcon().
+	if (icon.format() != QImage::Format_ARGB32_Premultiplied)
+		icon = icon.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+	return icon;
+}
+
+
+void SymbolIconCache::store(const QByteArray& key, const QImage& icon)
+{
+	if (!isEnabled() || icon.isNull())
+		return;
+	
+	if (!QDir().mkpath(path))
+		return;
+	
+	// QSaveFile: Other instances may read the same file concurrently.
+	QSaveFile file(filePath(key));
+	if (!file.open(QIODevice::WriteOnly)
+	    || !icon.save(&file, "PNG")
+	    || !file.commit())
+		return;
+	
+	// Checking the size needs a directory listing, so it is not done for
+	// every file. The first store also prunes what earlier sessions left.
+	if (stores_until_prune <= 0)
+	{
+		prune(max_size);
+		stores_until_prune = stores_per_prune;
+	}
+	--stores_until_prune;
+}
+
+
+void SymbolIconCache::prune(qint64 size)
+{
+	if (!isEnabled())
+		return;
+	
+	auto const files = QDir(path).entryInfoList({ QStringLiteral("*.png") }, QDir::Files, QDir::Time);
+	qint64 total_size = 0;
+	for (const auto& info : files)
+	{
+		// Most recently used first
+		total_size += info.size();
+		if (total_size > size)
+			QFile::remove(info.absoluteFilePath());
+	}
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,141 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_SYMBOL_ICON_CACHE_H
+#define OPENORIENTEERING_SYMBOL_ICON_CACHE_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+class QCryptographicHash;
+
+namespace OpenOrienteering {
+
+class Map;
+class Symbol;
+
+
+/**
+ * A persistent, content-addressed cache for generated symbol icons.
+ * 
+ * Icons are stored as PNG files in a directory. The file name is a hash of
+ * everything which determines the icon: the symbol definition (including
+ * referenced parts), the definitions of the colors used by the symbol, the
+ * map scale, and the icon parameters. So unchanged symbols, e.g. from the
+ * standard symbol sets, get their icons from the cache, even across maps.
+ * 
+ * Entries are never invalidated explicitly: a changed symbol simply gets a
+ * different key. Instead, the total size of the directory is limited. When
+ * it grows beyond the limit, the least recently used files are removed.
+ * 
+ * This class is not thread-safe. It is meant to be used from the GUI thread.
+ */
+class SymbolIconCache
+{
+public:
+	/// The default limit for the total size of the cached files, in bytes.
+	static constexpr qint64 default_max_size = 16 * 1024 * 1024;
+	
+	/**
+	 * Constructs a cache which uses the given directory.
+	 * 
+	 * The directory is created when the first icon is stored.
+	 * An empty path disables the cache.
+	 */
+	explicit SymbolIconCache(const QString& path, qint64 max_size = default_max_size);
+	
+	SymbolIconCache(const SymbolIconCache&) = delete;
+	SymbolIconCache& operator=(const SymbolIconCache&) = delete;
+	
+	~SymbolIconCache();
+	
+	/**
+	 * Returns the application's cache, located in the user's cache directory.
+	 */
+	static SymbolIconCache& instance();
+	
+	/**
+	 * Returns true if this cache has a location to load from and store to.
+	 */
+	bool isEnabled() const { return !path.isEmpty(); }
+	
+	/**
+	 * Returns the directory of the cache.
+	 */
+	const QString& directory() const { return path; }
+	
+	/**
+	 * Changes the directory of the cache.
+	 * 
+	 * An empty path disables the cache. Tests use this to keep the
+	 * application's cache out of the user's cache directory.
+	 */
+	void setDirectory(const QString& path);
+	
+	/**
+	 * Returns the limit for the total size of the cached files, in bytes.
+	 */
+	qint64 maxSize() const { return max_size; }
+	
+	/**
+	 * Computes the key for the icon of the given symbol.
+	 * 
+	 * The parameters are the same as for Symbol::createIcon(), but the zoom
+	 * must already be resolved.
+	 */
+	static QByteArray key(const Map& map, const Symbol& symbol, int side_length, bool antialiasing, qreal zoom);
+	
+	/**
+	 * Loads the icon for the given key.
+	 * 
+	 * Returns a null image if the icon is not in the cache. Otherwise, marks
+	 * the file as recently used.
+	 */
+	QImage load(const QByteArray& key) const;
+	
+	/**
+	 * Stores the icon for the given key.
+	 * 
+	 * Errors are not fatal: the icon will just be generated again next time.
+	 */
+	void store(const QByteArray& key, const QImage& icon);
+	
+	/**
+	 * Removes the least recently used files until the total size of the
+	 * cached files is not greater than the given size.
+	 */
+	void prune(qint64 size);
+	
+private:
+	QString filePath(const QByteArray& key) const;
+	
+	static void addSymbol(QCryptographicHash& hash, const Map& map, const Symbol& symbol);
+	
+	QString path;
+	qint64 max_size;
+	int stores_until_prune = 0;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -21,19 +21,32 @@
 
 #include "text_symbol.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <limits>
 #include <memory>
+#include <vector>
 // IWYU pragma: no_include <ext/alloc_traits.h>
 
 #include <QtGlobal>
 #include <QCoreApplication>
 #include <QFont>
+#include <QGlyphRun>
+#include <QHash>
 #include <QLatin1String>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPointF>
+#include <QRawFont>
 #include <QRectF>
 #include <QStringRef>
+#include <QTextLayout>
+#include <QTextLine>
+#include <QTextOption>
 #include <QTransform>
+#include <QVector>
 #include <QXmlStreamAttributes>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
@@ -150,7 +163,7 @@ void TextSymbol::createRenderables(
 		double anchor_y = anchor.y();
 		
 		if (color)
-			output.insertRenderable(new TextRenderable(this, text_object, color, anchor_x, anchor_y));
+			output.emplaceRenderable<TextRenderable>(this, text_object, color, anchor_x, anchor_y);
 		
 		if (line_below && line_below_color && line_below_width > 0)
 			createLineBelowRenderables(object, output);
@@ -159,11 +172,11 @@ void TextSymbol::createRenderables(
 		{
 			if (framing_mode == LineFraming && framing_line_half_width > 0)
 			{
-				output.insertRenderable(new TextFramingRenderable(this, text_object, framing_color, anchor_x, anchor_y));
+				output.emplaceRenderable<TextFramingRenderable>(this, text_object, framing_color, anchor_x, anchor_y);
 			}
 			else if (framing_mode == ShadowFraming)
 			{
-				output.insertRenderable(new TextRenderable(this, text_object, framing_color, anchor_x + 0.001 * framing_shadow_x_offset, anchor_y + 0.001 * framing_shadow_y_offset));
+				output.emplaceRenderable<TextRenderable>(this, text_object, framing_color, anchor_x + 0.001 * framing_shadow_x_offset, anchor_y + 0.001 * framing_shadow_y_offset);
 			}
 		}
 	}
@@ -200,8 +213,7 @@ void TextSymbol::createBaselineRenderables(
 		path.parts().front().setClosed(true, true);
 		path.updatePathCoords();
 		
-		auto line_renderable = new LineRenderable(&line_symbol, path.parts().front(), false);
-		output.insertRenderable(line_renderable);
+		output.emplaceRenderable<LineRenderable>(&line_symbol, path.parts().front(), false);
 	}
 }
 
@@ -248,7 +260,7 @@ void TextSymbol::createLineBelowRenderables(const Object* object, ObjectRenderab
 			line_coords[3] = MapCoordF(transform.map(QPointF(line_below_x0, line_below_y1)));
 			
 			line_path.path_coords.update(0);
-			output.insertRenderable(new AreaRenderable(&area_symbol, line_path));
+			output.emplaceRenderable<AreaRenderable>(&area_symbol, line_path);
 		}
 	}
 }
@@ -330,6 +342,104 @@ void TextSymbol::updateQFont()
 
 	metrics = QFontMetricsF(qfont);
 	tab_interval = 8.0 * metrics.averageCharWidth();
+	
+	QMutexLocker lock(&glyph_outlines_mutex);
+	glyph_outlines.clear();
+}
+
+
+void TextSymbol::addTextOutline(QPainterPath& path, qreal x, qreal y, const QString& text) const
+{
+	if (text.isEmpty())
+		return;
+	
+	// The cached outlines do not cover these decorations.
+	if (qfont.strikeOut() || qfont.overline())
+	{
+		path.addText(x, y, qfont, text);
+		return;
+	}
+	
+	// Shaping is left to QTextLayout: it handles kerning, letter spacing,
+	// complex scripts and font fallback.
+	QTextLayout layout(text, qfont);
+	QTextOption option;
+	option.setWrapMode(QTextOption::NoWrap);
+	layout.setTextOption(option);
+	layout.beginLayout();
+	auto line = layout.createLine();
+	if (line.isValid())
+		line.setLineWidth(std::numeric_limits<qreal>::max());
+	layout.endLayout();
+	if (!line.isValid())
+		return;
+	
+	auto const baseline_y = y - line.ascent();
+	const auto glyph_runs = layout.glyphRuns();
+	for (const auto& glyph_run : glyph_runs)
+		addGlyphRunOutline(path, glyph_run, { x, baseline_y });
+	
+	if (qfont.underline())
+	{
+		path.addRect(x, y + metrics.underlinePos(), line.naturalTextWidth(), metrics.lineWidth());
+	}
+}
+
+
+void TextSymbol::addGlyphRunOutline(QPainterPath& path, const QGlyphRun& glyph_run, const QPointF& origin) const
+{
+	const auto raw_font = glyph_run.rawFont();
+	const auto glyph_indexes = glyph_run.glyphIndexes();
+	const auto positions = glyph_run.positions();
+	
+	auto outlines = std::vector<QPainterPath>(std::size_t(glyph_indexes.size()));
+	auto missing = std::vector<std::size_t>{};
+	
+	// Text renderables may be created on multiple threads, e.g. for icons.
+	QMutexLocker lock(&glyph_outlines_mutex);
+	{
+		const auto& cached = glyphOutlines(raw_font);
+		for (std::size_t i = 0; i < outlines.size(); ++i)
+		{
+			auto outline = cached.constFind(glyph_indexes[int(i)]);
+			if (outline != cached.constEnd())
+				outlines[i] = *outline;
+			else
+				missing.push_back(i);
+		}
+	}
+	
+	if (!missing.empty())
+	{
+		lock.unlock();
+		for (auto i : missing)
+			outlines[i] = raw_font.pathForGlyph(glyph_indexes[int(i)]);
+		lock.relock();
+		auto& cached = glyphOutlines(raw_font);
+		for (auto i : missing)
+			cached.insert(glyph_indexes[int(i)], outlines[i]);
+	}
+	lock.unlock();
+	
+	for (std::size_t i = 0; i < outlines.size(); ++i)
+	{
+		if (!outlines[i].isEmpty())
+			path.addPath(outlines[i].translated(origin + positions[int(i)]));
+	}
+}
+
+
+QHash<quint32, QPainterPath>& TextSymbol::glyphOutlines(const QRawFont& raw_font) const
+{
+	auto entry = std::find_if(begin(glyph_outlines), end(glyph_outlines), [&raw_font](const auto& entry) {
+		return entry.raw_font == raw_font;
+	});
+	if (entry == end(glyph_outlines))
+	{
+		glyph_outlines.push_back({ raw_font, {} });
+		entry = end(glyph_outlines) - 1;
+	}
+	return entry->outlines;
 }
 
 
@@ -29,8 +29,14 @@
 #include <Qt>
 #include <QFont>
 #include <QFontMetricsF>
+#include <QHash>
+#include <QMutex>
+#include <QPainterPath>
+#include <QRawFont>
 #include <QString>
 
+class QGlyphRun;
+class QPointF;
 class QXmlStreamReader;
 class QXmlStreamWriter;
 // IWYU pragma: no_forward_declare QFontMetricsF
@@ -112,6 +118,15 @@ public:
 	/** Updates the internal QFont from the font settings. */
 	void updateQFont();
 	
+	/**
+	 * Adds the outline of the given text to the path, like QPainterPath::addText().
+	 * 
+	 * The text is laid out with the internal QFont, with the left end of the
+	 * baseline at (x, y). Glyph outlines are cached per symbol, so that
+	 * repeated glyphs are outlined only once.
+	 */
+	void addTextOutline(QPainterPath& path, qreal x, qreal y, const QString& text) const;
+	
 	/** Calculates the factor to convert from the real font size to the internal font size */
 	inline double calculateInternalScaling() const {return internal_point_size / (0.001 * font_size);}
 	
@@ -154,11 +169,41 @@ protected:
 	bool loadImpl(QXmlStreamReader& xml, const Map& map, SymbolDictionary& symbol_dict, int version) override;
 	bool equalsImpl(const Symbol* other, Qt::CaseSensitivity case_sensitivity) const override;
 	
+	/**
+	 * Adds the cached outlines of a glyph run to the path.
+	 * 
+	 * The origin is the left end of the run's baseline. The cache is looked
+	 * up once per run, and missing glyphs are outlined without holding the
+	 * lock. This function is thread-safe.
+	 */
+	void addGlyphRunOutline(QPainterPath& path, const QGlyphRun& glyph_run, const QPointF& origin) const;
+	
+	/**
+	 * Cached glyph outlines of a single raw font, by glyph index.
+	 * 
+	 * Fallback fonts may contribute glyphs, possibly at a different size,
+	 * so there is one entry per raw font.
+	 */
+	struct GlyphOutlines
+	{
+		QRawFont raw_font;
+		QHash<quint32, QPainterPath> outlines;
+	};
+	
+	/**
+	 * Returns the cached glyph outlines of the given raw font.
+	 * 
+	 * The glyph_outlines_mutex must be locked.
+	 */
+	QHash<quint32, QPainterPath>& glyphOutlines(const QRawFont& raw_font) const;
+	
 	
 	// Members ordered for minimizing padding
 	
 	QFont qfont;
 	QFontMetricsF metrics;
+	mutable std::vector<GlyphOutlines> glyph_outlines;  // a few entries only: the font and its fallbacks
+	mutable QMutex glyph_outlines_mutex;
 	QString font_family;
 	QString icon_text;			// text to be drawn in the symbol's icon
 	
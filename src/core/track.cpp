@@ -21,7 +21,9 @@
 
 #include "track.h"
 
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 #include <Qt>
 #include <QtGlobal>
@@ -318,8 +320,6 @@ bool Track::loadGpxFrom(QIODevice& device, bool project_points)
 			{
 				point = TrackPoint{LatLon{stream.attributes().value(QLatin1String("lat")).toDouble(),
 				                          stream.attributes().value(QLatin1String("lon")).toDouble()}};
-				if (project_points)
-					point.map_coord = map_georef.toMapCoordF(point.latlon); // TODO: check for errors
 				point_name.clear();
 			}
 			else if (stream.name().compare(QLatin1String("trkseg"), Qt::CaseInsensitive) == 0
@@ -361,16 +361,28 @@ bool Track::loadGpxFrom(QIODevice& device, bool project_points)
 		segment_starts.pop_back();
 	}
 	
+	if (project_points)
+		projectPoints();
+	
 	return !stream.hasError();
 }
 
 void Track::projectPoints()
 {
 	/// \todo Check for errors from Georeferencing::toMapCoordF()
-	for (auto& waypoint : waypoints)
-		waypoint.map_coord = map_georef.toMapCoordF(waypoint.latlon, nullptr); 
-	for (auto& segment_point : segment_points)
-		segment_point.map_coord = map_georef.toMapCoordF(segment_point.latlon, nullptr); 
+	auto const project = [this](std::vector<TrackPoint>& points) {
+		// A single batch is much faster than projecting point by point.
+		std::vector<LatLon> lat_lon;
+		lat_lon.reserve(points.size());
+		for (const auto& point : points)
+			lat_lon.push_back(point.latlon);
+		
+		auto const map_coords = map_georef.toMapCoordF(lat_lon, nullptr);
+		for (std::size_t i = 0; i < points.size(); ++i)
+			points[i].map_coord = map_coords[i];
+	};
+	project(waypoints);
+	project(segment_points);
 }
 
 
@@ -0,0 +1,542 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "batch_converter.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include <Qt>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QHash>
+#include <QLatin1Char>
+#include <QLatin1String>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTextStream>
+#include <QThread>
+
+#ifdef QT_PRINTSUPPORT_LIB
+#include <QColor>
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QPrinter>
+#include <QSizeF>
+#endif
+
+#include "core/map.h"
+#include "core/map_printer.h"
+#include "core/map_view.h"
+#include "fileformats/file_format.h"
+#include "fileformats/file_format_registry.h"
+#include "fileformats/file_import_export.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/// The command line argument which selects the batch converter.
+const char* const convert_argument = "--convert";
+
+/// Extensions of targets which are handled by MapPrinter.
+const char* const print_extensions[] = { "pdf", "png", "bmp", "tif", "tiff", "jpg", "jpeg" };
+
+
+/**
+ * Returns a representation of the path which is equal for the same file.
+ */
+QString comparablePath(const QString& path)
+{
+	auto const absolute_path = QFileInfo(path).absoluteFilePath();
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+	// The default file systems are case-insensitive.
+	return absolute_path.toLower();
+#else
+	return absolute_path;
+#endif
+}
+
+}  // namespace
+
+
+
+// static
+bool BatchConverter::isRequested(int argc, char** argv)
+{
+	return argc > 1 && qstrcmp(argv[1], convert_argument) == 0;
+}
+
+
+// static
+void BatchConverter::prepareEnvironment()
+{
+	if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+}
+
+
+// static
+int BatchConverter::exec(const QStringList& arguments)
+{
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+	
+	QCommandLineParser parser;
+	parser.setApplicationDescription(tr("Converts map files without user interaction."));
+	auto const help_option = parser.addHelpOption();
+	QCommandLineOption convert_option(QString::fromLatin1(convert_argument).mid(2),
+	                                  tr("Run the batch converter."));
+	QCommandLineOption target_option({ QStringLiteral("t"), QStringLiteral("to") },
+	                                 tr("The target format ID or file extension, e.g. omap, OCD12, pdf, png."),
+	                                 tr("target"));
+	QCommandLineOption output_option({ QStringLiteral("o"), QStringLiteral("output-dir") },
+	                                 tr("The directory for the output files. Defaults to the directory of each input file."),
+	                                 tr("directory"));
+	QCommandLineOption jobs_option({ QStringLiteral("j"), QStringLiteral("jobs") },
+	                               tr("The number of parallel conversions."),
+	                               tr("number"), QString::number(QThread::idealThreadCount()));
+	QCommandLineOption resolution_option(QStringLiteral("resolution"),
+	                                     tr("The resolution for printing, in dpi."),
+	                                     tr("dpi"));
+	QCommandLineOption worker_option(QStringLiteral("worker"),
+	                                 tr("Report messages only."));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+	worker_option.setFlags(QCommandLineOption::HiddenFromHelp);
+#endif
+	parser.addOption(convert_option);
+	parser.addOption(target_option);
+	parser.addOption(output_option);
+	parser.addOption(jobs_option);
+	parser.addOption(resolution_option);
+	parser.addOption(worker_option);
+	parser.addPositionalArgument(QStringLiteral("files"), tr("The files to be converted."), tr("FILE..."));
+	
+	if (!parser.parse(arguments))
+	{
+		err << parser.errorText() << endl;
+		return 2;
+	}
+	if (parser.isSet(help_option))
+	{
+		out << parser.helpText();
+		return 0;
+	}
+	
+	auto options = Options{};
+	options.target = parser.value(target_option);
+	options.output_dir = parser.value(output_option);
+	options.jobs = std::max(1, parser.value(jobs_option).toInt());
+	options.resolution = parser.value(resolution_option).toInt();
+	options.worker = parser.isSet(worker_option);
+	
+	auto const inputs = parser.positionalArguments();
+	if (options.target.isEmpty() || inputs.isEmpty())
+	{
+		err << parser.helpText();
+		return 2;
+	}
+	
+	BatchConverter converter(std::move(options));
+	if (!converter.isPrintTarget() && !converter.exportFormat())
+	{
+		err << tr("Unsupported target: %1").arg(converter.options().target) << endl;
+		return 2;
+	}
+	
+	QElapsedTimer timer;
+	timer.start();
+	auto const results = converter.convertAll(inputs, out);
+	auto const succeeded = std::count_if(begin(results), end(results), [](const auto& result) {
+		return result.success;
+	});
+	if (!converter.options().worker)
+	{
+		out << tr("Converted %1 of %2 file(s) in %3 ms.")
+		       .arg(succeeded).arg(results.size()).arg(timer.elapsed()) << endl;
+	}
+	return std::size_t(succeeded) == results.size() ? 0 : 1;
+}
+
+
+
+BatchConverter::BatchConverter(Options options)
+: opts(std::move(options))
+{
+	// nothing else
+}
+
+BatchConverter::~BatchConverter() = default;
+
+
+bool BatchConverter::isPrintTarget() const
+{
+#ifdef QT_PRINTSUPPORT_LIB
+	return std::any_of(std::begin(print_extensions), std::end(print_extensions), [this](auto extension) {
+		return opts.target.compare(QLatin1String(extension), Qt::CaseInsensitive) == 0;
+	});
+#else
+	return false;
+#endif
+}
+
+
+const FileFormat* BatchConverter::exportFormat() const
+{
+	auto const id = opts.target.toLatin1();
+	if (auto const* format = FileFormats.findFormat(id.constData()))
+	{
+		if (format->supportsWriting())
+			return format;
+	}
+	
+	return FileFormats.findFormat([this](auto format) {
+		return format->supportsWriting()
+		       && format->fileExtensions().contains(opts.target, Qt::CaseInsensitive);
+	});
+}
+
+
+QString BatchConverter::outputPath(const QString& input) const
+{
+	auto extension = opts.target;
+	if (!isPrintTarget())
+	{
+		// The target may be a format ID.
+		auto const* format = exportFormat();
+		if (format && !format->fileExtensions().contains(extension, Qt::CaseInsensitive))
+			extension = format->primaryExtension();
+	}
+	
+	auto const file_info = QFileInfo(input);
+	auto const directory = opts.output_dir.isEmpty() ? file_info.absolutePath() : QDir(opts.output_dir).absolutePath();
+	return directory + QLatin1Char('/') + file_info.completeBaseName() + QLatin1Char('.') + extension;
+}
+
+
+BatchConverter::Result BatchConverter::convert(const QString& input) const
+{
+	auto result = Result{};
+	result.input = input;
+	result.output = outputPath(input);
+	
+	QElapsedTimer timer;
+	timer.start();
+	result.success = convert(result);
+	result.elapsed = timer.elapsed();
+	return result;
+}
+
+
+bool BatchConverter::convert(Result& result) const
+{
+	if (QFileInfo(result.output).absoluteFilePath() == QFileInfo(result.input).absoluteFilePath())
+	{
+		result.messages << tr("The output file must be different from the input file.");
+		return false;
+	}
+	
+	// Printing needs renderables, but only for the printed area.
+	auto const printing = isPrintTarget();
+	Map map;
+	map.setDataOnly(!printing);
+	map.setObjectUpdatesDeferred(true);
+	MapView view { &map };
+	
+	auto importer = FileFormats.makeImporter(result.input, map, &view);
+	if (!importer)
+	{
+		result.messages << tr("Cannot open file:\n%1\n\n%2").arg(result.input, tr("Invalid file type."));
+		return false;
+	}
+	auto const imported = importer->doImport();
+	for (const auto& warning : importer->warnings())
+		result.messages << warning;
+	if (!imported)
+		return false;
+	map.setObjectUpdatesDeferred(false);
+	
+	if (printing)
+		return print(map, view, result);
+	
+	auto const* format = exportFormat();
+	auto exporter = format ? format->makeExporter(result.output, &map, &view) : nullptr;
+	if (!exporter)
+	{
+		result.messages << tr("Unsupported target: %1").arg(opts.target);
+		return false;
+	}
+	// E.g. OCD index entries need the object extents.
+	if (exporter->objectUpdatesNeeded())
+		map.updateObjects();
+	auto const exported = exporter->doExport();
+	for (const auto& warning : exporter->warnings())
+		result.messages << warning;
+	return exported;
+}
+
+
+#ifdef QT_PRINTSUPPORT_LIB
+
+bool BatchConverter::print(Map& map, const MapView& view, Result& result) const
+{
+	MapPrinter map_printer(map, &view);
+	if (opts.target.compare(QLatin1String("pdf"), Qt::CaseInsensitive) == 0)
+	{
+		map_printer.setTarget(MapPrinter::pdfTarget());
+		map_printer.setResolution(opts.resolution);
+		auto printer = map_printer.makePrinter();
+		if (!printer)
+		{
+			result.messages << tr("Failed to prepare the PDF export.");
+			return false;
+		}
+		printer->setOutputFormat(QPrinter::PdfFormat);
+		printer->setCreator(QCoreApplication::applicationName());
+		printer->setDocName(QFileInfo(result.input).completeBaseName());
+		printer->setOutputFileName(result.output);
+		if (!map_printer.printMap(printer.get()))
+		{
+			QFile(result.output).remove();
+			result.messages << tr("Failed to finish the PDF export.");
+			return false;
+		}
+		return true;
+	}
+	
+	map_printer.setTarget(MapPrinter::imageTarget());
+	map_printer.setResolution(opts.resolution);
+	auto const pixel_per_mm = map_printer.getOptions().resolution / 25.4;
+	auto const print_size = map_printer.getPrintAreaPaperSize() * pixel_per_mm;
+	QImage image(qRound(print_size.width()), qRound(print_size.height()), QImage::Format_ARGB32_Premultiplied);
+	if (image.isNull())
+	{
+		result.messages << tr("Failed to prepare the image. Not enough memory.");
+		return false;
+	}
+	
+	auto const dots_per_meter = qRound(pixel_per_mm * 1000);
+	image.setDotsPerMeterX(dots_per_meter);
+	image.setDotsPerMeterY(dots_per_meter);
+	image.fill(QColor(Qt::white));
+	
+	QPainter p(&image);
+	map_printer.drawPage(&p, map_printer.getPrintArea(), &image);
+	p.end();
+	if (!image.save(result.output))
+	{
+		result.messages << tr("Failed to save the image. Does the path exist? Do you have sufficient rights?");
+		return false;
+	}
+	return true;
+}
+
+#else
+
+bool BatchConverter::print(Map& /*map*/, const MapView& /*view*/, Result& result) const
+{
+	result.messages << tr("Unsupported target: %1").arg(opts.target);
+	return false;
+}
+
+#endif
+
+
+QStringList BatchConverter::outputCollisions(const QStringList& inputs) const
+{
+	QStringList messages;
+	
+	auto input_paths = QHash<QString, int>{};
+	for (int i = 0; i < inputs.size(); ++i)
+		input_paths.insert(comparablePath(inputs[i]), i);
+	
+	auto output_paths = QHash<QString, int>{};
+	for (int i = 0; i < inputs.size(); ++i)
+	{
+		auto const output = outputPath(inputs[i]);
+		auto const path = comparablePath(output);
+		auto const other_output = output_paths.constFind(path);
+		if (other_output != output_paths.constEnd())
+		{
+			messages << tr("%1 and %2 would both be written to %3.")
+			            .arg(QDir::toNativeSeparators(inputs[*other_output]),
+			                 QDir::toNativeSeparators(inputs[i]),
+			                 QDir::toNativeSeparators(output));
+			continue;
+		}
+		output_paths.insert(path, i);
+		
+		// The input file itself is rejected by convert().
+		auto const input = input_paths.constFind(path);
+		if (input != input_paths.constEnd() && *input != i)
+		{
+			messages << tr("%1 would be overwritten by the conversion of %2.")
+			            .arg(QDir::toNativeSeparators(inputs[*input]),
+			                 QDir::toNativeSeparators(inputs[i]));
+		}
+	}
+	
+	return messages;
+}
+
+
+std::vector<BatchConverter::Result> BatchConverter::convertAll(const QStringList& inputs, QTextStream& report) const
+{
+	// Conversions must not overwrite each other's output, or read a file
+	// while another conversion writes it. Nothing is converted then.
+	auto const collisions = outputCollisions(inputs);
+	if (!collisions.isEmpty())
+	{
+		auto results = std::vector<Result>(std::size_t(inputs.size()));
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			results[i].input = inputs[int(i)];
+			results[i].output = outputPath(results[i].input);
+		}
+		results.front().messages = collisions;
+		for (const auto& result : results)
+			writeResult(result, report);
+		return results;
+	}
+	
+	if (opts.jobs > 1 && inputs.size() > 1)
+		return convertInWorkers(inputs, report);
+	
+	std::vector<Result> results;
+	results.reserve(std::size_t(inputs.size()));
+	for (const auto& input : inputs)
+	{
+		results.push_back(convert(input));
+		writeResult(results.back(), report);
+	}
+	return results;
+}
+
+
+std::vector<BatchConverter::Result> BatchConverter::convertInWorkers(const QStringList& inputs, QTextStream& report) const
+{
+	auto results = std::vector<Result>(std::size_t(inputs.size()));
+	auto next = 0;
+	auto running = 0;
+	QEventLoop loop;
+	
+	// The workers would overwrite this process' profiler trace file.
+	auto environment = QProcessEnvironment::systemEnvironment();
+	environment.remove(QStringLiteral("MAPPER_PROFILE_TRACE"));
+	
+	std::function<void ()> start_workers = [&]() {
+		while (running < opts.jobs && next < inputs.size())
+		{
+			auto const index = std::size_t(next);
+			auto& result = results[index];
+			result.input = inputs[next];
+			result.output = outputPath(result.input);
+			++next;
+			
+			auto* process = new QProcess(&loop);
+			process->setProcessChannelMode(QProcess::MergedChannels);
+			process->setProcessEnvironment(environment);
+			auto timer = std::make_shared<QElapsedTimer>();
+			timer->start();
+			QObject::connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), &loop,
+			                 [&, process, timer, index](int exit_code, QProcess::ExitStatus exit_status) {
+				auto& result = results[index];
+				result.elapsed = timer->elapsed();
+				result.success = exit_status == QProcess::NormalExit && exit_code == 0;
+				auto const output = QString::fromLocal8Bit(process->readAll()).trimmed();
+				if (!output.isEmpty())
+					result.messages = output.split(QLatin1Char('\n'));
+				if (exit_status != QProcess::NormalExit)
+					result.messages << tr("The worker process crashed.");
+				writeResult(result, report);
+				process->deleteLater();
+				
+				--running;
+				start_workers();
+				if (running == 0)
+					loop.quit();
+			});
+			
+			process->start(QCoreApplication::applicationFilePath(), workerArguments(result.input));
+			if (!process->waitForStarted())
+			{
+				result.messages << process->errorString();
+				writeResult(result, report);
+				delete process;
+				continue;
+			}
+			++running;
+		}
+	};
+	
+	start_workers();
+	if (running > 0)
+		loop.exec();
+	return results;
+}
+
+
+QStringList BatchConverter::workerArguments(const QString& input) const
+{
+	auto arguments = QStringList{
+	    QString::fromLatin1(convert_argument),
+	    QStringLiteral("--worker"),
+	    QStringLiteral("--jobs"), QStringLiteral("1"),
+	    QStringLiteral("--to"), opts.target,
+	};
+	if (!opts.output_dir.isEmpty())
+		arguments << QStringLiteral("--output-dir") << opts.output_dir;
+	if (opts.resolution > 0)
+		arguments << QStringLiteral("--resolution") << QString::number(opts.resolution);
+	arguments << input;
+	return arguments;
+}
+
+
+void BatchConverter::writeResult(const Result& result, QTextStream& report) const
+{
+	if (!opts.worker)
+	{
+		report << (result.success ? QLatin1String("OK    ") : QLatin1String("FAILED"))
+		       << QLatin1Char('\t') << result.elapsed << QLatin1String(" ms\t")
+		       << QDir::toNativeSeparators(result.input);
+		if (result.success)
+			report << QLatin1String(" -> ") << QDir::toNativeSeparators(result.output);
+		report << QLatin1Char('\n');
+	}
+	for (const auto& message : result.messages)
+	{
+		if (!opts.worker)
+			report << QLatin1Char('\t');
+		report << message << QLatin1Char('\n');
+	}
+	report.flush();
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,179 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_BATCH_CONVERTER_H
+#define OPENORIENTEERING_BATCH_CONVERTER_H
+
+#include <vector>
+
+#include <QtGlobal>
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+
+class QTextStream;
+
+namespace OpenOrienteering {
+
+class FileFormat;
+class Map;
+class MapView;
+
+
+/**
+ * Converts map files without user interaction.
+ * 
+ * This is the implementation of the command line mode
+ * 
+ *     Mapper --convert [OPTIONS] FILE...
+ * 
+ * Each input file is loaded by the importer which matches its content, and
+ * written to a file with the same base name and the target's extension.
+ * The target may be the ID or a file extension of a file format which
+ * supports export. The targets "pdf" and raster image extensions are printed
+ * by MapPrinter, using the print configuration saved in the map.
+ * 
+ * Multiple files are converted in parallel worker processes which run the
+ * same executable for a single file each. Thus conversions do not share any
+ * global state, such as the settings, and a failing conversion cannot affect
+ * the other ones.
+ */
+class BatchConverter
+{
+	Q_DECLARE_TR_FUNCTIONS(OpenOrienteering::BatchConverter)
+
+public:
+	/**
+	 * Conversion options.
+	 */
+	struct Options
+	{
+		QString target;      ///< A file format ID or a file extension.
+		QString output_dir;  ///< The output directory. Empty for the input's directory.
+		int jobs = 1;        ///< The maximum number of parallel conversions.
+		int resolution = 0;  ///< The printing resolution in dpi. Zero for the map's configuration.
+		bool worker = false; ///< Whether to report messages only. Used by worker processes.
+	};
+	
+	/**
+	 * The outcome of converting a single file.
+	 */
+	struct Result
+	{
+		QString input;
+		QString output;
+		QStringList messages;
+		qint64 elapsed = 0;  ///< The duration of the conversion in milliseconds.
+		bool success = false;
+	};
+	
+	
+	/**
+	 * Returns true if the program arguments request the command line mode.
+	 */
+	static bool isRequested(int argc, char** argv);
+	
+	/**
+	 * Prepares the process environment for a headless application.
+	 * 
+	 * This must be called before the application object is constructed.
+	 * Unless configured otherwise, it selects Qt's offscreen platform.
+	 */
+	static void prepareEnvironment();
+	
+	/**
+	 * Runs the command line mode with the given arguments.
+	 * 
+	 * The application object and the file formats must be initialized.
+	 * Returns the exit code for the process.
+	 */
+	static int exec(const QStringList& arguments);
+	
+	
+	explicit BatchConverter(Options options);
+	
+	BatchConverter(const BatchConverter&) = delete;
+	BatchConverter& operator=(const BatchConverter&) = delete;
+	
+	~BatchConverter();
+	
+	/**
+	 * Returns the conversion options.
+	 */
+	const Options& options() const { return opts; }
+	
+	/**
+	 * Returns true if the target is handled by MapPrinter.
+	 */
+	bool isPrintTarget() const;
+	
+	/**
+	 * Returns the export file format for the target, or nullptr.
+	 */
+	const FileFormat* exportFormat() const;
+	
+	/**
+	 * Returns the output path for the given input file.
+	 */
+	QString outputPath(const QString& input) const;
+	
+	/**
+	 * Returns messages about files which would be written by more than one
+	 * conversion, or which are converted and overwritten by another
+	 * conversion.
+	 * 
+	 * Returns an empty list if the given files can be converted together.
+	 */
+	QStringList outputCollisions(const QStringList& inputs) const;
+	
+	/**
+	 * Converts a single file in this process.
+	 */
+	Result convert(const QString& input) const;
+	
+	/**
+	 * Converts all given files, reporting each result to the stream.
+	 * 
+	 * If more than one job is allowed, the files are converted in worker
+	 * processes. Otherwise they are converted in this process, one by one.
+	 * 
+	 * If there are output collisions, no file is converted, and all results
+	 * are failures.
+	 */
+	std::vector<Result> convertAll(const QStringList& inputs, QTextStream& report) const;
+
+private:
+	bool convert(Result& result) const;
+	
+	bool print(Map& map, const MapView& view, Result& result) const;
+	
+	std::vector<Result> convertInWorkers(const QStringList& inputs, QTextStream& report) const;
+	
+	QStringList workerArguments(const QString& input) const;
+	
+	void writeResult(const Result& result, QTextStream& report) const;
+	
+	Options opts;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -282,6 +282,8 @@ Exporter::~Exporter() = default;
 
 bool Exporter::doExport()
 {
+	Q_ASSERT(!objectUpdatesNeeded() || !map->hasDeferredObjectUpdates());
+	
 	std::unique_ptr<QSaveFile> managed_file;
 	QScopedValueRollback<QIODevice*> original_device{device_};
 	if (supportsQIODevice())
@@ -329,4 +331,10 @@ bool Exporter::doExport()
 }
 
 
+bool Exporter::objectUpdatesNeeded() const noexcept
+{
+	return true;
+}
+
+
 }  // namespace OpenOrienteering
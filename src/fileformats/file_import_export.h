@@ -299,9 +299,23 @@ public:
 	 * set yet, this function will open a QSaveFile with the given path, make it
 	 * available via device(), and commit the changes if exportImplementation()
 	 * returns successfully.
+	 * 
+	 * Unless objectUpdatesNeeded() returns false, the map's objects must be
+	 * up to date, cf. Map::updateObjects(). Debug builds assert that no
+	 * deferred object update is pending then.
 	 */
 	bool doExport();
 	
+	/**
+	 * Returns true if the export relies on up-to-date object renderables
+	 * and extents.
+	 * 
+	 * The default implementation returns true. Exporters which write only the
+	 * object data may return false, avoiding the generation of renderables
+	 * for maps with deferred object updates.
+	 */
+	virtual bool objectUpdatesNeeded() const noexcept;
+	
 	
 protected:
 	/**
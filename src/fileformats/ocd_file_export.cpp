@@ -25,6 +25,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <stdexcept>
@@ -635,6 +636,9 @@ bool OcdFileExport::exportImplementation()
 	setupFileHeaderGeneric(ocd_version, *file.header());
 	exportSetup(file);   // includes colors
 	exportSymbols(file);
+	
+	// Avoid repeated reallocation and copying of the growing buffer
+	file.byteArray().reserve(file.byteArray().size() + estimateObjectsSize<Format>());
 	exportObjects(file);
 	exportTemplates(file);
 	exportExtras(file);
@@ -987,6 +991,22 @@ void OcdFileExport::exportSymbols(OcdFile<Format>& file)
 		symbol_numbers[symbol] = makeUniqueSymbolNumber(number);
 	}
 	
+	// Render the generated icons in a single concurrent batch
+	symbol_icons.clear();
+	{
+		auto symbols = std::vector<const Symbol*>();
+		symbols.reserve(std::size_t(num_symbols));
+		for (int i = 0; i < num_symbols; ++i)
+		{
+			const auto* symbol = map->getSymbol(i);
+			if (symbol->getCustomIcon().isNull())
+				symbols.push_back(symbol);
+		}
+		auto icons = OcdIcon::createIcons(*map, symbols);
+		for (std::size_t i = 0; i < symbols.size(); ++i)
+			symbol_icons[symbols[i]] = std::move(icons[i]);
+	}
+	
 	// Third pass: Actual export
 	for (int i = 0; i < num_symbols; ++i)
 	{
@@ -1121,22 +1141,29 @@ void OcdFileExport::setupSymbolColors(const Symbol* symbol, Counter& num_colors,
 }
 
 
+QImage OcdFileExport::symbolIcon(const Symbol* symbol) const
+{
+	auto found = symbol_icons.find(symbol);
+	return found == end(symbol_icons) ? QImage{} : found->second;
+}
+
+
 template< >
 void OcdFileExport::setupIcon<Ocd::BaseSymbolV8>(const Symbol* symbol, Ocd::BaseSymbolV8& ocd_base_symbol)
 try {
-	ocd_base_symbol.icon = Ocd::IconV9(OcdIcon{*map, *symbol}).compress();
+	ocd_base_symbol.icon = Ocd::IconV9(OcdIcon{*map, *symbol, symbolIcon(symbol)}).compress();
 	ocd_base_symbol.flags |= 0x02;
 }
 catch (std::logic_error& e)
 {
 	addWarning(tr(e.what()));
-	ocd_base_symbol.icon = OcdIcon{*map, *symbol};
+	ocd_base_symbol.icon = OcdIcon{*map, *symbol, symbolIcon(symbol)};
 }
 
 template< class OcdBaseSymbol >
 void OcdFileExport::setupIcon(const Symbol* symbol, OcdBaseSymbol& ocd_base_symbol)
 {
-	ocd_base_symbol.icon = OcdIcon{*map, *symbol};
+	ocd_base_symbol.icon = OcdIcon{*map, *symbol, symbolIcon(symbol)};
 }
 
 
@@ -2161,6 +2188,27 @@ QByteArray OcdFileExport::exportCombinedLineSymbol(
 
 
 
+template<class Format>
+int OcdFileExport::estimateObjectsSize() const
+{
+	using IndexBlock = Ocd::IndexBlock<typename Format::Object::IndexEntryType>;
+	
+	auto num_objects = qint64(0);
+	auto size = qint64(0);
+	map->applyOnAllObjects([&num_objects, &size](const Object* object) {
+		++num_objects;
+		size += qint64(sizeof(typename Format::Object)) + 8;  // header and padding
+		size += qint64(sizeof(Ocd::OcdPoint32)) * qint64(object->getRawCoordinateVector().size());
+		if (object->getType() == Object::Text)
+			size += 4 * static_cast<const TextObject*>(object)->getText().length();
+	});
+	size += (num_objects / 256 + 1) * qint64(sizeof(IndexBlock));
+	
+	// QByteArray is limited to 2 GB.
+	return int(std::min(size, qint64(std::numeric_limits<int>::max() / 2)));
+}
+
+
 template<class Format>
 void OcdFileExport::exportObjects(OcdFile<Format>& file)
 {
@@ -32,6 +32,7 @@
 #include <QtGlobal>
 #include <QByteArray>
 #include <QCoreApplication>
+#include <QImage>
 #include <QLocale>
 #include <QString>
 #include <QTextCodec>
@@ -175,6 +176,12 @@ protected:
 	template< typename Counter, typename Iterator >
 	void setupSymbolColors(const Symbol* symbol, Counter& num_colors, Iterator first, Iterator last);
 	
+	/**
+	 * Returns the generated icon which exportSymbols() rendered in advance,
+	 * or a null image.
+	 */
+	QImage symbolIcon(const Symbol* symbol) const;
+	
 	template< class OcdBaseSymbol >
 	void setupIcon(const Symbol* symbol, OcdBaseSymbol& ocd_base_symbol);
 	
@@ -251,6 +258,14 @@ protected:
 	        const LineSymbol* double_line );
 	
 	
+	/**
+	 * Estimates the number of bytes needed for the objects and their index.
+	 * 
+	 * This is used to allocate the output buffer upfront.
+	 */
+	template< class Format >
+	int estimateObjectsSize() const;
+	
 	template< class Format >
 	void exportObjects(OcdFile<Format>& file);
 	
@@ -316,6 +331,8 @@ private:
 	
 	std::unordered_map<const Symbol*, quint32> symbol_numbers;
 	
+	std::unordered_map<const Symbol*, QImage> symbol_icons;
+	
 	struct TextFormatMapping
 	{
 		const Symbol* symbol;
@@ -26,6 +26,7 @@
 #include <array>
 #include <cmath>
 #include <initializer_list>
+#include <vector>
 
 #include <Qt>
 #include <QtGlobal>
@@ -50,9 +51,20 @@ struct ConstructibleQRgb
 };
 
 
-QImage iconForExport(const Map& map, const Symbol& symbol, int width, int height)
+constexpr int iconSideLength()
+{
+	static_assert(Ocd::IconV8::width() == Ocd::IconV9::width()
+	              && Ocd::IconV8::height() == Ocd::IconV9::height(),
+	              "OCD icon dimensions must match between versions");
+	return std::max(Ocd::IconV9::width(), Ocd::IconV9::height());
+}
+
+
+QImage iconForExport(const Map& map, const Symbol& symbol, const QImage& generated, int width, int height)
 {
 	auto image = symbol.getCustomIcon();
+	if (image.isNull())
+		image = generated;
 	if (image.isNull())
 		image = symbol.createIcon(map, std::max(width, height), true);
 	else if (image.size() != QSize{width, height})
@@ -171,7 +183,7 @@ quint8 getPaletteColorV9(int r, int g, int b)
 OcdIcon::operator Ocd::IconV8() const
 {
 	Ocd::IconV8 icon;
-	auto image = iconForExport(map, symbol, icon.width(), icon.height());
+	auto image = iconForExport(map, symbol, generated, icon.width(), icon.height());
 	auto process_pixel = [&image](int x, int y)->quint8 {
 		// Apply premultiplied pixel on white background
 		auto premultiplied = image.pixel(x, y);
@@ -226,7 +238,7 @@ OcdIcon::operator Ocd::IconV8() const
 OcdIcon::operator Ocd::IconV9() const
 {
 	Ocd::IconV9 icon;
-	auto image = iconForExport(map, symbol, icon.width(), icon.height());
+	auto image = iconForExport(map, symbol, generated, icon.width(), icon.height());
 	auto process_pixel = [&image](int x, int y)->quint8 {
 		// Apply premultiplied pixel on white background
 		auto premultiplied = image.pixel(x, y);
@@ -285,4 +297,11 @@ QImage OcdIcon::toQImage(const Ocd::IconV9& icon)
 }
 
 
+// static
+std::vector<QImage> OcdIcon::createIcons(const Map& map, const std::vector<const Symbol*>& symbols)
+{
+	return Symbol::createIcons(map, symbols, iconSideLength(), true);
+}
+
+
 }  // namespace OpenOrienteering
@@ -20,8 +20,9 @@
 #ifndef OPENORIENTEERING_OCD_ICON_H
 #define OPENORIENTEERING_OCD_ICON_H
 
+#include <vector>
 
-class QImage;
+#include <QImage>
 
 
 namespace Ocd {
@@ -45,12 +46,16 @@ class Symbol;
  * 
  * ocd_base_symbol.icon = OcdIcon{map, symbol};
  * 
+ * auto images = OcdIcon::createIcons(map, symbols);
+ * ocd_base_symbol.icon = OcdIcon{map, symbol, images[i]};
+ * 
  * symbol->setCustomIcon(OcdIcon::toQImage(ocd_base_symbol.icon));
  */
 struct OcdIcon
 {
 	const Map& map;
 	const Symbol& symbol;
+	QImage generated = {};  ///< A pre-rendered generated icon, or a null image.
 	
 	// Default special member functions are fine.
 	
@@ -68,6 +73,13 @@ struct OcdIcon
 	 * Creates a QImage for the given icon data.
 	 */
 	static QImage toQImage(const Ocd::IconV9& icon);
+	
+	/**
+	 * Renders the generated icons for the given symbols concurrently.
+	 * 
+	 * The images are suitable for use as OcdIcon::generated.
+	 */
+	static std::vector<QImage> createIcons(const Map& map, const std::vector<const Symbol*>& symbols);
 };
 
 
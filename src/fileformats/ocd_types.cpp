@@ -483,7 +483,8 @@ typename OcdEntityIndex<F,T>::EntryType& OcdEntityIndex<F,T>::insert(const QByte
 {
 	auto& byte_array = Ocd::addPadding(file.byteArray());
 	IndexBlock* block;
-	auto next_block_pos = firstBlock<typename T::IndexEntryType>();
+	// Start at the last known block instead of walking the whole chain.
+	auto next_block_pos = last_block ? last_block : firstBlock<typename T::IndexEntryType>();
 	auto block_pos = decltype(next_block_pos)(0);
 	do
 	{
@@ -518,6 +519,7 @@ typename OcdEntityIndex<F,T>::EntryType& OcdEntityIndex<F,T>::insert(const QByte
 	Q_ASSERT(block);
 	block->entries[index] = entry;
 	block->entries[index].pos = entity_pos;
+	last_block = block_pos;
 	return block->entries[index];
 }
 
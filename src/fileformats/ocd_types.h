@@ -530,6 +530,7 @@ private:
 	quint32 firstBlock() const;
 	
 	OcdFile<F>& file;
+	quint32 last_block = 0;  ///< The position of the last index block, if known.
 };
 
 
@@ -0,0 +1,356 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "save_journal.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include <QtGlobal>
+#include <QBuffer>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QLatin1String>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include <zlib.h>
+
+#include "core/map.h"
+#include "core/symbols/symbol.h"
+#include "undo/undo.h"
+#include "undo/undo_manager.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+constexpr quint32 journal_magic = 0x4f4d4a4c;  // "OMJL"
+constexpr quint32 journal_version = 2;
+constexpr quint32 entry_magic = 0x4f4d4a45;    // "OMJE"
+
+/// The journal may grow to this fraction of the map file size.
+constexpr qint64 max_size_divisor = 8;
+
+
+/**
+ * The identification of the map file in the journal's header.
+ */
+struct Header
+{
+	QByteArray fingerprint;  ///< The SHA-1 hash of the complete map file
+	qint64 size = -1;
+	qint64 last_modified = -1;  ///< In milliseconds since the epoch
+};
+
+
+/**
+ * Returns the SHA-1 hash of the complete map file, or an empty array on error.
+ */
+QByteArray fingerprint(const QString& map_path)
+{
+	QFile file(map_path);
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	if (!file.open(QIODevice::ReadOnly) || !hash.addData(&file))
+		return {};
+	return hash.result();
+}
+
+
+quint32 checksum(const QByteArray& data)
+{
+	return quint32(crc32(0, reinterpret_cast<const Bytef*>(data.constData()), uInt(data.size())));
+}
+
+
+bool readHeader(QDataStream& stream, Header& header)
+{
+	quint32 magic = 0;
+	quint32 version = 0;
+	stream >> magic >> version;
+	if (stream.status() != QDataStream::Ok
+	    || magic != journal_magic
+	    || version != journal_version)
+		return false;
+	
+	stream >> header.fingerprint >> header.size >> header.last_modified;
+	return stream.status() == QDataStream::Ok;
+}
+
+
+/**
+ * Reads the next entry from the stream.
+ * 
+ * Returns false for an incomplete or damaged entry.
+ */
+bool readEntry(QDataStream& stream, QByteArray& payload)
+{
+	quint32 magic = 0;
+	quint32 sum = 0;
+	stream >> magic >> payload >> sum;
+	return stream.status() == QDataStream::Ok
+	       && magic == entry_magic
+	       && sum == checksum(payload);
+}
+
+
+/**
+ * Skips all complete entries, without verifying the checksums.
+ * 
+ * Returns the position after the last complete entry.
+ */
+qint64 skipEntries(QDataStream& stream)
+{
+	auto* device = stream.device();
+	auto end = device->pos();
+	while (!device->atEnd())
+	{
+		quint32 magic = 0;
+		quint32 size = 0;
+		stream >> magic >> size;
+		if (stream.status() != QDataStream::Ok
+		    || magic != entry_magic
+		    || size > quint32(device->size() - device->pos())
+		    || stream.skipRawData(int(size)) != int(size))
+			break;
+		
+		quint32 sum = 0;
+		stream >> sum;
+		if (stream.status() != QDataStream::Ok)
+			break;
+		
+		end = device->pos();
+	}
+	return end;
+}
+
+
+SymbolDictionary symbolDictionary(const Map& map)
+{
+	// Symbols are saved by index, and the journal requires unchanged symbols.
+	SymbolDictionary symbol_dict;
+	for (int i = 0; i < map.getNumSymbols(); ++i)
+		symbol_dict[qint32(i)] = const_cast<Symbol*>(map.getSymbol(i));
+	symbol_dict[-2] = Map::getUndefinedPoint();
+	symbol_dict[-3] = Map::getUndefinedLine();
+	symbol_dict[-4] = Map::getUndefinedText();
+	return symbol_dict;
+}
+
+
+/**
+ * Loads the steps of an entry.
+ * 
+ * Returns false if the entry cannot be loaded completely.
+ */
+bool loadSteps(const QByteArray& payload, Map& map, SymbolDictionary& symbol_dict, std::vector<std::unique_ptr<UndoStep>>& steps)
+{
+	steps.clear();
+	QXmlStreamReader xml(qUncompress(payload));
+	if (!xml.readNextStartElement() || xml.name() != QLatin1String("changes"))
+		return false;
+	
+	try
+	{
+		while (xml.readNextStartElement())
+		{
+			if (xml.name() == QLatin1String("step"))
+				steps.emplace_back(UndoStep::load(xml, &map, symbol_dict));
+			else
+				xml.skipCurrentElement();  // unknown
+		}
+	}
+	catch (std::exception& e)
+	{
+		qWarning("Failed to load a journal entry: %s", e.what());
+		return false;
+	}
+	
+	auto const is_valid = [](auto& step) { return step->isValid(); };
+	return !xml.hasError() && std::all_of(begin(steps), end(steps), is_valid);
+}
+
+
+}  // namespace
+
+
+
+// static
+QString SaveJournal::journalPath(const QString& map_path)
+{
+	return map_path + QLatin1String(".journal");
+}
+
+
+// static
+bool SaveJournal::append(const Map& map, const QString& map_path)
+{
+	if (map.areColorsDirty()
+	    || map.areSymbolsDirty()
+	    || map.areTemplatesDirty()
+	    || map.isOtherDirty())
+		return false;
+	
+	// The journal must have been started by reset().
+	QFileInfo const map_info(map_path);
+	QFile file(journalPath(map_path));
+	if (!map_info.exists() || !file.exists() || !file.open(QIODevice::ReadWrite))
+		return false;
+	
+	// Hashing the map file would defeat the purpose of the journal.
+	// Any program which rewrites the map file changes its modification time.
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+	Header header;
+	if (!readHeader(stream, header)
+	    || header.size != map_info.size()
+	    || header.last_modified != map_info.lastModified().toMSecsSinceEpoch())
+		return false;
+	auto const end = skipEntries(stream);
+	
+	// Object changes in the clean state were not made through the undo system.
+	if (map.undoManager().isClean())
+		return !map.areObjectsDirty();
+	
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	{
+		QXmlStreamWriter xml(&buffer);
+		xml.writeStartDocument();
+		xml.writeStartElement(QLatin1String("changes"));
+		if (!map.undoManager().saveChanges(xml))
+			return false;
+		xml.writeEndElement();
+		xml.writeEndDocument();
+	}
+	auto const payload = qCompress(buffer.data());
+	
+	// Compaction: Let the caller save the map in full.
+	auto const entry_size = qint64(3 * sizeof(quint32)) + payload.size();
+	if (end + entry_size > map_info.size() / max_size_divisor)
+		return false;
+	
+	// Overwrite any incomplete entry.
+	stream.resetStatus();
+	if (!file.seek(end))
+		return false;
+	stream << entry_magic << payload << checksum(payload);
+	return stream.status() == QDataStream::Ok
+	       && file.resize(file.pos())
+	       && file.flush();
+}
+
+
+// static
+bool SaveJournal::reset(const QString& map_path)
+{
+	QFileInfo const map_info(map_path);
+	auto const map_fingerprint = fingerprint(map_path);
+	if (map_fingerprint.isEmpty())
+		return false;
+	
+	QFile file(journalPath(map_path));
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream << journal_magic << journal_version << map_fingerprint
+	       << qint64(map_info.size()) << qint64(map_info.lastModified().toMSecsSinceEpoch());
+	return stream.status() == QDataStream::Ok
+	       && file.flush();
+}
+
+
+// static
+bool SaveJournal::remove(const QString& map_path)
+{
+	QFile file(journalPath(map_path));
+	return !file.exists() || file.remove();
+}
+
+
+// static
+bool SaveJournal::replay(Map& map, const QString& map_path, QString& message)
+{
+	QFile file(journalPath(map_path));
+	if (!file.exists() || file.size() == 0)
+		return false;
+	
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		message = tr("Cannot read the journal file:\n%1").arg(file.errorString());
+		return false;
+	}
+	
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+	Header header;
+	if (!readHeader(stream, header))
+	{
+		message = tr("The journal file has an unsupported format. It was ignored.");
+		return false;
+	}
+	// The modification time is not checked, so that the map file and the
+	// journal may be copied together. Loading has read the map file anyway.
+	if (header.size != QFileInfo(map_path).size()
+	    || header.fingerprint != fingerprint(map_path))
+	{
+		message = tr("The journal file does not match the map file. It was ignored.");
+		return false;
+	}
+	
+	// The steps don't maintain the selection.
+	map.clearObjectSelection(false);
+	
+	auto symbol_dict = symbolDictionary(map);
+	auto replayed = false;
+	QByteArray payload;
+	std::vector<std::unique_ptr<UndoStep>> steps;
+	while (!stream.atEnd())
+	{
+		if (!readEntry(stream, payload) || !loadSteps(payload, map, symbol_dict, steps))
+		{
+			message = tr("The journal file is damaged. Some changes could not be restored.");
+			break;
+		}
+		
+		// Each step's undo() applies the saved change.
+		for (auto& step : steps)
+			delete step->undo();
+		replayed = true;
+	}
+	
+	if (replayed)
+		map.undoManager().clear();
+	return replayed;
+}
+
+
+}  // namespace OpenOrienteering
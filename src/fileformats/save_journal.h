@@ -0,0 +1,108 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_SAVE_JOURNAL_H
+#define OPENORIENTEERING_SAVE_JOURNAL_H
+
+#include <QCoreApplication>
+#include <QString>
+
+namespace OpenOrienteering {
+
+class Map;
+
+
+/**
+ * An append-only journal of changes to a map file.
+ * 
+ * Saving a map normally rewrites the complete file. With the journal, a save
+ * only appends the changes since the last save to a file next to the map
+ * file, so it takes time proportional to the changes, not to the map size.
+ * When the map file is loaded, the journal's changes are replayed.
+ * 
+ * The changes are derived from the undo history, cf.
+ * UndoManager::saveChanges(). Thus only changes to the map objects can be
+ * journaled. Changes to colors, symbols, templates, map parts, or any other
+ * map properties require a full save. A full save is also needed when the
+ * journal grows too large in relation to the map file. A full save must be
+ * followed by reset() or remove(), which compacts the journal into the map
+ * file.
+ * 
+ * The journal identifies its map file by the SHA-1 hash of the complete
+ * file, taken by reset(), and by the file's size and modification time.
+ * Appending only checks the size and the modification time, replaying
+ * checks the size and the hash. A journal which doesn't match the map file,
+ * e.g. after the map file was saved by another program, is ignored. Each
+ * entry has a checksum, so an entry which was not written completely is
+ * detected and ignored on loading.
+ */
+class SaveJournal
+{
+	Q_DECLARE_TR_FUNCTIONS(OpenOrienteering::SaveJournal)
+
+public:
+	/**
+	 * Returns the path of the journal for the given map file.
+	 */
+	static QString journalPath(const QString& map_path);
+	
+	/**
+	 * Appends the map's unsaved changes to the journal of the given map file.
+	 * 
+	 * The map file must be the file which the map was loaded from or last
+	 * saved to, and the map's undo manager must be in the state of that file
+	 * being clean. The journal must have been started by reset().
+	 * 
+	 * Returns false if the changes cannot be journaled. Then the map must be
+	 * saved in full. This function doesn't change the map.
+	 */
+	static bool append(const Map& map, const QString& map_path);
+	
+	/**
+	 * Starts an empty journal for the given map file.
+	 * 
+	 * This must be called after the map was saved in full, when subsequent
+	 * changes shall be journaled. It reads the complete map file.
+	 */
+	static bool reset(const QString& map_path);
+	
+	/**
+	 * Removes the journal of the given map file.
+	 * 
+	 * This must be called after the map was saved in full.
+	 */
+	static bool remove(const QString& map_path);
+	
+	/**
+	 * Replays the journal of the given map file on the map.
+	 * 
+	 * The map must be loaded from the map file. The undo history is cleared
+	 * when changes are replayed, because it refers to the map file.
+	 * 
+	 * Returns true if changes were replayed. Problems which prevent the
+	 * replaying of some or all changes are reported in the message.
+	 */
+	static bool replay(Map& map, const QString& map_path, QString& message);
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
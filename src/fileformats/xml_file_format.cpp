@@ -59,8 +59,11 @@
 #include "core/symbols/point_symbol.h"
 #include "core/symbols/symbol.h"
 #include "fileformats/file_import_export.h"
+#include "fileformats/save_journal.h"
+#include "fileformats/xml_object_loader.h"
 #include "templates/template.h"
 #include "undo/undo_manager.h"
+#include "util/gzip_device.h"
 #include "util/xml_stream_util.h"
 
 
@@ -97,6 +100,7 @@ XMLFileFormat::XMLFileFormat()
               Feature::FileSave | Feature::FileSaveAs )
 {
 	addExtension(QString::fromLatin1("xmap"));
+	addExtension(QString::fromLatin1("omapz"));
 }
 
 
@@ -106,6 +110,15 @@ FileFormat::ImportSupportAssumption XMLFileFormat::understands(const char* buffe
 	if (size >= 4 && qstrncmp(buffer, "OMAP", 4) == 0)
 	    return FullySupported;  // Legacy binary format. Final error raised in doImport().
 	
+	if (GzipDevice::isGzipData(buffer, size))
+	{
+		// Compressed variant: Inspect the beginning of the uncompressed data.
+		auto const head = GzipDevice::uncompressedHead(buffer, size, 4096);
+		if (head.isEmpty() || GzipDevice::isGzipData(head.constData(), head.size()))
+			return NotSupported;
+		return understands(head.constData(), head.size());
+	}
+	
 	if (size > 38)  // length of "<?xml ...>"
 	{
 		QXmlStreamReader xml(data);
@@ -221,15 +234,37 @@ XMLFileExporter::XMLFileExporter(const QString& path, const Map* map, const MapV
 	// Determine auto-formatting default from filename, if possible.
 	bool auto_formatting = path.endsWith(QLatin1String(".xmap"));
 	setOption(QString::fromLatin1("autoFormatting"), auto_formatting);
+	
+	// Determine compression default from filename, if possible.
+	bool compressed = path.endsWith(QLatin1String(".omapz"));
+	setOption(QString::fromLatin1("compressed"), compressed);
 }
 
 XMLFileExporter::~XMLFileExporter() = default;
 
 
 
+bool XMLFileExporter::objectUpdatesNeeded() const noexcept
+{
+	// Only coordinates and attributes are written.
+	return false;
+}
+
+
 bool XMLFileExporter::exportImplementation()
 {
-	xml.setDevice(device());
+	std::unique_ptr<GzipDevice> compressor;
+	if (option(QString::fromLatin1("compressed")).toBool())
+	{
+		compressor = std::make_unique<GzipDevice>(device());
+		if (!compressor->open(QIODevice::WriteOnly))
+			throw FileFormatException(compressor->errorString());
+		xml.setDevice(compressor.get());
+	}
+	else
+	{
+		xml.setDevice(device());
+	}
 	
 	if (option(QString::fromLatin1("autoFormatting")).toBool())
 		xml.setAutoFormatting(true);
@@ -305,6 +340,13 @@ bool XMLFileExporter::exportImplementation()
 	}
 	
 	xml.writeEndDocument();
+	
+	if (compressor)
+	{
+		if (!compressor->finish())
+			throw FileFormatException(compressor->errorString());
+		xml.setDevice(nullptr);
+	}
 	return true;
 }
 
@@ -518,7 +560,10 @@ void XMLFileExporter::exportRedo()
 
 XMLFileImporter::XMLFileImporter(const QString& path, Map *map, MapView *view)
 : Importer(path, map, view)
-{}
+{
+	setOption(QString::fromLatin1("parallelObjects"), true);
+	setOption(QString::fromLatin1("replayJournal"), true);
+}
 
 XMLFileImporter::~XMLFileImporter() = default;
 
@@ -535,13 +580,29 @@ void XMLFileImporter::addWarningUnsupportedElement()
 
 bool XMLFileImporter::importImplementation()
 {
-	xml.setDevice(device());
+	// The compressed variant is decompressed while reading.
+	// The decompressing device is sequential, so objects are loaded sequentially.
+	auto* input = device();
+	std::unique_ptr<GzipDevice> decompressor;
+	if (GzipDevice::isGzipData(*input))
+	{
+		decompressor = std::make_unique<GzipDevice>(input);
+		if (!decompressor->open(QIODevice::ReadOnly))
+			throw FileFormatException(decompressor->errorString());
+		input = decompressor.get();
+	}
+	
+	parallel_chunk_count = 0;
+	if (!loadSymbolsOnly() && option(QString::fromLatin1("parallelObjects")).toBool())
+		object_loader = std::make_unique<XmlObjectLoader>(*input, symbol_dict);
+	
+	xml.setDevice(input);
 	if (!xml.readNextStartElement() || xml.name() != literal::map)
 	{
-		if (device()->seek(0))
+		if (!decompressor && input->seek(0))
 		{
 			char data[4] = {};
-			device()->read(data, 4);
+			input->read(data, 4);
 			if (qstrncmp(data, "OMAP", 4) == 0)
 			{
 				throw FileFormatException(::OpenOrienteering::Importer::tr(
@@ -566,6 +627,9 @@ bool XMLFileImporter::importImplementation()
 	MapCoord::boundsOffset().reset(true);
 	georef_offset_adjusted = false;
 	importElements();
+	parallel_chunk_count = object_loader ? object_loader->chunkCount() : 0;
+	object_loader.reset();
+	xml.setDevice(nullptr);
 	
 	auto offset = MapCoord::boundsOffset();
 	if (!loadSymbolsOnly() && !offset.isZero())
@@ -597,6 +661,18 @@ bool XMLFileImporter::importImplementation()
 			map->setGeoreferencing(georef);
 		}
 	}
+	
+	// The map file is outdated without the changes in its journal, for
+	// editing as well as for templates, imports and conversions.
+	if (!loadSymbolsOnly() && !path.isEmpty() && option(QString::fromLatin1("replayJournal")).toBool())
+	{
+		// The journal is in the coordinates of the loaded map.
+		MapCoord::boundsOffset().reset(false);
+		QString message;
+		SaveJournal::replay(*map, path, message);
+		if (!message.isEmpty())
+			addWarning(message);
+	}
 	return true;
 }
 
@@ -962,12 +1038,12 @@ void XMLFileImporter::importMapParts()
 		if (xml.name() == literal::part)
 		{
 			auto recovery = XmlRecoveryHelper(xml);
-			auto part = MapPart::load(xml, *map, symbol_dict);
+			auto part = MapPart::load(xml, *map, symbol_dict, object_loader.get());
 			if (xml.hasError() && recovery())
 			{
 				addWarning(tr("Some invalid characters had to be removed."));
 				delete part;
-				part = MapPart::load(xml, *map, symbol_dict);
+				part = MapPart::load(xml, *map, symbol_dict, object_loader.get());
 			}
 			map->parts.push_back(part);
 		}
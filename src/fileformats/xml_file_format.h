@@ -46,6 +46,8 @@ public:
 	
 	
 	/** @brief Returns true for an XML file using the Mapper namespace.
+	 * 
+	 * The XML data may be gzip-compressed, as in *.omapz files.
 	 */
 	ImportSupportAssumption understands(const char* buffer, int size) const override;
 	
@@ -22,6 +22,7 @@
 #define OPENORIENTEERING_FILE_FORMAT_XML_P_H
 
 #include <functional>
+#include <memory>
 
 #include <QCoreApplication>
 #include <QXmlStreamReader>
@@ -32,6 +33,9 @@
 
 namespace OpenOrienteering {
 
+class XmlObjectLoader;
+
+
 /** Map exporter for the xml based map format. */
 class XMLFileExporter : public Exporter
 {
@@ -47,6 +51,8 @@ public:
 	XMLFileExporter& operator=(const XMLFileExporter&) = delete;	
 	XMLFileExporter& operator=(XMLFileExporter&&) = delete;	
 	
+	bool objectUpdatesNeeded() const noexcept override;
+	
 protected:
 	bool exportImplementation() override;
 	
@@ -80,6 +86,12 @@ public:
 	XMLFileImporter& operator=(const XMLFileImporter&) = delete;	
 	XMLFileImporter& operator=(XMLFileImporter&&) = delete;	
 	
+	/**
+	 * Returns the number of object chunks which were loaded in parallel
+	 * during the last import.
+	 */
+	int parallelChunkCount() const { return parallel_chunk_count; }
+	
 protected:
 	bool importImplementation() override;
 	
@@ -103,7 +115,9 @@ protected:
 private:
 	QXmlStreamReader xml;
 	SymbolDictionary symbol_dict;
+	std::unique_ptr<XmlObjectLoader> object_loader;
 	int version = -1;
+	int parallel_chunk_count = 0;
 	bool georef_offset_adjusted;
 };
 
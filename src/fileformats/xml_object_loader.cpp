@@ -0,0 +1,472 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "xml_object_loader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+
+#include <Qt>
+#include <QIODevice>
+#include <QLatin1String>
+#include <QRunnable>
+#include <QScopedValueRollback>
+#include <QString>
+#include <QStringRef>
+#include <QThread>
+#include <QThreadPool>
+#include <QXmlStreamReader>
+
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "core/objects/object.h"
+#include "fileformats/file_format.h"
+
+
+namespace literal
+{
+	const QLatin1String object("object");
+	const QLatin1String objects("objects");
+	const QLatin1String utf8("UTF-8");
+}
+
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/// The number of chunks per thread, for balancing the load.
+constexpr int chunks_per_thread = 4;
+
+/// The minimum size of a chunk in bytes.
+constexpr qint64 minimum_chunk_size = 16 * 1024;
+
+
+/**
+ * Returns a pointer behind the first occurrence of pattern in [first, last),
+ * or nullptr.
+ */
+const char* findBehind(const char* first, const char* last, const char* pattern)
+{
+	auto const length = std::strlen(pattern);
+	auto const found = std::search(first, last, pattern, pattern + length);
+	return found == last ? nullptr : found + length;
+}
+
+
+/**
+ * Scans the content of an element for the ends of its child elements.
+ * 
+ * The scan starts at pos which must be behind the element's start tag.
+ * This function returns the position of the element's end tag, or -1 if the
+ * data is not understood.
+ */
+qint64 scanChildren(const QByteArray& data, qint64 pos, std::vector<qint64>& child_ends)
+{
+	auto const* const first = data.constData();
+	auto const* const last = first + data.size();
+	auto const* p = first + pos;
+	auto depth = 0;
+	for (;;)
+	{
+		p = static_cast<const char*>(std::memchr(p, '<', std::size_t(last - p)));
+		if (!p || last - p < 2)
+			return -1;
+		
+		auto const* const tag = p;
+		switch (p[1])
+		{
+		case '!':
+			if (last - p >= 4 && std::strncmp(p, "<!--", 4) == 0)
+				p = findBehind(p + 4, last, "-->");
+			else if (last - p >= 9 && std::strncmp(p, "<![CDATA[", 9) == 0)
+				p = findBehind(p + 9, last, "]]>");
+			else
+				return -1;
+			if (!p)
+				return -1;
+			break;
+		
+		case '?':
+			p = findBehind(p + 2, last, "?>");
+			if (!p)
+				return -1;
+			break;
+		
+		case '/':
+			p = static_cast<const char*>(std::memchr(p, '>', std::size_t(last - p)));
+			if (!p)
+				return -1;
+			++p;
+			if (depth == 0)
+				return tag - first;
+			if (--depth == 0)
+				child_ends.push_back(p - first);
+			break;
+		
+		default:
+		{
+			// A start tag. Attribute values may contain '>'.
+			auto quote = char(0);
+			for (++p; p != last; ++p)
+			{
+				if (quote)
+				{
+					if (*p == quote)
+						quote = 0;
+				}
+				else if (*p == '"' || *p == '\'')
+				{
+					quote = *p;
+				}
+				else if (*p == '>')
+				{
+					break;
+				}
+			}
+			if (p == last)
+				return -1;
+			
+			auto const empty_element = (p[-1] == '/');
+			++p;
+			if (!empty_element)
+				++depth;
+			else if (depth == 0)
+				child_ends.push_back(p - first);
+		}
+		}
+	}
+}
+
+
+/**
+ * Returns whitespace which moves a reader from behind "<objects>" at the
+ * start of a document to the line and column of pos in data.
+ */
+QByteArray positionPadding(const QByteArray& data, qint64 pos)
+{
+	auto const* const first = data.constData();
+	auto const lines = std::count(first, first + pos, '\n');
+	auto const line_start = lines > 0 ? data.lastIndexOf('\n', int(pos - 1)) + 1 : 0;
+	
+	// Columns count UTF-16 characters, like in XmlObjectLoader::byteOffset().
+	auto column = qint64(0);
+	for (auto const* p = first + line_start; p != first + pos; ++p)
+	{
+		auto const byte = uchar(*p);
+		if ((byte & 0xc0) != 0x80)
+			column += (byte >= 0xf0) ? 2 : 1;
+	}
+	if (lines == 0)
+		column -= qstrlen("<objects>");
+	
+	auto padding = QByteArray(int(lines), '\n');
+	padding.append(QByteArray(int(std::max(qint64(0), column)), ' '));
+	return padding;
+}
+
+
+/**
+ * A range of object elements, and the outcome of loading them.
+ */
+struct ObjectChunk
+{
+	qint64 begin;
+	qint64 end;
+	std::vector<Object*> objects;
+	QString error;
+};
+
+
+/**
+ * The shared state of loading object chunks.
+ * 
+ * The participating threads take chunks until all are loaded.
+ */
+struct ObjectBatch
+{
+	const QByteArray& data;
+	const SymbolDictionary& symbol_dict;
+	std::vector<ObjectChunk>& chunks;
+	MapCoord::BoundsOffset bounds_offset;
+	std::atomic<std::size_t> next { 0 };
+	
+	void load()
+	{
+		for (auto i = next++; i < chunks.size(); i = next++)
+			load(chunks[i]);
+	}
+	
+	/**
+	 * Loads the objects of a single chunk.
+	 * 
+	 * Normally, line and column numbers in error messages are relative to
+	 * the chunk. With document_positions, they match the document, but the
+	 * reader must skip whitespace for all preceding lines.
+	 */
+	void load(ObjectChunk& chunk, bool document_positions = false)
+	{
+		QByteArray bytes;
+		bytes.reserve(int(chunk.end - chunk.begin) + 32);
+		bytes.append("<objects>");
+		if (document_positions)
+			bytes.append(positionPadding(data, chunk.begin));
+		bytes.append(data.constData() + chunk.begin, int(chunk.end - chunk.begin));
+		bytes.append("</objects>");
+		
+		QXmlStreamReader xml(bytes);
+		try
+		{
+			xml.readNextStartElement();
+			while (xml.readNextStartElement())
+			{
+				if (xml.name() == literal::object)
+					chunk.objects.push_back(Object::load(xml, nullptr, symbol_dict));
+				else
+					xml.skipCurrentElement(); // unknown
+			}
+			if (xml.hasError())
+				chunk.error = xml.errorString();
+		}
+		catch (const FileFormatException& e)
+		{
+			chunk.error = e.message();
+		}
+		catch (const std::exception& e)
+		{
+			chunk.error = QString::fromLocal8Bit(e.what());
+		}
+	}
+};
+
+
+class ObjectJob : public QRunnable
+{
+public:
+	explicit ObjectJob(ObjectBatch& batch) : batch(batch) {}
+	
+	void run() override
+	{
+		// Pool threads must use the offset of the importing thread.
+		QScopedValueRollback<MapCoord::BoundsOffset> rollback { MapCoord::boundsOffset() };
+		MapCoord::boundsOffset() = batch.bounds_offset;
+		batch.load();
+	}
+
+private:
+	ObjectBatch& batch;
+};
+
+
+void deleteObjects(std::vector<ObjectChunk>& chunks)
+{
+	for (auto& chunk : chunks)
+	{
+		for (auto* object : chunk.objects)
+			delete object;
+		chunk.objects.clear();
+	}
+}
+
+}  // namespace
+
+
+
+XmlObjectLoader::XmlObjectLoader(QIODevice& device, const SymbolDictionary& symbol_dict)
+: device(&device)
+, symbol_dict(symbol_dict)
+, max_threads(QThread::idealThreadCount())
+{
+	// Small documents, e.g. from the clipboard, are not worth the copy.
+	if (max_threads > 1 && !device.isSequential()
+	    && device.size() - device.pos() >= minimum_size)
+	{
+		auto const pos = device.pos();
+		data = device.readAll();
+		if (!device.seek(pos))
+			data.clear();
+	}
+}
+
+XmlObjectLoader::~XmlObjectLoader() = default;
+
+
+
+bool XmlObjectLoader::isEnabled() const
+{
+	return !data.isEmpty();
+}
+
+
+bool XmlObjectLoader::load(QXmlStreamReader& xml, Map& map, std::vector<Object*>& objects)
+{
+	if (!isEnabled()
+	    || xml.device() != device
+	    || !xml.isStartElement()
+	    || xml.name() != literal::objects)
+		return false;
+	
+	auto const encoding = xml.documentEncoding();
+	if (!encoding.isEmpty() && encoding.compare(literal::utf8, Qt::CaseInsensitive) != 0)
+		return false;
+	
+	auto const content = findContent(xml);
+	if (content < 0)
+		return false;
+	
+	std::vector<qint64> object_ends;
+	if (scanChildren(data, content, object_ends) < 0
+	    || object_ends.empty()
+	    || object_ends.back() - content < minimum_size)
+		return false;
+	
+	auto const chunk_size = std::max(minimum_chunk_size, (object_ends.back() - content) / (max_threads * chunks_per_thread));
+	std::vector<ObjectChunk> chunks;
+	auto chunk_begin = content;
+	for (auto object_end : object_ends)
+	{
+		if (object_end - chunk_begin >= chunk_size || object_end == object_ends.back())
+		{
+			chunks.push_back({ chunk_begin, object_end, {}, {} });
+			chunk_begin = object_end;
+		}
+	}
+	
+	ObjectBatch batch { data, symbol_dict, chunks, {} };
+	
+	// The first coordinates determine the bounds offset. Load sequentially
+	// until it is settled.
+	while (MapCoord::boundsOffset().check_for_offset && batch.next < chunks.size())
+		batch.load(chunks[batch.next++]);
+	batch.bounds_offset = MapCoord::boundsOffset();
+	
+	{
+		auto const num_helpers = std::min(max_threads - 1, int(chunks.size() - batch.next));
+		QThreadPool pool;
+		pool.setMaxThreadCount(std::max(1, num_helpers));
+		for (int i = 0; i < num_helpers; ++i)
+			pool.start(new ObjectJob(batch));
+		
+		// The calling thread moves the stream to the end element while the
+		// helpers load the objects, and then it takes its share, too.
+		xml.skipCurrentElement();
+		batch.load();
+		pool.waitForDone();
+	}
+	
+	if (xml.hasError())
+	{
+		// The caller deals with errors in the stream.
+		deleteObjects(chunks);
+		return true;
+	}
+	
+	auto const failed = std::find_if(begin(chunks), end(chunks), [](const ObjectChunk& chunk) {
+		return !chunk.error.isEmpty();
+	});
+	if (failed != end(chunks))
+	{
+		// Errors are rare. Load the chunk again, for a message with the
+		// line number in the document.
+		auto error = failed->error;
+		deleteObjects(chunks);
+		failed->error.clear();
+		batch.load(*failed, true);
+		if (!failed->error.isEmpty())
+			error = failed->error;
+		deleteObjects(chunks);
+		throw FileFormatException(error);
+	}
+	
+	num_chunks += int(chunks.size());
+	
+	for (auto& chunk : chunks)
+	{
+		for (auto* object : chunk.objects)
+		{
+			object->setMap(&map);
+			const auto& coords = object->getRawCoordinateVector();
+			if (coords.empty() || !coords.front().isRegular() || !coords.back().isRegular())
+				map.markAsIrregular(object);
+		}
+		objects.insert(objects.end(), chunk.objects.begin(), chunk.objects.end());
+	}
+	return true;
+}
+
+
+qint64 XmlObjectLoader::byteOffset(qint64 character_offset)
+{
+	if (character_offset < last_character_offset)
+	{
+		last_character_offset = 0;
+		last_byte_offset = 0;
+	}
+	
+	auto const* const bytes = reinterpret_cast<const uchar*>(data.constData());
+	auto const size = qint64(data.size());
+	auto c = last_character_offset;
+	auto b = last_byte_offset;
+	while (c < character_offset && b < size)
+	{
+		auto const lead = bytes[b];
+		for (++b; b < size && (bytes[b] & 0xc0) == 0x80; ++b)
+			;  // skip continuation bytes
+		// Four-byte sequences are surrogate pairs in UTF-16.
+		c += (lead >= 0xf0) ? 2 : 1;
+	}
+	last_character_offset = c;
+	last_byte_offset = b;
+	return c == character_offset ? b : -1;
+}
+
+
+qint64 XmlObjectLoader::findContent(const QXmlStreamReader& xml)
+{
+	auto const is_behind_start_tag = [this](qint64 pos) {
+		if (pos < 2 || pos > data.size()
+		    || data.at(int(pos - 1)) != '>'
+		    || data.at(int(pos - 2)) == '/')
+			return false;
+		auto const tag = data.lastIndexOf('<', int(pos - 1));
+		return tag >= 0
+		       && pos - tag >= 9
+		       && std::strncmp(data.constData() + tag, "<objects", 8) == 0
+		       && (data.at(tag + 8) == ' ' || data.at(tag + 8) == '>');
+	};
+	
+	// The character offset is just behind the start tag.
+	auto const pos = byteOffset(xml.characterOffset());
+	if (pos >= 0 && is_behind_start_tag(pos))
+		return pos;
+	
+	// The reader may not count a byte order mark.
+	if (pos >= 0 && data.startsWith("\xef\xbb\xbf") && is_behind_start_tag(pos + 3))
+		return pos + 3;
+	
+	return -1;
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,122 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_XML_OBJECT_LOADER_H
+#define OPENORIENTEERING_XML_OBJECT_LOADER_H
+
+#include <vector>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QHash>
+
+class QIODevice;
+class QXmlStreamReader;
+
+namespace OpenOrienteering {
+
+class Map;
+class Object;
+class Symbol;
+
+using SymbolDictionary = QHash<qint32, Symbol*>; // from symbol.h
+
+
+/**
+ * Loads the objects of XML map files on multiple threads.
+ * 
+ * The loader keeps a copy of the raw document. When the stream reader of the
+ * importer reaches an <objects> element, the loader scans the raw data for
+ * the byte ranges of the object elements, and splits them into chunks. The
+ * chunks are parsed by worker threads, each with its own QXmlStreamReader,
+ * while the importer's stream reader skips over the element. Finally, the
+ * objects are collected in document order.
+ * 
+ * The symbols must be completely loaded before, and the symbol dictionary
+ * must not be modified while objects are loaded.
+ * 
+ * Only UTF-8 documents from random-access devices are supported. In all
+ * other cases, and for small elements, load() returns false, and the caller
+ * shall read the objects sequentially.
+ */
+class XmlObjectLoader
+{
+public:
+	/**
+	 * Constructs a loader for the document on the given device.
+	 * 
+	 * This reads the remaining data from the device and restores the
+	 * device's position. If there is less than minimum_size data, the loader
+	 * is disabled.
+	 */
+	XmlObjectLoader(QIODevice& device, const SymbolDictionary& symbol_dict);
+	
+	XmlObjectLoader(const XmlObjectLoader&) = delete;
+	XmlObjectLoader& operator=(const XmlObjectLoader&) = delete;
+	
+	~XmlObjectLoader();
+	
+	/**
+	 * Returns true if the loader may load objects in parallel.
+	 */
+	bool isEnabled() const;
+	
+	/**
+	 * Loads the objects from the current <objects> element.
+	 * 
+	 * The stream must be positioned at the start element, and it must read
+	 * the device given to the constructor. On success, this function appends
+	 * the objects to the given vector, moves the stream to the end element,
+	 * and returns true. If the objects cannot be loaded in parallel, this
+	 * function returns false, leaving the stream unchanged.
+	 * 
+	 * Throws FileFormatException if an object cannot be loaded. Line numbers
+	 * in the message refer to the document.
+	 */
+	bool load(QXmlStreamReader& xml, Map& map, std::vector<Object*>& objects);
+	
+	/**
+	 * Returns the number of chunks which were loaded in parallel so far.
+	 */
+	int chunkCount() const { return num_chunks; }
+	
+	/**
+	 * The minimum number of bytes of object data for parallel loading.
+	 */
+	static constexpr qint64 minimum_size = 64 * 1024;
+
+private:
+	qint64 byteOffset(qint64 character_offset);
+	
+	qint64 findContent(const QXmlStreamReader& xml);
+	
+	const QIODevice* device;
+	const SymbolDictionary& symbol_dict;
+	QByteArray data;
+	qint64 last_character_offset = 0;
+	qint64 last_byte_offset = 0;
+	int max_threads;
+	int num_chunks = 0;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -109,6 +109,7 @@ const std::vector<QByteArray>& OgrTemplate::supportedExtensions()
 std::unique_ptr<Georeferencing> OgrTemplate::getDataGeoreferencing(const QString& path, const Georeferencing& initial_georef)
 {
 	Map tmp_map;
+	tmp_map.setDataOnly(true);
 	tmp_map.setGeoreferencing(initial_georef);
 	OgrFileImport importer{ path, &tmp_map, nullptr, OgrFileImport::UnitOnGround};
 	importer.setGeoreferencingImportEnabled(true);
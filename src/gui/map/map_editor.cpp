@@ -110,6 +110,7 @@
 #include "fileformats/file_format.h"
 #include "fileformats/file_format_registry.h"
 #include "fileformats/file_import_export.h"
+#include "fileformats/save_journal.h"
 #include "gui/configure_grid_dialog.h"
 #include "gui/file_dialog.h"
 #include "gui/georeferencing_dialog.h"
@@ -577,8 +578,27 @@ bool MapEditorController::saveTo(const QString& path, const FileFormat& format)
 		return false;
 	}
 	
-	if (!exportTo(path, format))
-		return false;
+	// Object changes may be appended to the journal of the file which holds
+	// the clean state. This is not the case after recovering an autosave file.
+	auto const is_xml = qstrcmp(format.id(), "XML") == 0;
+	auto const use_journal = is_xml && Settings::getInstance().getSetting(Settings::General_SaveJournal).toBool();
+	auto const journaled = use_journal
+	                       && path == journal_base_path
+	                       && SaveJournal::append(*map, path);
+	if (!journaled)
+	{
+		if (!exportTo(path, format))
+			return false;
+		journal_base_path = path;
+		if (is_xml
+		    && !(use_journal && SaveJournal::reset(path))
+		    && !SaveJournal::remove(path))
+		{
+			QMessageBox::warning(window, tr("Warning"),
+			                     tr("Cannot remove the outdated journal file\n%1")
+			                     .arg(SaveJournal::journalPath(path)) );
+		}
+	}
 	
 	map->setHasUnsavedChanges(false);
 	map->undoManager().setClean();
@@ -606,6 +626,10 @@ bool MapEditorController::exportTo(const QString& path, const FileFormat& format
 		return false;
 	}
 	
+	// Object updates may have been deferred.
+	if (exporter->objectUpdatesNeeded())
+		map->updateObjects();
+	
 	if (!exporter->doExport())
 	{
 		auto message = tr("Cannot save file\n%1:\n%2")
@@ -651,6 +675,8 @@ bool MapEditorController::loadFrom(const QString& path, const FileFormat& format
 		return false;
 	}
 	
+	// Renderables are generated for the visible area first, cf. MapWidget.
+	map->setObjectUpdatesDeferred(true);
 	if (!importer->doImport())
 	{
 		delete map;
@@ -661,9 +687,11 @@ bool MapEditorController::loadFrom(const QString& path, const FileFormat& format
 		QMessageBox::warning(dialog_parent, tr("Error"), importer->warnings().back());
 		return false;
 	}
+	map->setObjectUpdatesDeferred(false);
 	
 	setMapAndView(map, main_view);
 	map->setHasUnsavedChanges(false);
+	journal_base_path = path;
 	if (!importer->warnings().empty())
 		MainWindow::showMessageBox(dialog_parent, tr("Warning"), tr("The map import generated warnings."), importer->warnings());
 	return true;
@@ -1798,6 +1826,7 @@ void MapEditorController::copy()
 	
 	// Create map containing required objects and their symbol and color dependencies
 	Map copy_map;
+	copy_map.setDataOnly(true);
 	copy_map.setScaleDenominator(map->getScaleDenominator());
 	
 	std::vector<bool> symbol_filter;
@@ -1860,6 +1889,7 @@ void MapEditorController::paste()
 	
 	// Create map from buffer
 	Map paste_map;
+	paste_map.setDataOnly(true);
 	if (!paste_map.importFromIODevice(buffer))
 	{
 		QMessageBox::warning(nullptr, tr("Error"), tr("An internal error occurred, sorry!"));
@@ -2353,21 +2383,9 @@ void MapEditorController::objectSelectionChanged()
 	// Automatic symbol selection of selected objects
 	if (symbol_widget && !editing_in_progress)
 	{
-		bool uniform_symbol_selected = true;
-		const Symbol* uniform_symbol = nullptr;
-		for (const auto* object : map->selectedObjects())
-		{
-			const auto* symbol = object->getSymbol();
-			if (!uniform_symbol)
-			{
-				uniform_symbol = symbol;
-			}
-			else if (uniform_symbol != symbol)
-			{
-				uniform_symbol_selected = false;
-				break;
-			}
-		}
+		const auto& symbol_counts = map->selectedSymbolCounts();
+		bool uniform_symbol_selected = symbol_counts.size() <= 1;
+		const Symbol* uniform_symbol = symbol_counts.isEmpty() ? nullptr : symbol_counts.constBegin().key();
 		if (uniform_symbol_selected && Settings::getInstance().getSettingCached(Settings::MapEditor_ChangeSymbolWhenSelecting).toBool())
 			symbol_widget->selectSingleSymbol(uniform_symbol);
 	}
@@ -2409,38 +2427,24 @@ void MapEditorController::updateObjectDependentActions()
 	bool have_rotatable_object   = false;
 	int  num_selected_paths      = 0;
 	bool first_selected_is_path  = have_selection && map->getFirstSelectedObject()->getType() == Object::Path;
-	bool uniform_symbol_selected = true;
-	const Symbol* uniform_symbol = nullptr;
 	const Symbol* first_selected_symbol= have_selection ? map->getFirstSelectedObject()->getSymbol() : nullptr;
 	std::vector< bool > symbols_in_selection(map->getNumSymbols(), false);
 	
 	if (!editing_in_progress)
 	{
-		for (const auto* object : map->selectedObjects())
+		const auto& symbol_counts = map->selectedSymbolCounts();
+		for (auto it = symbol_counts.constBegin(), end = symbol_counts.constEnd(); it != end; ++it)
 		{
-			const auto* symbol = object->getSymbol();
+			const auto* symbol = it.key();
 			int symbol_index = map->findSymbolIndex(symbol);
 			if (symbol_index >= 0 && symbol_index < (int)symbols_in_selection.size())
 				symbols_in_selection[symbol_index] = true;
 			
-			if (uniform_symbol_selected)
-			{
-				if (!uniform_symbol)
-				{
-					uniform_symbol = symbol;
-				}
-				else if (uniform_symbol != symbol)
-				{
-					uniform_symbol = nullptr;
-					uniform_symbol_selected = false;
-				}
-			}
-			
 			have_rotatable_object |= symbol->isRotatable();
 			
 			if (Symbol::areTypesCompatible(symbol->getType(), Symbol::Area))
 			{
-				++num_selected_paths;
+				num_selected_paths += it.value();
 				
 				if (symbol->getType() == Symbol::Area)
 				{
@@ -2457,11 +2461,17 @@ void MapEditorController::updateObjectDependentActions()
 				if (contained_types & Symbol::Area)
 				{
 					have_area = true;
-					have_area_with_holes |= object->asPath()->parts().size() > 1;
 				}
 			}
 		}
 		
+		// Only needed for a single selected object
+		if (single_object_selected && have_area)
+		{
+			const auto* object = map->getFirstSelectedObject();
+			have_area_with_holes = object->getType() == Object::Path && object->asPath()->parts().size() > 1;
+		}
+		
 		if (have_area && !have_rotatable_pattern)
 		{
 			map->determineSymbolUseClosure(symbols_in_selection);
@@ -2577,6 +2587,15 @@ void MapEditorController::undoStepAvailabilityChanged()
 	clear_undo_redo_history_act->setEnabled(undo_act->isEnabled() || redo_act->isEnabled());
 }
 
+void MapEditorController::updateUndoSettings()
+{
+	const auto& settings = Settings::getInstance();
+	auto const limit_mb = qMax(0, settings.getSetting(Settings::General_UndoMemoryLimitMB).toInt());
+	auto& undo_manager = map->undoManager();
+	undo_manager.setSpillingEnabled(settings.getSetting(Settings::General_UndoSpillToTemporaryFile).toBool());
+	undo_manager.setMemoryLimit(std::size_t(limit_mb) * 1024 * 1024);
+}
+
 void MapEditorController::clipboardChanged(QClipboard::Mode mode)
 {
 	if (mode == QClipboard::Clipboard)
@@ -2867,18 +2886,16 @@ void MapEditorController::selectObjectsClicked(bool select_exclusively)
 		map->clearObjectSelection(false);
 	}
 
-	bool object_selected = false;	
-	MapPart* part = map->getCurrentPart();
-	for (int i = 0, size = part->getNumObjects(); i < size; ++i)
-	{
-		Object* object = part->getObject(i);
-		if (symbol_widget->isSymbolSelected(object->getSymbol()) && !(!select_exclusively && map->isObjectSelected(object)))
-		{
-			map->addObjectToSelection(object, false);
-			object_selected = true;
-		}
-	}
+	std::vector<Object*> objects;
+	map->getCurrentPart()->applyOnMatchingObjects([&objects](Object* object) {
+		objects.push_back(object);
+	}, [this, select_exclusively](const Object* object) {
+		return symbol_widget->isSymbolSelected(object->getSymbol())
+		       && (select_exclusively || !map->isObjectSelected(object));
+	});
+	map->addObjectsToSelection(objects, false);
 	
+	bool object_selected = !objects.empty();
 	selection_changed |= object_selected;
 	if (selection_changed)
 		map->emitSelectionChanged();
@@ -2896,20 +2913,14 @@ void MapEditorController::selectObjectsClicked(bool select_exclusively)
 
 void MapEditorController::deselectObjectsClicked()
 {
-	bool selection_changed = false;
-	
-	MapPart* part = map->getCurrentPart();
-	for (int i = 0, size = part->getNumObjects(); i < size; ++i)
-	{
-		Object* object = part->getObject(i);
-		if (symbol_widget->isSymbolSelected(object->getSymbol()) && map->isObjectSelected(object))
-		{
-			map->removeObjectFromSelection(object, false);
-			selection_changed = true;
-		}
-	}
+	std::vector<Object*> objects;
+	map->getCurrentPart()->applyOnMatchingObjects([&objects](Object* object) {
+		objects.push_back(object);
+	}, [this](const Object* object) {
+		return symbol_widget->isSymbolSelected(object->getSymbol());
+	});
 	
-	if (selection_changed)
+	if (map->removeObjectsFromSelection(objects, false) > 0)
 	{
 		map->emitSelectionChanged();
 		
@@ -2921,10 +2932,13 @@ void MapEditorController::deselectObjectsClicked()
 void MapEditorController::selectAll()
 {
 	auto num_selected_objects = map->getNumSelectedObjects();
-	map->clearObjectSelection(false);
-	map->getCurrentPart()->applyOnAllObjects([this](Object* object) {
-		map->addObjectToSelection(object, false);
+	std::vector<Object*> objects;
+	objects.reserve(std::size_t(map->getCurrentPart()->getNumObjects()));
+	map->getCurrentPart()->applyOnAllObjects([&objects](Object* object) {
+		objects.push_back(object);
 	});
+	map->clearObjectSelection(false);
+	map->addObjectsToSelection(objects, false);
 	
 	if (map->getNumSelectedObjects() != num_selected_objects)
 	{
@@ -2942,12 +2956,14 @@ void MapEditorController::selectNothing()
 
 void MapEditorController::invertSelection()
 {
-	auto selection = Map::ObjectSelection{ map->selectedObjects() };
-	map->clearObjectSelection(false);
-	map->getCurrentPart()->applyOnAllObjects([this, &selection](Object* object) {
-		if (selection.find(object) == end(selection))
-			map->addObjectToSelection(object, false);
+	std::vector<Object*> objects;
+	map->getCurrentPart()->applyOnMatchingObjects([&objects](Object* object) {
+		objects.push_back(object);
+	}, [this](const Object* object) {
+		return !map->isObjectSelected(object);
 	});
+	map->clearObjectSelection(false);
+	map->addObjectsToSelection(objects, false);
 	
 	if (map->getCurrentPart()->getNumObjects() > 0)
 	{
@@ -3970,6 +3986,8 @@ void MapEditorController::setMapAndView(Map* map, MapView* map_view)
 	
 	connect(&map->undoManager(), &UndoManager::canRedoChanged, this, &MapEditorController::undoStepAvailabilityChanged);
 	connect(&map->undoManager(), &UndoManager::canUndoChanged, this, &MapEditorController::undoStepAvailabilityChanged);
+	connect(&Settings::getInstance(), &Settings::settingsChanged, this, &MapEditorController::updateUndoSettings, Qt::UniqueConnection);
+	updateUndoSettings();
 	connect(map, &Map::objectSelectionChanged, this, &MapEditorController::objectSelectionChanged);
 	connect(map, &Map::templateAdded, this, &MapEditorController::templateAdded);
 	connect(map, &Map::templateDeleted, this, &MapEditorController::templateDeleted);
@@ -4116,6 +4134,7 @@ bool MapEditorController::importGpxFile(const QString& filename)
 bool MapEditorController::importMapFile(const QString& filename, bool show_errors)
 {
 	Map imported_map;
+	imported_map.setDataOnly(true);
 	imported_map.setScaleDenominator(map->getScaleDenominator()); // for non-scaled geodata
 	
 	auto importer = FileFormats.makeImporter(filename, imported_map, nullptr);
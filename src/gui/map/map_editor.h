@@ -364,6 +364,8 @@ public slots:
 	
 	/** Adjusts the enabled state of the undo / redo actions. */
 	void undoStepAvailabilityChanged();
+	/** Applies the undo history settings to the map's undo manager. */
+	void updateUndoSettings();
 	/** Adjusts the enabled state of the paste action (specific signature required). */
 	void clipboardChanged(QClipboard::Mode mode);
 	/** Adjusts the enabled state of the paste action. */
@@ -672,6 +674,9 @@ private:
 	MapView* main_view;
 	MapWidget* map_widget;
 	
+	/// The file which holds the map's clean state, with its journal.
+	QString journal_base_path;
+	
 	OperatingMode mode;
 	bool mobile_mode;
 	bool window_state_changed = false;
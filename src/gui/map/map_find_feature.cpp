@@ -21,6 +21,7 @@
 #include "map_find_feature.h"
 
 #include <functional>
+#include <vector>
 
 #include <QAction>
 #include <QAbstractButton>
@@ -224,9 +225,11 @@ void MapFindFeature::findAll()
 		return;
 	}
 	
-	map->getCurrentPart()->applyOnMatchingObjects([map](Object* object) {
-		map->addObjectToSelection(object, false);
+	std::vector<Object*> objects;
+	map->getCurrentPart()->applyOnMatchingObjects([&objects](Object* object) {
+		objects.push_back(object);
 	}, std::cref(query));
+	map->addObjectsToSelection(objects, false);
 	map->emitSelectionChanged();
 	controller.getWindow()->showStatusBarMessage(OpenOrienteering::TagSelectWidget::tr("%n object(s) selected", nullptr, map->getNumSelectedObjects()), 2000);
 	
@@ -21,8 +21,12 @@
 
 #include "map_widget.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <limits>
 #include <stdexcept>
+#include <utility>
 
 #include <QApplication>
 #include <QColor>
@@ -33,6 +37,7 @@
 #include <QGestureEvent>
 #include <QKeyEvent>
 #include <QLabel>
+#include <QLatin1Char>
 #include <QLatin1String>
 #include <QList>
 #include <QLocale>
@@ -42,12 +47,15 @@
 #include <QPaintEvent>
 #include <QPinchGesture>
 #include <QPixmap>
+#include <QRegion>
 #include <QResizeEvent>
 #include <QSizePolicy>
+#include <QStringList>
 #include <QTimer>
 #include <QTouchEvent>
 #include <QTransform>
 #include <QVariant>
+#include <QVector>
 #include <QWheelEvent>
 
 #include "settings.h"
@@ -65,6 +73,7 @@
 #include "templates/template.h" // IWYU pragma: keep
 #include "tools/tool.h"
 #include "util/backports.h" // IWYU pragma: keep
+#include "util/profiler.h"
 #include "util/util.h"
 
 class QGesture;
@@ -78,6 +87,49 @@ class QGesture;
 
 namespace OpenOrienteering {
 
+namespace {
+
+/// The maximum size of the cache chunks rendered in idle time, in pixels.
+constexpr int overscan_chunk_size = 256;
+
+/// The maximum number of rectangles in a cache dirty region.
+constexpr int max_dirty_rects = 16;
+
+/// The maximum accumulated subpixel misalignment of shifted caches, per axis.
+constexpr qreal max_cache_shift_error = 0.5;
+
+/// The maximum number of zoom levels with complete caches kept for reuse.
+constexpr std::size_t max_zoom_caches = 3;
+
+/**
+ * Adds a rectangle to a dirty region.
+ * 
+ * Adding many disjoint rectangles to a QRegion is quadratic, e.g. when all
+ * objects are moved. When the region gets too complex, it is replaced by its
+ * bounding rectangle.
+ */
+void addDirtyRect(QRegion& region, const QRect& rect)
+{
+	if (region.rectCount() >= max_dirty_rects)
+		region = region.boundingRect().united(rect);
+	else
+		region += rect;
+}
+
+/// Returns true if the transformations differ at most by translation.
+bool sameScaleAndRotation(const QTransform& a, const QTransform& b)
+{
+	auto const fuzzyEqual = [](qreal x, qreal y) {
+		return std::abs(x - y) <= 1e-9 * std::max({ qreal(1), std::abs(x), std::abs(y) });
+	};
+	return fuzzyEqual(a.m11(), b.m11()) && fuzzyEqual(a.m12(), b.m12())
+	       && fuzzyEqual(a.m21(), b.m21()) && fuzzyEqual(a.m22(), b.m22());
+}
+
+}  // namespace
+
+
+
 MapWidget::MapWidget(bool show_help, bool force_antialiasing, QWidget* parent)
  : QWidget(parent)
  , view(nullptr)
@@ -90,9 +142,9 @@ MapWidget::MapWidget(bool show_help, bool force_antialiasing, QWidget* parent)
  , dragging(false)
  , pinching(false)
  , pinching_factor(1.0)
- , below_template_cache_dirty_rect(rect())
- , above_template_cache_dirty_rect(rect())
- , map_cache_dirty_rect(rect())
+ , below_template_cache_dirty_region(rect())
+ , above_template_cache_dirty_region(rect())
+ , map_cache_dirty_region(rect())
  , drawing_dirty_rect_border(0)
  , activity_dirty_rect_border(0)
  , last_mouse_release_time(QTime::currentTime())
@@ -111,6 +163,14 @@ MapWidget::MapWidget(bool show_help, bool force_antialiasing, QWidget* parent)
 	setMouseTracking(true);
 	setFocusPolicy(Qt::ClickFocus);
 	setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
+	
+	overscan_timer = new QTimer(this);
+	overscan_timer->setSingleShot(true);
+	overscan_timer->setInterval(0);
+	connect(overscan_timer, &QTimer::timeout, this, &MapWidget::updateOverscan);
+	
+	applySettings();
+	connect(&Settings::getInstance(), &Settings::settingsChanged, this, &MapWidget::applySettings);
 }
 
 MapWidget::~MapWidget()
@@ -142,6 +202,8 @@ void MapWidget::setMapView(MapView* view)
 			
 			auto map = this->view->getMap();
 			map->addMapWidget(this);
+			
+			invalidateCaches();
 		}
 		
 		update();
@@ -273,13 +335,18 @@ void MapWidget::viewChanged(MapView::ChangeFlags changes)
 {
 	setDrawingBoundingBox(drawing_dirty_rect_map, drawing_dirty_rect_border, true);
 	setActivityBoundingBox(activity_dirty_rect_map, activity_dirty_rect_border, true);
-	updateEverything();
+	if (changes == MapView::CenterChange)
+		shiftCaches();
+	else
+		zoomCaches();
 	if (changes.testFlag(MapView::ZoomChange))
 		updateZoomDisplay();
 }
 
 void MapWidget::setPanOffset(const QPoint& offset)
 {
+	if (offset != QPoint())
+		pan_direction = offset - pan_offset;
 	pan_offset = offset;
 	update();
 }
@@ -431,25 +498,32 @@ void MapWidget::moveDirtyRect(QRect& dirty_rect, qreal x, qreal y)
 
 void MapWidget::markTemplateCacheDirty(const QRectF& view_rect, int pixel_border, bool front_cache)
 {
-	QRect& cache_dirty_rect = front_cache ? above_template_cache_dirty_rect : below_template_cache_dirty_rect;
+	QRegion& cache_dirty_region = front_cache ? above_template_cache_dirty_region : below_template_cache_dirty_region;
 	QRectF viewport_rect = viewToViewport(view_rect);
 	QRect integer_rect = QRect(viewport_rect.left() - (1+pixel_border), viewport_rect.top() - (1+pixel_border),
 							   viewport_rect.width() + 2*(1+pixel_border), viewport_rect.height() + 2*(1+pixel_border));
 	
-	if (!integer_rect.intersects(rect()))
+	// The caches are not affected by the pan offset.
+	auto const cache_dirty_rect = integer_rect.translated(-pan_offset).intersected(cacheRect());
+	if (cache_dirty_rect.isEmpty())
 		return;
 	
-	if (cache_dirty_rect.isValid())
-		cache_dirty_rect = cache_dirty_rect.united(integer_rect);
-	else
-		cache_dirty_rect = integer_rect;
-	
+	addDirtyRect(cache_dirty_region, cache_dirty_rect);
+	zoom_caches.clear();
 	update(integer_rect);
 }
 
 void MapWidget::markObjectAreaDirty(const QRectF& map_rect)
 {
-	updateMapRect(map_rect, 0, map_cache_dirty_rect);
+	// The caches are not affected by the pan offset.
+	QRect viewport_rect = calculateViewportBoundingBox(map_rect, 0);
+	auto const cache_dirty_rect = viewport_rect.translated(-pan_offset).intersected(cacheRect());
+	if (!cache_dirty_rect.isEmpty())
+	{
+		addDirtyRect(map_cache_dirty_region, cache_dirty_rect);
+		zoom_caches.clear();
+		update(viewport_rect);
+	}
 }
 
 void MapWidget::setDrawingBoundingBox(QRectF map_rect, int pixel_border, bool do_update)
@@ -548,20 +622,49 @@ void MapWidget::updateDrawingLaterSlot()
 
 void MapWidget::updateEverything()
 {
-	map_cache_dirty_rect = rect();
-	below_template_cache_dirty_rect = map_cache_dirty_rect;
-	above_template_cache_dirty_rect = map_cache_dirty_rect;
-	update(map_cache_dirty_rect);
+	clearZoomCache();
+	invalidateCaches();
+	update();
 }
 
 void MapWidget::updateEverythingInRect(const QRect& dirty_rect)
 {
-	rectIncludeSafe(map_cache_dirty_rect, dirty_rect);
-	rectIncludeSafe(below_template_cache_dirty_rect, dirty_rect);
-	rectIncludeSafe(above_template_cache_dirty_rect, dirty_rect);
+	auto const cache_dirty_rect = dirty_rect.translated(-pan_offset);
+	addDirtyRect(map_cache_dirty_region, cache_dirty_rect);
+	addDirtyRect(below_template_cache_dirty_region, cache_dirty_rect);
+	addDirtyRect(above_template_cache_dirty_region, cache_dirty_rect);
+	zoom_caches.clear();
 	update(dirty_rect);
 }
 
+void MapWidget::setCacheMargin(int margin)
+{
+	margin = std::max(0, margin);
+	if (margin != cache_margin)
+	{
+		cache_margin = margin;
+		clearZoomCache();
+		map_cache = QImage();
+		below_template_cache = QImage();
+		above_template_cache = QImage();
+		updateEverything();
+	}
+}
+
+void MapWidget::applySettings()
+{
+	auto& settings = Settings::getInstance();
+	setCacheMargin(settings.getSettingCached(Settings::MapDisplay_CacheOverscan).toInt());
+	
+	// The map cache is rendered with this setting, so it must be refreshed.
+	auto const detail_threshold = settings.getSettingCached(Settings::MapDisplay_LevelOfDetail).toInt();
+	if (detail_threshold != level_of_detail)
+	{
+		level_of_detail = detail_threshold;
+		updateEverything();
+	}
+}
+
 QRect MapWidget::calculateViewportBoundingBox(const QRectF& map_rect, int pixel_border) const
 {
 	QRectF view_rect = view->calculateViewBoundingBox(map_rect);
@@ -714,6 +817,33 @@ void MapWidget::showHelpMessage(QPainter* painter, const QString& text) const
 	painter->drawText(QRect(0, 0, width(), height()), Qt::AlignCenter, text);
 }
 
+void MapWidget::drawProfilerOverlay(QPainter* painter, bool take_frame)
+{
+	if (take_frame)
+	{
+		auto const frame = Profiler::takeFrame();
+		auto const ms = [](qint64 ns) { return QString::number(ns / 1000000.0, 'f', 2); };
+		
+		// Developer information, not translated
+		auto lines = QStringList { QString::fromLatin1("Frame: %1 ms").arg(ms(frame.duration)) };
+		for (auto const& scope : frame.scopes)
+		{
+			lines.push_back(QString::fromLatin1("%1: %2 ms, %3 calls, max. %4 ms")
+			                .arg(QLatin1String(scope.name), ms(scope.total), QString::number(scope.count), ms(scope.maximum)));
+		}
+		profiler_overlay_text = lines.join(QLatin1Char('\n'));
+	}
+	auto const& text = profiler_overlay_text;
+	
+	painter->save();
+	auto const flags = int(Qt::AlignLeft | Qt::AlignTop);
+	auto const text_rect = painter->boundingRect(rect().adjusted(8, 8, -8, -8), flags, text);
+	painter->fillRect(text_rect.adjusted(-4, -4, 4, 4), QColor(0, 0, 0, 160));
+	painter->setPen(Qt::white);
+	painter->drawText(text_rect, flags, text);
+	painter->restore();
+}
+
 bool MapWidget::event(QEvent* event)
 {
 	switch (event->type())
@@ -746,6 +876,8 @@ bool MapWidget::event(QEvent* event)
 
 void MapWidget::gestureEvent(QGestureEvent* event)
 {
+	Profiler::Scope profile("MapWidget::gestureEvent");
+	
 	if (tool && tool->gestureEvent(event, this))
 	{
 		event->accept();
@@ -793,115 +925,148 @@ void MapWidget::paintEvent(QPaintEvent* event)
 {
 	// Draw on the widget
 	QPainter painter(this);
-	QRect exposed = event->rect();
+	{
+		Profiler::Scope profile("MapWidget::paintEvent");
+		paintContents(&painter, event->rect());
+	}
 	
+	// The overlay must not be part of the measured time.
+	// Only full repaints count as frames. Partial repaints draw the text of
+	// the latest frame again, so that the overlay doesn't tear.
+	if (Profiler::isEnabled())
+	{
+		painter.resetTransform();
+		drawProfilerOverlay(&painter, event->rect().contains(rect()));
+	}
+}
+
+void MapWidget::paintContents(QPainter* painter, const QRect& exposed)
+{
 	if (!view)
 	{
-		painter.fillRect(exposed, QColor(Qt::gray));
+		painter->fillRect(exposed, QColor(Qt::gray));
 		return;
 	}
 	
 	// No colors, symbols, or objects? Provide a little help message ...
 	bool no_contents = view->getMap()->getNumObjects() == 0 && view->getMap()->getNumTemplates() == 0 && !view->isGridVisible();
 	
-	QTransform transform = painter.worldTransform();
+	QTransform transform = painter->worldTransform();
 	
-	// Update all dirty caches
-	// TODO: It would be an idea to do these updates in a background thread and use the old caches in the meantime
-	updateAllDirtyCaches();
+	auto const visible_rect = pinching ? rect() : rect().translated(-pan_offset);
+	if (zoom_preview_active && (pinching || !dirtyCacheRegion().intersects(visible_rect)))
+	{
+		zoom_preview_active = false;
+		zoom_preview = {};
+	}
+	
+	if (zoom_preview_active)
+	{
+		// Show the previous caches, and the parts of the caches which are
+		// already refined. The caches are refined in idle time.
+		drawZoomPreview(painter, exposed);
+		painter->setClipRegion(QRegion(visible_rect).subtracted(dirtyCacheRegion()).translated(pan_offset));
+	}
+	else
+	{
+		// Update the visible part of all dirty caches.
+		// The margin is updated in idle time, see updateOverscan().
+		updateAllDirtyCaches(visible_rect);
+	}
 	
 	QRect target = exposed;
+	QPoint cache_offset = { cache_margin, cache_margin };
 	if (pinching)
 	{
 		// Just draw the scaled map and templates
-		painter.fillRect(exposed, QColor(Qt::gray));
-		painter.translate(pinching_center.x(), pinching_center.y());
-		painter.scale(pinching_factor, pinching_factor);
-		painter.translate(-drag_start_pos.x(), -drag_start_pos.y());
+		painter->fillRect(exposed, QColor(Qt::gray));
+		painter->translate(pinching_center.x(), pinching_center.y());
+		painter->scale(pinching_factor, pinching_factor);
+		painter->translate(-drag_start_pos.x(), -drag_start_pos.y());
 	}
 	else if (pan_offset != QPoint())
 	{
-		// Background color
-		if (pan_offset.x() > 0)
-			painter.fillRect(QRect(0, pan_offset.y(), pan_offset.x(), height() - pan_offset.y()), QColor(Qt::gray));
-		else if (pan_offset.x() < 0)
-			painter.fillRect(QRect(width() + pan_offset.x(), pan_offset.y(), -pan_offset.x(), height() - pan_offset.y()), QColor(Qt::gray));
-		
-		if (pan_offset.y() > 0)
-			painter.fillRect(QRect(0, 0, width(), pan_offset.y()), QColor(Qt::gray));
-		else if (pan_offset.y() < 0)
-			painter.fillRect(QRect(0, height() + pan_offset.y(), width(), -pan_offset.y()), QColor(Qt::gray));
+		// Background color for the area not covered by the caches
+		target = exposed.intersected(cacheRect().translated(pan_offset));
+		if (target != exposed)
+			painter->fillRect(exposed, QColor(Qt::gray));
 		
-		target.translate(pan_offset);
+		cache_offset -= pan_offset;
 	}
+	QRect const source = target.translated(cache_offset);
 	
 	if (!view->areAllTemplatesHidden() && isBelowTemplateVisible() && !below_template_cache.isNull() && view->getMap()->getFirstFrontTemplate() > 0)
 	{
-		painter.drawImage(target, below_template_cache, exposed);
+		painter->drawImage(target, below_template_cache, source);
 	}
 	else if (show_help && no_contents)
 	{
-		painter.save();
-		painter.setTransform(transform);
+		painter->save();
+		painter->setTransform(transform);
 		if (view->getMap()->getNumColors() == 0)
-			showHelpMessage(&painter, tr("Empty map!\n\nStart by defining some colors:\nSelect Symbols -> Color window to\nopen the color dialog and\ndefine the colors there."));
+			showHelpMessage(painter, tr("Empty map!\n\nStart by defining some colors:\nSelect Symbols -> Color window to\nopen the color dialog and\ndefine the colors there."));
 		else if (view->getMap()->getNumSymbols() == 0)
-			showHelpMessage(&painter, tr("No symbols!\n\nNow define some symbols:\nRight-click in the symbol bar\nand select \"New symbol\"\nto create one."));
+			showHelpMessage(painter, tr("No symbols!\n\nNow define some symbols:\nRight-click in the symbol bar\nand select \"New symbol\"\nto create one."));
 		else
-			showHelpMessage(&painter, tr("Ready to draw!\n\nStart drawing or load a base map.\nTo load a base map, click\nTemplates -> Open template...") + QLatin1String("\n\n") + tr("Hint: Hold the middle mouse button to drag the map,\nzoom using the mouse wheel, if available."));
-		painter.restore();
+			showHelpMessage(painter, tr("Ready to draw!\n\nStart drawing or load a base map.\nTo load a base map, click\nTemplates -> Open template...") + QLatin1String("\n\n") + tr("Hint: Hold the middle mouse button to drag the map,\nzoom using the mouse wheel, if available."));
+		painter->restore();
 	}
 	else
 	{
-		painter.fillRect(target, Qt::white);
+		painter->fillRect(target, Qt::white);
 	}
 	
 	const auto map_visibility = view->effectiveMapVisibility();
 	if (!map_cache.isNull() && map_visibility.visible)
 	{
-		qreal saved_opacity = painter.opacity();
-		painter.setOpacity(map_visibility.opacity);
-		painter.drawImage(target, map_cache, exposed);
-		painter.setOpacity(saved_opacity);
+		qreal saved_opacity = painter->opacity();
+		painter->setOpacity(map_visibility.opacity);
+		painter->drawImage(target, map_cache, source);
+		painter->setOpacity(saved_opacity);
 	}
 	
 	if (!view->areAllTemplatesHidden() && isAboveTemplateVisible() && !above_template_cache.isNull() && view->getMap()->getNumTemplates() - view->getMap()->getFirstFrontTemplate() > 0)
-		painter.drawImage(target, above_template_cache, exposed);
+		painter->drawImage(target, above_template_cache, source);
 	
-	//painter.setClipRect(exposed);
+	painter->setClipping(false);
+	
+	//painter->setClipRect(exposed);
 	
 	// Show current drawings
 	if (activity_dirty_rect.isValid())
-		activity->draw(&painter, this);
+		activity->draw(painter, this);
 	
 	if (drawing_dirty_rect.isValid())
-		tool->draw(&painter, this);
+		tool->draw(painter, this);
 	
 	
 	// Draw temporary GPS marker display
 	if (marker_display)
-		marker_display->paint(&painter);
+		marker_display->paint(painter);
 	
 	// Draw GPS display
 	if (gps_display)
-		gps_display->paint(&painter);
+		gps_display->paint(painter);
 	
 	// Draw touch cursor
 	if (touch_cursor && tool && tool->usesTouchCursor())
-		touch_cursor->paint(&painter);
+		touch_cursor->paint(painter);
+	
 	
+	painter->setWorldTransform(transform, false);
 	
-	painter.setWorldTransform(transform, false);
+	if (!dirtyCacheRegion().isEmpty())
+		overscan_timer->start();
 }
 
 void MapWidget::resizeEvent(QResizeEvent* event)
 {
-	map_cache_dirty_rect = rect();
-	below_template_cache_dirty_rect = map_cache_dirty_rect;
-	above_template_cache_dirty_rect = map_cache_dirty_rect;
+	clearZoomCache();
+	invalidateCaches();
 	
-	if (map_cache.width() < map_cache_dirty_rect.width() ||
-	    map_cache.height() < map_cache_dirty_rect.height())
+	auto const cache_size = cacheRect().size();
+	if (map_cache.width() < cache_size.width() ||
+	    map_cache.height() < cache_size.height())
 	{
 		map_cache = QImage();
 		below_template_cache = QImage();
@@ -946,6 +1111,8 @@ void MapWidget::mousePressEvent(QMouseEvent* event)
 
 void MapWidget::_mousePressEvent(QMouseEvent* event)
 {
+	Profiler::Scope profile("MapWidget::mousePressEvent");
+	
 	if (dragging || pinching)
 	{
 		event->accept();
@@ -982,6 +1149,8 @@ void MapWidget::mouseMoveEvent(QMouseEvent* event)
 
 void MapWidget::_mouseMoveEvent(QMouseEvent* event)
 {
+	Profiler::Scope profile("MapWidget::mouseMoveEvent");
+	
 	if (pinching)
 	{
 		event->accept();
@@ -1018,6 +1187,8 @@ void MapWidget::mouseReleaseEvent(QMouseEvent* event)
 
 void MapWidget::_mouseReleaseEvent(QMouseEvent* event)
 {
+	Profiler::Scope profile("MapWidget::mouseReleaseEvent");
+	
 	if (dragging)
 	{
 		finishDragging(event->pos());
@@ -1044,6 +1215,8 @@ void MapWidget::mouseDoubleClickEvent(QMouseEvent* event)
 
 void MapWidget::_mouseDoubleClickEvent(QMouseEvent* event)
 {
+	Profiler::Scope profile("MapWidget::mouseDoubleClickEvent");
+	
 	if (tool && tool->mouseDoubleClickEvent(event, view->viewToMapF(viewportToView(event->pos())), this))
 	{
 		event->accept();
@@ -1097,6 +1270,8 @@ void MapWidget::leaveEvent(QEvent* event)
 
 bool MapWidget::keyPressEventFilter(QKeyEvent* event)
 {
+	Profiler::Scope profile("MapWidget::keyPressEvent");
+	
 	if (tool && tool->keyPressEvent(event))
 	{
 		return true;
@@ -1134,6 +1309,8 @@ bool MapWidget::keyPressEventFilter(QKeyEvent* event)
 
 bool MapWidget::keyReleaseEventFilter(QKeyEvent* event)
 {
+	Profiler::Scope profile("MapWidget::keyReleaseEvent");
+	
 	if (tool && tool->keyReleaseEvent(event))
 	{
 		return true; // NOLINT
@@ -1226,24 +1403,34 @@ bool MapWidget::isBelowTemplateVisible() const
 	return containsVisibleTemplate(0, view->getMap()->getFirstFrontTemplate() - 1);
 }
 
-void MapWidget::updateTemplateCache(QImage& cache, QRect& dirty_rect, int first_template, int last_template, bool use_background)
+QRect MapWidget::cacheRect() const
+{
+	return rect().adjusted(-cache_margin, -cache_margin, cache_margin, cache_margin);
+}
+
+void MapWidget::updateTemplateCache(QImage& cache, QRegion& dirty_region, int first_template, int last_template, bool use_background, const QRect& limit)
 {
+	Profiler::Scope profile("MapWidget::updateTemplateCache");
+	
 	Q_ASSERT(containsVisibleTemplate(first_template, last_template));
 	
+	auto const cache_rect = cacheRect();
 	if (cache.isNull())
 	{
 		// Lazy allocation of cache image
-		cache = QImage(size(), QImage::Format_ARGB32_Premultiplied);
-		dirty_rect = rect();
-	}
-	else
-	{
-		// Make sure not to use a bigger draw rect than necessary
-		dirty_rect = dirty_rect.intersected(rect());
+		cache = QImage(cache_rect.size(), QImage::Format_ARGB32_Premultiplied);
+		dirty_region = cache_rect;
 	}
-		
+	
+	// Make sure not to use a bigger draw rect than necessary
+	auto const dirty_rect = dirty_region.intersected(limit.intersected(cache_rect)).boundingRect();
+	if (dirty_rect.isEmpty())
+		return;
+	dirty_region -= dirty_rect;
+	
 	// Start drawing
 	QPainter painter(&cache);
+	painter.translate(-cache_rect.topLeft());
 	painter.setClipRect(dirty_rect);
 	
 	// Fill with background color (TODO: make configurable)
@@ -1262,42 +1449,45 @@ void MapWidget::updateTemplateCache(QImage& cache, QRect& dirty_rect, int first_
 	painter.setWorldTransform(view->worldTransform(), true);
 	
 	Map* map = view->getMap();
-	QRectF map_view_rect = view->calculateViewedRect(viewportToView(dirty_rect));
+	QRectF map_view_rect = view->calculateViewedRect(QRectF(dirty_rect).translated(-width() / 2.0, -height() / 2.0));
 	
 	map->drawTemplates(&painter, map_view_rect, first_template, last_template, view, true);
-	
-	dirty_rect.setWidth(-1); // => !dirty_rect.isValid()
 }
 
-void MapWidget::updateMapCache(bool use_background)
+void MapWidget::updateMapCache(bool use_background, const QRect& limit)
 {
+	Profiler::Scope profile("MapWidget::updateMapCache");
+	
+	auto const cache_rect = cacheRect();
 	if (map_cache.isNull())
 	{
 		// Lazy allocation of cache image
-		map_cache = QImage(size(), QImage::Format_ARGB32_Premultiplied);
-		map_cache_dirty_rect = rect();
-	}
-	else
-	{
-		// Make sure not to use a bigger draw rect than necessary
-		map_cache_dirty_rect = map_cache_dirty_rect.intersected(rect());
+		map_cache = QImage(cache_rect.size(), QImage::Format_ARGB32_Premultiplied);
+		map_cache_dirty_region = cache_rect;
 	}
 	
+	// Make sure not to use a bigger draw rect than necessary
+	auto const dirty_rect = map_cache_dirty_region.intersected(limit.intersected(cache_rect)).boundingRect();
+	if (dirty_rect.isEmpty())
+		return;
+	map_cache_dirty_region -= dirty_rect;
+	
 	// Start drawing
 	QPainter painter;
 	painter.begin(&map_cache);
-	painter.setClipRect(map_cache_dirty_rect);
+	painter.translate(-cache_rect.topLeft());
+	painter.setClipRect(dirty_rect);
 	
 	// Fill with background color (TODO: make configurable)
 	if (use_background)
 	{
-		painter.fillRect(map_cache_dirty_rect, Qt::white);
+		painter.fillRect(dirty_rect, Qt::white);
 	}
 	else
 	{
 		QPainter::CompositionMode mode = painter.compositionMode();
 		painter.setCompositionMode(QPainter::CompositionMode_Clear);
-		painter.fillRect(map_cache_dirty_rect, Qt::transparent);
+		painter.fillRect(dirty_rect, Qt::transparent);
 		painter.setCompositionMode(mode);
 	}
 	
@@ -1309,9 +1499,10 @@ void MapWidget::updateMapCache(bool use_background)
 		options |= RenderConfig::DisableAntialiasing | RenderConfig::ForceMinSize;
 		
 	Map* map = view->getMap();
-	QRectF map_view_rect = view->calculateViewedRect(viewportToView(map_cache_dirty_rect));
+	QRectF map_view_rect = view->calculateViewedRect(QRectF(dirty_rect).translated(-width() / 2.0, -height() / 2.0));
 
 	RenderConfig config = { *map, map_view_rect, view->calculateFinalZoomFactor(), options, 1.0 };
+	config.level_of_detail = level_of_detail;
 	
 	painter.translate(width() / 2.0, height() / 2.0);
 	painter.setWorldTransform(view->worldTransform(), true);
@@ -1327,23 +1518,242 @@ void MapWidget::updateMapCache(bool use_background)
 	
 	// Finish drawing
 	painter.end();
+}
+
+void MapWidget::updateAllDirtyCaches(const QRect& limit)
+{
+	if (!map_cache_dirty_region.isEmpty())
+		updateMapCache(false, limit);
 	
-	map_cache_dirty_rect.setWidth(-1); // => !map_cache_dirty_rect.isValid()
+	if (!view->areAllTemplatesHidden())
+	{
+		if (!below_template_cache_dirty_region.isEmpty() && isBelowTemplateVisible())
+			updateTemplateCache(below_template_cache, below_template_cache_dirty_region, 0, view->getMap()->getFirstFrontTemplate() - 1, true, limit);
+		
+		if (!above_template_cache_dirty_region.isEmpty() && isAboveTemplateVisible())
+			updateTemplateCache(above_template_cache, above_template_cache_dirty_region, view->getMap()->getFirstFrontTemplate(), view->getMap()->getNumTemplates() - 1, false, limit);
+	}
 }
 
-void MapWidget::updateAllDirtyCaches()
+QRegion MapWidget::dirtyCacheRegion() const
 {
-	if (map_cache_dirty_rect.isValid())
-		updateMapCache(false);
+	if (!view)
+		return {};
 	
+	auto region = map_cache_dirty_region;
 	if (!view->areAllTemplatesHidden())
 	{
-		if (below_template_cache_dirty_rect.isValid() && isBelowTemplateVisible())
-			updateTemplateCache(below_template_cache, below_template_cache_dirty_rect, 0, view->getMap()->getFirstFrontTemplate() - 1, true);
+		if (isBelowTemplateVisible())
+			region += below_template_cache_dirty_region;
+		if (isAboveTemplateVisible())
+			region += above_template_cache_dirty_region;
+	}
+	return region.intersected(cacheRect());
+}
+
+void MapWidget::invalidateCaches()
+{
+	auto const cache_rect = cacheRect();
+	map_cache_dirty_region = cache_rect;
+	below_template_cache_dirty_region = cache_rect;
+	above_template_cache_dirty_region = cache_rect;
+	if (view)
+		cache_transform = view->worldTransform();
+	cache_shift_error = {};
+}
+
+void MapWidget::shiftCaches()
+{
+	// With unchanged zoom and rotation, the transformations differ only by translation.
+	auto const transform = view->worldTransform();
+	auto const delta = transform.map(QPointF{}) - cache_transform.map(QPointF{});
+	auto const shift = delta.toPoint();
+	auto const cache_rect = cacheRect();
+	cache_shift_error += delta - QPointF(shift);
+	// A single shift is off by at most half a pixel per axis, like any
+	// rendering which snaps to the pixel grid. So only the accumulation
+	// of errors from repeated shifts requires a full update.
+	if (std::abs(shift.x()) >= cache_rect.width()
+	    || std::abs(shift.y()) >= cache_rect.height()
+	    || std::abs(cache_shift_error.x()) > max_cache_shift_error
+	    || std::abs(cache_shift_error.y()) > max_cache_shift_error)
+	{
+		invalidateCaches();
+		update();
+		return;
+	}
+	
+	cache_transform = transform;
+	if (shift.isNull())
+		return;
+	
+	auto const exposed = QRegion(cache_rect).subtracted(cache_rect.translated(shift));
+	auto const shift_region = [&](QRegion& region) {
+		region.translate(shift);
+		region = region.intersected(cache_rect).united(exposed);
+	};
+	shiftCache(shift.x(), shift.y(), map_cache);
+	shift_region(map_cache_dirty_region);
+	shiftCache(shift.x(), shift.y(), below_template_cache);
+	shift_region(below_template_cache_dirty_region);
+	shiftCache(shift.x(), shift.y(), above_template_cache);
+	shift_region(above_template_cache_dirty_region);
+	update();
+}
+
+void MapWidget::updateOverscan()
+{
+	auto const region = dirtyCacheRegion();
+	if (region.isEmpty())
+		return;
+	
+	// Prefer the part of the margin which would be exposed by continued
+	// panning in the same direction, otherwise the part closest to the viewport.
+	auto const center = rect().center();
+	auto const direction = -pan_direction;
+	auto best_rect = QRect{};
+	auto best_score = std::numeric_limits<qreal>::lowest();
+	for (auto const& candidate : region.rects())
+	{
+		auto const offset = candidate.center() - center;
+		auto const score = direction.isNull()
+		                   ? -qreal(offset.manhattanLength())
+		                   : qreal(QPoint::dotProduct(offset, direction)) / direction.manhattanLength();
+		if (score > best_score)
+		{
+			best_score = score;
+			best_rect = candidate;
+		}
+	}
+	
+	// Render a limited chunk next to the point of the rect closest to the viewport.
+	auto const anchor = QPoint{ qBound(best_rect.left(), center.x(), best_rect.right()),
+	                            qBound(best_rect.top(), center.y(), best_rect.bottom()) };
+	auto chunk = QRect{ 0, 0, overscan_chunk_size, overscan_chunk_size };
+	chunk.moveCenter(anchor);
+	chunk = chunk.intersected(best_rect);
+	updateAllDirtyCaches(chunk);
+	
+	// Outside of the zoom preview, visible parts are updated when painting.
+	if (zoom_preview_active)
+		update(chunk.translated(pan_offset));
+	
+	if (!dirtyCacheRegion().isEmpty())
+		overscan_timer->start();
+}
+
+void MapWidget::zoomCaches()
+{
+	auto const dirty_region = dirtyCacheRegion();
+	auto const visible_complete = !dirty_region.intersects(rect().translated(-pan_offset));
+	
+	// The images are moved instead of shared. Otherwise rendering to the
+	// new caches would detach, i.e. copy, each image first.
+	auto previous = CacheSnapshot { cache_transform, std::move(below_template_cache), std::move(map_cache), std::move(above_template_cache) };
+	below_template_cache = {};
+	map_cache = {};
+	above_template_cache = {};
+	
+	// Refine from the center
+	pan_direction = {};
+	
+	auto const& transform = view->worldTransform();
+	auto const cached = std::find_if(begin(zoom_caches), end(zoom_caches), [&transform](const CacheSnapshot& snapshot) {
+		return sameScaleAndRotation(snapshot.transform, transform);
+	});
+	if (cached != end(zoom_caches))
+	{
+		// Reuse complete caches, adjusting them for a changed center
+		auto snapshot = std::move(*cached);
+		zoom_caches.erase(cached);
+		below_template_cache = std::move(snapshot.below_template_cache);
+		map_cache = std::move(snapshot.map_cache);
+		above_template_cache = std::move(snapshot.above_template_cache);
+		below_template_cache_dirty_region = {};
+		map_cache_dirty_region = {};
+		above_template_cache_dirty_region = {};
+		cache_transform = snapshot.transform;
+		cache_shift_error = {};
 		
-		if (above_template_cache_dirty_rect.isValid() && isAboveTemplateVisible())
-			updateTemplateCache(above_template_cache, above_template_cache_dirty_rect, view->getMap()->getFirstFrontTemplate(), view->getMap()->getNumTemplates() - 1, false);
+		// Visible parts are rendered when painting, so no preview is needed.
+		zoom_preview = {};
+		zoom_preview_active = false;
+		if (!previous.map_cache.isNull() && dirty_region.isEmpty())
+			keepZoomCache(std::move(previous));  // for zooming back again
+		
+		shiftCaches();
+	}
+	else
+	{
+		if (!previous.map_cache.isNull())
+		{
+			// The preview shares the images with the zoom cache.
+			if (dirty_region.isEmpty())
+				keepZoomCache(previous);
+			
+			// Otherwise the previous preview is kept
+			if (visible_complete)
+			{
+				zoom_preview = std::move(previous);
+				zoom_preview_active = true;
+			}
+		}
+		invalidateCaches();
+	}
+	
+	update();
+	if (zoom_preview_active)
+		overscan_timer->start();
+}
+
+void MapWidget::keepZoomCache(CacheSnapshot snapshot)
+{
+	zoom_caches.push_front(std::move(snapshot));
+	if (zoom_caches.size() > max_zoom_caches)
+		zoom_caches.pop_back();
+}
+
+void MapWidget::clearZoomCache()
+{
+	zoom_caches.clear();
+	zoom_preview = {};
+	zoom_preview_active = false;
+}
+
+void MapWidget::drawZoomPreview(QPainter* painter, const QRect& exposed) const
+{
+	painter->fillRect(exposed, QColor(Qt::gray));
+	
+	// From preview cache pixels to the current viewport
+	auto const center = QPointF{ width() / 2.0, height() / 2.0 };
+	auto const origin = center + QPointF(cache_margin, cache_margin);
+	auto const transform = QTransform::fromTranslate(-origin.x(), -origin.y())
+	                       * zoom_preview.transform.inverted()
+	                       * view->worldTransform()
+	                       * QTransform::fromTranslate(center.x() + pan_offset.x(), center.y() + pan_offset.y());
+	
+	painter->save();
+	painter->setClipRect(exposed);
+	painter->setWorldTransform(transform, true);
+	
+	auto const templates_visible = !view->areAllTemplatesHidden();
+	if (templates_visible && isBelowTemplateVisible() && !zoom_preview.below_template_cache.isNull())
+		painter->drawImage(0, 0, zoom_preview.below_template_cache);
+	else
+		painter->fillRect(QRect{ QPoint{}, cacheRect().size() }, Qt::white);
+	
+	const auto map_visibility = view->effectiveMapVisibility();
+	if (!zoom_preview.map_cache.isNull() && map_visibility.visible)
+	{
+		painter->setOpacity(map_visibility.opacity);
+		painter->drawImage(0, 0, zoom_preview.map_cache);
+		painter->setOpacity(1.0);
 	}
+	
+	if (templates_visible && isAboveTemplateVisible() && !zoom_preview.above_template_cache.isNull())
+		painter->drawImage(0, 0, zoom_preview.above_template_cache);
+	
+	painter->restore();
 }
 
 void MapWidget::shiftCache(int sx, int sy, QImage& cache)
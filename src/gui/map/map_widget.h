@@ -22,6 +22,7 @@
 #ifndef OPENORIENTEERING_MAP_WIDGET_H
 #define OPENORIENTEERING_MAP_WIDGET_H
 
+#include <deque>
 #include <functional>
 
 #include <Qt>
@@ -33,10 +34,12 @@
 #include <QPointF>
 #include <QRect>
 #include <QRectF>
+#include <QRegion>
 #include <QScopedPointer>
 #include <QSize>
 #include <QString>
 #include <QTime>
+#include <QTransform>
 #include <QVariant>
 #include <QWidget>
 
@@ -55,6 +58,7 @@ class QPaintEvent;
 class QPainter;
 class QPixmap;
 class QResizeEvent;
+class QTimer;
 class QWheelEvent;
 
 namespace OpenOrienteering {
@@ -72,8 +76,17 @@ class TouchCursor;
  * the view properties.
  * 
  * For faster display, the widget keeps some cached image internally which
- * are of the same size as the widget area. If then for example the map changes,
- * the other caches do not need to be redrawn.
+ * cover the widget area plus a configurable margin (overscan). If then for
+ * example the map changes, the other caches do not need to be redrawn.
+ * The visible part of the caches is redrawn synchronously when painting,
+ * the margin is filled in idle time, starting in the direction of recent
+ * panning. When the view is only moved, the caches are shifted, so that
+ * panning rarely needs to wait for rendering.
+ * 
+ * When the zoom or rotation changes, the previous caches are displayed
+ * transformed to the new view (zoom preview) while the caches are refined
+ * progressively. Complete caches of the three most recently used other
+ * zoom levels are kept, so that zooming back and forth can reuse them.
  * <ul>
  * <li>The <b>map cache</b> contains the currently visible part of the map</li>
  * <li>The <b>below template cache</b> contains the currently
@@ -291,6 +304,19 @@ public:
 	 */
 	void updateEverythingInRect(const QRect& dirty_rect);
 	
+	/**
+	 * Returns the width of the cache margin around the viewport, in pixels.
+	 */
+	int cacheMargin() const;
+	
+	/**
+	 * Sets the width of the cache margin around the viewport, in pixels.
+	 * 
+	 * A larger margin allows panning without waiting for rendering,
+	 * at the cost of memory and idle-time rendering.
+	 */
+	void setCacheMargin(int margin);
+	
 	/**
 	 * Sets the function which will be called to display zoom information.
 	 */
@@ -359,6 +385,12 @@ signals:
 private slots:
 	void updateDrawingLaterSlot();
 	
+	/** Renders a chunk of the dirty cache margin, and reschedules itself. */
+	void updateOverscan();
+	
+	/** Applies the cache margin setting. */
+	void applySettings();
+	
 protected:
 	bool event(QEvent *event) override;
 	
@@ -393,24 +425,60 @@ private:
 	bool isAboveTemplateVisible() const;
 	/** Checks if there is any visible template below the map. */
 	bool isBelowTemplateVisible() const;
+	/**
+	 * Returns the area covered by the caches, in viewport coordinates.
+	 */
+	QRect cacheRect() const;
 	/**
 	 * Redraws the template cache.
 	 * @param cache Reference to pointer to the cache.
-	 * @param dirty_rect Rectangle of the cache to redraw, in viewport coordinates.
+	 * @param dirty_region Region of the cache to redraw, in viewport coordinates.
 	 * @param first_template Lowest template index to draw.
 	 * @param last_template Highest template index to draw.
 	 * @param use_background If set to true, fills the cache with white before
 	 *     drawing the templates, else makes it transparent.
+	 * @param limit Only the part of the dirty region inside this rect is redrawn.
 	 */
-	void updateTemplateCache(QImage& cache, QRect& dirty_rect, int first_template, int last_template, bool use_background);
+	void updateTemplateCache(QImage& cache, QRegion& dirty_region, int first_template, int last_template, bool use_background, const QRect& limit);
 	/**
-	 * Redraws the map cache in the map cache dirty rect.
+	 * Redraws the map cache in the map cache dirty region.
 	 * @param use_background If set to true, fills the cache with white before
 	 *     drawing the map, else makes it transparent.
+	 * @param limit Only the part of the dirty region inside this rect is redrawn.
+	 */
+	void updateMapCache(bool use_background, const QRect& limit);
+	/** Redraws the dirty parts of all caches inside the given viewport rect. */
+	void updateAllDirtyCaches(const QRect& limit);
+	/** Returns the union of the dirty regions of all caches which are in use. */
+	QRegion dirtyCacheRegion() const;
+	/** Marks all caches as dirty. */
+	void invalidateCaches();
+	/**
+	 * Shifts the caches after the view was moved without changing zoom or rotation.
+	 * Falls back to invalidating the caches when the offset is too large.
+	 */
+	void shiftCaches();
+	
+	/** Cache images for a particular view transformation. */
+	struct CacheSnapshot
+	{
+		QTransform transform;
+		QImage below_template_cache;
+		QImage map_cache;
+		QImage above_template_cache;
+	};
+
+	/**
+	 * Updates the caches after the zoom or rotation was changed.
+	 * Sets up the zoom preview, or reuses the caches of an earlier zoom level.
 	 */
-	void updateMapCache(bool use_background);
-	/** Redraws all dirty caches. */
-	void updateAllDirtyCaches();
+	void zoomCaches();
+	/** Keeps complete caches for reuse, dropping the least recently used ones. */
+	void keepZoomCache(CacheSnapshot snapshot);
+	/** Discards the zoom preview and the caches of other zoom levels. */
+	void clearZoomCache();
+	/** Draws the zoom preview, transformed to the current view. */
+	void drawZoomPreview(QPainter* painter, const QRect& exposed) const;
 	/** Shifts the content in the cache by the given amount of pixels. */
 	void shiftCache(int sx, int sy, QImage& cache);
 	void shiftCache(int sx, int sy, QPixmap& cache);
@@ -450,9 +518,21 @@ private:
 	/** Moves the map a given number of big "steps" in x and/or y direction. */
 	void moveMap(int steps_x, int steps_y);
 	
+	/** Draws the widget's content, for paintEvent(). */
+	void paintContents(QPainter* painter, const QRect& exposed);
+	
 	/** Draws a help message at the center of the MapWidget. */
 	void showHelpMessage(QPainter* painter, const QString& text) const;
 	
+	/**
+	 * Draws the profiler statistics.
+	 * 
+	 * When take_frame is true, this takes the statistics since the previous
+	 * frame, and starts a new profiler frame. Otherwise, the statistics of
+	 * the previous frame are drawn again.
+	 */
+	void drawProfilerOverlay(QPainter* painter, bool take_frame);
+	
 	/**
 	 * Updates the content of the zoom display.
 	 * 
@@ -490,18 +570,46 @@ private:
 	// Panning (operation)
 	QPoint pan_offset;
 	
+	/** The direction of the most recent change of the pan offset. */
+	QPoint pan_direction;
+	
 	// Template caches
 	/** Cache for templates below map layer */
 	QImage below_template_cache;
-	QRect below_template_cache_dirty_rect;
+	QRegion below_template_cache_dirty_region;
 	
 	/** Cache for templates above map layer */
 	QImage above_template_cache;
-	QRect above_template_cache_dirty_rect;
+	QRegion above_template_cache_dirty_region;
 	
 	/** Map layer cache  */
 	QImage map_cache;
-	QRect map_cache_dirty_rect;
+	QRegion map_cache_dirty_region;
+	
+	/** Width of the cache margin around the viewport, in pixels. */
+	int cache_margin = 0;
+	
+	/** The last known level of detail setting, in pixels. */
+	int level_of_detail = 0;
+	
+	/** The view transformation which the caches' content is aligned to. */
+	QTransform cache_transform;
+	
+	/** Accumulated rounding error from shifting the caches, in pixels. */
+	QPointF cache_shift_error;
+	
+	/** Triggers rendering of the cache margin in idle time. */
+	QTimer* overscan_timer;
+	
+	/** Complete caches of other zoom levels, most recently used first. */
+	std::deque<CacheSnapshot> zoom_caches;
+	
+	/** The caches from before the latest zoom change, shown while rendering. */
+	CacheSnapshot zoom_preview;
+	bool zoom_preview_active = false;
+	
+	/** The text of the profiler overlay for the latest frame. */
+	QString profiler_overlay_text;
 	
 	// Dirty regions for drawings (tools) and activities
 	/** Dirty rect for the current tool, in viewport coordinates (pixels). */
@@ -569,6 +677,12 @@ QPoint MapWidget::panOffset() const
 	return pan_offset;
 }
 
+inline
+int MapWidget::cacheMargin() const
+{
+	return cache_margin;
+}
+
 inline
 MapWidget::CoordsType MapWidget::getCoordsDisplay() const
 {
@@ -32,6 +32,7 @@
 #include <QWidget>
 
 #include "settings.h"
+#include "core/symbols/symbol.h"
 #include "gui/modifier_key.h"
 #include "gui/util_gui.h"
 #include "gui/widgets/settings_page.h"
@@ -61,6 +62,15 @@ EditorSettingsPage::EditorSettingsPage(QWidget* parent)
 	text_antialiasing->setToolTip(tr("Antialiasing makes the map look much better, but also slows down the map display"));
 	layout->addRow(text_antialiasing);
 	
+	cache_overscan = Util::SpinBox::create(0, 2048, tr("px"), 64);
+	cache_overscan->setToolTip(tr("Pre-rendering the map around the visible area makes panning smoother, but needs more memory"));
+	layout->addRow(tr("Map display margin:"), cache_overscan);
+	
+	level_of_detail = Util::SpinBox::create(0, Symbol::max_level_of_detail, tr("px"));
+	level_of_detail->setSpecialValueText(tr("Off"));
+	level_of_detail->setToolTip(tr("Dashes and patterns which are smaller than this are simplified on screen"));
+	layout->addRow(tr("Simplify details below:"), level_of_detail);
+	
 	tolerance = Util::SpinBox::create(0, 50, tr("mm", "millimeters"));
 	layout->addRow(tr("Click tolerance:"), tolerance);
 	
@@ -132,6 +142,8 @@ void EditorSettingsPage::apply()
 	setSetting(Settings::SymbolWidget_IconSizeMM, icon_size->value());
 	setSetting(Settings::MapDisplay_Antialiasing, antialiasing->isChecked());
 	setSetting(Settings::MapDisplay_TextAntialiasing, text_antialiasing->isChecked());
+	setSetting(Settings::MapDisplay_CacheOverscan, cache_overscan->value());
+	setSetting(Settings::MapDisplay_LevelOfDetail, level_of_detail->value());
 	setSetting(Settings::MapEditor_ClickToleranceMM, tolerance->value());
 	setSetting(Settings::MapEditor_SnapDistanceMM, snap_distance->value());
 	setSetting(Settings::MapEditor_FixedAngleStepping, fixed_angle_stepping->value());
@@ -158,6 +170,8 @@ void EditorSettingsPage::updateWidgets()
 	antialiasing->setChecked(getSetting(Settings::MapDisplay_Antialiasing).toBool());
 	text_antialiasing->setEnabled(antialiasing->isChecked());
 	text_antialiasing->setChecked(getSetting(Settings::MapDisplay_TextAntialiasing).toBool());
+	cache_overscan->setValue(getSetting(Settings::MapDisplay_CacheOverscan).toInt());
+	level_of_detail->setValue(getSetting(Settings::MapDisplay_LevelOfDetail).toInt());
 	tolerance->setValue(getSetting(Settings::MapEditor_ClickToleranceMM).toInt());
 	snap_distance->setValue(getSetting(Settings::MapEditor_SnapDistanceMM).toInt());
 	fixed_angle_stepping->setValue(getSetting(Settings::MapEditor_FixedAngleStepping).toInt());
@@ -57,6 +57,8 @@ private:
 	QSpinBox* icon_size;
 	QCheckBox* antialiasing;
 	QCheckBox* text_antialiasing;
+	QSpinBox* cache_overscan;
+	QSpinBox* level_of_detail;
 	QSpinBox* tolerance;
 	QSpinBox* snap_distance;
 	QDoubleSpinBox* fixed_angle_stepping;
@@ -119,6 +119,16 @@ GeneralSettingsPage::GeneralSettingsPage(QWidget* parent)
 	tips_visible_check = new QCheckBox(::OpenOrienteering::AbstractHomeScreenWidget::tr("Show tip of the day"));
 	layout->addRow(tips_visible_check);
 	
+	layout->addItem(Util::SpacerItem::create(this));
+	layout->addRow(Util::Headline::create(tr("Undo history")));
+	
+	undo_memory_limit_edit = Util::SpinBox::create(0, 65536, tr("MiB", "unit mebibyte"), 64);
+	undo_memory_limit_edit->setSpecialValueText(tr("Unlimited"));
+	layout->addRow(tr("Memory limit:"), undo_memory_limit_edit);
+	
+	undo_spill_check = new QCheckBox(tr("Keep older steps in a temporary file"));
+	layout->addRow(undo_spill_check);
+	
 	layout->addItem(Util::SpacerItem::create(this));
 	layout->addRow(Util::Headline::create(tr("Saving files")));
 	
@@ -133,6 +143,9 @@ GeneralSettingsPage::GeneralSettingsPage(QWidget* parent)
 	undo_check = new QCheckBox(tr("Save undo/redo history"));
 	layout->addRow(undo_check);
 	
+	journal_check = new QCheckBox(tr("Save changes to objects incrementally in a journal file"));
+	layout->addRow(journal_check);
+	
 	autosave_check = new QCheckBox(tr("Save information for automatic recovery"));
 	layout->addRow(autosave_check);
 	
@@ -227,6 +240,9 @@ void GeneralSettingsPage::apply()
 	setSetting(Settings::HomeScreen_TipsVisible, tips_visible_check->isChecked());
 	setSetting(Settings::General_RetainCompatiblity, compatibility_check->isChecked());
 	setSetting(Settings::General_SaveUndoRedo, undo_check->isChecked());
+	setSetting(Settings::General_SaveJournal, journal_check->isChecked());
+	setSetting(Settings::General_UndoMemoryLimitMB, undo_memory_limit_edit->value());
+	setSetting(Settings::General_UndoSpillToTemporaryFile, undo_spill_check->isChecked());
 	setSetting(Settings::General_PixelsPerInch, ppi_edit->value());
 	
 	auto encoding = encoding_box->currentText().toLatin1();
@@ -287,6 +303,9 @@ void GeneralSettingsPage::updateWidgets()
 	tips_visible_check->setChecked(getSetting(Settings::HomeScreen_TipsVisible).toBool());
 	compatibility_check->setChecked(getSetting(Settings::General_RetainCompatiblity).toBool());
 	undo_check->setChecked(getSetting(Settings::General_SaveUndoRedo).toBool());
+	journal_check->setChecked(getSetting(Settings::General_SaveJournal).toBool());
+	undo_memory_limit_edit->setValue(getSetting(Settings::General_UndoMemoryLimitMB).toInt());
+	undo_spill_check->setChecked(getSetting(Settings::General_UndoSpillToTemporaryFile).toBool());
 	int autosave_interval = getSetting(Settings::General_AutosaveInterval).toInt();
 	autosave_check->setChecked(autosave_interval > 0);
 	autosave_interval_edit->setEnabled(autosave_interval > 0);
@@ -83,8 +83,12 @@ private:
 	QCheckBox* open_mru_check;
 	QCheckBox* tips_visible_check;
 	
+	QSpinBox*  undo_memory_limit_edit;
+	QCheckBox* undo_spill_check;
+	
 	QCheckBox* compatibility_check;
 	QCheckBox* undo_check;
+	QCheckBox* journal_check;
 	QCheckBox* autosave_check;
 	QSpinBox*  autosave_interval_edit;
 	
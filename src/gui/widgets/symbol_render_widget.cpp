@@ -21,6 +21,8 @@
 
 #include "symbol_render_widget.h"
 
+#include <vector>
+
 #include <QApplication>
 #include <QBuffer>
 #include <QClipboard>
@@ -469,28 +471,31 @@ void SymbolRenderWidget::paintEvent(QPaintEvent* event)
 {
 	QRect event_rect = event->rect().adjusted(-icon_size, -icon_size, 0, 0);
 	
-	QPainter painter(this);
-	painter.setPen(Qt::gray);
-	
-	int x = 0;
-	int y = 0;
+	// Render the missing icons of the exposed symbols in a single batch.
+	auto exposed = std::vector<int>();
+	auto exposed_symbols = std::vector<const Symbol*>();
 	for (int i = 0; i < map->getNumSymbols(); ++i)
 	{
-		if (event_rect.contains(x,y))
-		{
-			painter.save();
-			painter.translate(x, y);
-			drawIcon(painter, i);
-			painter.restore();
-		}
-		
-		x += icon_size;
-		if (x >= icons_per_row * icon_size)
+		auto pos = iconPosition(i);
+		if (event_rect.contains(pos.x(), pos.y()))
 		{
-			x = 0;
-			y +=  icon_size;
+			exposed.push_back(i);
+			exposed_symbols.push_back(map->getSymbol(i));
 		}
 	}
+	Symbol::prepareIcons(*map, exposed_symbols);
+	
+	QPainter painter(this);
+	painter.setPen(Qt::gray);
+	
+	for (auto i : exposed)
+	{
+		auto pos = iconPosition(i);
+		painter.save();
+		painter.translate(pos.x(), pos.y());
+		drawIcon(painter, i);
+		painter.restore();
+	}
 	
 	// Drop indicator?
 	if (last_drop_pos >= 0 && last_drop_row >= 0)
@@ -50,9 +50,11 @@
 #include "global.h"
 #include "mapper_config.h"
 #include "mapper_resource.h"
+#include "fileformats/batch_converter.h"
 #include "gui/home_screen_controller.h"
 #include "gui/main_window.h"
 #include "gui/widgets/mapper_proxystyle.h"
+#include "util/profiler.h"
 #include "util/recording_translator.h"  // IWYU pragma: keep
 #include "util/translation_util.h"
 
@@ -110,8 +112,38 @@ void resetActivationWindow(QtSingleApplication& app)
 #endif
 
 
+/**
+ * Runs the headless batch converter.
+ * 
+ * This mode neither opens windows nor interacts with a running instance.
+ */
+int convertFiles(int argc, char** argv)
+{
+	BatchConverter::prepareEnvironment();
+	QApplication qapp(argc, argv);
+	
+	Q_INIT_RESOURCE(resources);
+	
+	QCoreApplication::setOrganizationName(QString::fromLatin1("OpenOrienteering.org"));
+	QCoreApplication::setApplicationName(QString::fromLatin1("Mapper"));
+	
+	MapperResource::setSeachPaths();
+	
+	// Avoid numeric issues in libraries such as GDAL
+	setlocale(LC_NUMERIC, "C");
+	
+	doStaticInitializations();
+	Profiler::setupFromEnvironment();
+	
+	return BatchConverter::exec(QCoreApplication::arguments());
+}
+
+
 int main(int argc, char** argv)
 {
+	if (BatchConverter::isRequested(argc, argv))
+		return convertFiles(argc, argv);
+	
 #ifdef MAPPER_USE_QTSINGLEAPPLICATION
 	// Create single-instance application.
 	// Use "oo-mapper" instead of the executable as identifier, in case we launch from different paths.
@@ -175,6 +207,7 @@ int main(int argc, char** argv)
 	
 	// Initialize static things like the file format registry.
 	doStaticInitializations();
+	Profiler::setupFromEnvironment();
 	
 	auto const palette = QApplication::palette();
 	QApplication::setStyle(new MapperProxyStyle());
@@ -124,6 +124,8 @@ Settings::Settings()
 		ppi = QGuiApplication::primaryScreen()->logicalDotsPerInch();
 	
 	registerSetting(MapDisplay_TextAntialiasing, "MapDisplay/text_antialiasing", false);
+	registerSetting(MapDisplay_CacheOverscan, "MapDisplay/cache_overscan", 256); // unit: pixels
+	registerSetting(MapDisplay_LevelOfDetail, "MapDisplay/level_of_detail", 0); // unit: pixels, 0: off
 	registerSetting(MapEditor_ClickToleranceMM, "MapEditor/click_tolerance_mm", map_editor_click_tolerance_default);
 	registerSetting(MapEditor_SnapDistanceMM, "MapEditor/snap_distance_mm", map_editor_snap_distance_default);
 	registerSetting(MapEditor_FixedAngleStepping, "MapEditor/fixed_angle_stepping", 15);
@@ -146,6 +148,9 @@ Settings::Settings()
 	
 	registerSetting(General_RetainCompatiblity, "retainCompatiblity", false);
 	registerSetting(General_SaveUndoRedo, "saveUndoRedo", true);
+	registerSetting(General_SaveJournal, "saveJournal", false);
+	registerSetting(General_UndoMemoryLimitMB, "undoMemoryLimit", 512); // unit: MiB, 0 = unlimited
+	registerSetting(General_UndoSpillToTemporaryFile, "undoSpillToTemporaryFile", true);
 	registerSetting(General_AutosaveInterval, "autosave", 15); // unit: minutes
 	registerSetting(General_Language, "language", QLocale::system().name().left(2));
 	registerSetting(General_PixelsPerInch, "pixelsPerInch", ppi);
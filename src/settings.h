@@ -45,6 +45,8 @@ public:
 	{
 		MapDisplay_Antialiasing = 0,
 		MapDisplay_TextAntialiasing,
+		MapDisplay_CacheOverscan,
+		MapDisplay_LevelOfDetail,
 		MapEditor_ClickToleranceMM,
 		MapEditor_SnapDistanceMM,
 		MapEditor_FixedAngleStepping,
@@ -62,6 +64,9 @@ public:
 		ActionGridBar_ButtonSizeMM,
 		General_RetainCompatiblity,
 		General_SaveUndoRedo,
+		General_SaveJournal,
+		General_UndoMemoryLimitMB,
+		General_UndoSpillToTemporaryFile,
 		General_AutosaveInterval,
 		General_Language,
 		General_PixelsPerInch,
@@ -24,6 +24,7 @@
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include <QRectF>
 
@@ -146,14 +147,23 @@ bool ObjectSelector::selectBox(const MapCoordF& corner1, const MapCoordF& corner
 		map->clearObjectSelection(false);
 	}
 	
-	auto size = objects.size();
-	for (std::size_t i = 0; i < size; ++i)
+	if (!objects.empty())
 	{
 		if (toggle)
-			map->toggleObjectSelection(objects[i], i == size - 1);
+		{
+			auto first_unselected = std::stable_partition(begin(objects), end(objects), [this](const Object* object) {
+				return map->isObjectSelected(object);
+			});
+			std::vector<Object*> unselected(first_unselected, end(objects));
+			objects.erase(first_unselected, end(objects));
+			map->removeObjectsFromSelection(objects, false);
+			map->addObjectsToSelection(unselected, false);
+		}
 		else
-			map->addObjectToSelection(objects[i], i == size - 1);
-			
+		{
+			map->addObjectsToSelection(objects, false);
+		}
+		map->emitSelectionChanged();
 		selection_changed = true;
 	}
 	
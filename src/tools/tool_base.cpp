@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <cstdlib>  // IWYU pragma: keep
 #include <iterator>
+#include <memory>
 #include <type_traits>
 
 #include <QtGlobal>
@@ -42,6 +43,7 @@
 #include "gui/widgets/key_button_bar.h"  // IWYU pragma: keep
 #include "tools/tool_helpers.h"
 #include "undo/object_undo.h"
+#include "undo/undo.h"
 
 
 #ifdef __clang_analyzer__
@@ -524,7 +526,7 @@ void MapEditorToolBase::startEditing(Object* object)
 }
 
 
-void MapEditorToolBase::startEditing(const std::set<Object*>& objects)
+void MapEditorToolBase::startEditing(const std::unordered_set<Object*>& objects)
 {
 	Q_ASSERT(!editingInProgress());
 	setEditingInProgress(true);
@@ -567,16 +569,34 @@ void MapEditorToolBase::finishEditing()
 	
 	if (!edited_items.empty())
 	{
-		auto undo_step = new ReplaceObjectsUndoStep(map());
+		// Coordinate-only changes are recorded compactly, without duplicates.
+		auto coords_step = std::make_unique<ObjectCoordsUndoStep>(map());
+		auto replace_step = std::make_unique<ReplaceObjectsUndoStep>(map());
 		for (auto& edited_item : edited_items)
 		{
 			auto object = edited_item.active_object;
 			object->setMap(map());
 			object->update();
-			undo_step->addObject(object, edited_item.duplicate.release());
+			if (!coords_step->addObject(object, edited_item.duplicate.get()))
+				replace_step->addObject(object, edited_item.duplicate.release());
 		}
 		edited_items.clear();
-		map()->push(undo_step);
+		
+		if (coords_step->isEmpty())
+		{
+			map()->push(replace_step.release());
+		}
+		else if (replace_step->isEmpty())
+		{
+			map()->push(coords_step.release());
+		}
+		else
+		{
+			auto undo_step = new CombinedUndoStep(map());
+			undo_step->push(replace_step.release());
+			undo_step->push(coords_step.release());
+			map()->push(undo_step);
+		}
 	}
 	renderables->clear();
 	old_renderables->clear(true);
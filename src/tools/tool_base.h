@@ -23,7 +23,7 @@
 #define OPENORIENTEERING_MAP_EDITOR_TOOL_BASE_H
 
 #include <memory>
-#include <set>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -229,7 +229,7 @@ protected:
 	/// Takes care of the preview renderables handling, map dirty flag, and objects edited signal.
 	void startEditing();
 	void startEditing(Object* object);
-	void startEditing(const std::set<Object*>& objects);
+	void startEditing(const std::unordered_set<Object*>& objects);
 	void abortEditing();
 	
 	ObjectsRange editedObjects() { return ObjectsRange { edited_items }; }
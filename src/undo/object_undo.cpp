@@ -22,9 +22,17 @@
 #include "object_undo.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+#include <QChar>
+#include <QString>
 
 #include "core/map.h"
+#include "core/map_coord.h"
+#include "core/path_coord.h"
 #include "core/objects/object.h"
+#include "core/objects/text_object.h"
 #include "core/symbols/symbol.h"
 #include "fileformats/file_format.h"
 #include "fileformats/file_import_export.h"
@@ -36,11 +44,59 @@ namespace literal
 	const QLatin1String source("source");
 	const QLatin1String part("part");
 	const QLatin1String reverse("reverse");
+	const QLatin1String first("first");
+	const QLatin1String last("last");
+	const QLatin1String dx("dx");
+	const QLatin1String dy("dy");
 }
 
 
 namespace OpenOrienteering {
 
+namespace {
+
+/**
+ * Returns an estimate of the memory occupied by the given tags.
+ */
+std::size_t tagsMemoryUsage(const Object::Tags& tags)
+{
+	auto usage = std::size_t(tags.size()) * 2 * sizeof(QString);
+	for (auto it = tags.constBegin(), end = tags.constEnd(); it != end; ++it)
+		usage += std::size_t(it.key().size() + it.value().size()) * sizeof(QChar);
+	return usage;
+}
+
+/**
+ * Returns an estimate of the memory occupied by the given object.
+ * 
+ * Renderables are not taken into account: objects which are not part of the
+ * map do not need them.
+ */
+std::size_t objectMemoryUsage(const Object* object)
+{
+	auto usage = object->getRawCoordinateVector().capacity() * sizeof(MapCoord)
+	             + tagsMemoryUsage(object->tags());
+	if (auto* path = object->asPath())
+	{
+		usage += sizeof(PathObject) + path->parts().capacity() * sizeof(PathPart);
+		for (const auto& part : path->parts())
+			usage += part.path_coords.capacity() * sizeof(PathCoord);
+	}
+	else if (auto* text = object->asText())
+	{
+		usage += sizeof(TextObject) + std::size_t(text->getText().size()) * sizeof(QChar);
+	}
+	else
+	{
+		usage += sizeof(PointObject);
+	}
+	return usage;
+}
+
+}  // namespace
+
+
+
 // ### ObjectModifyingUndoStep ###
 
 ObjectModifyingUndoStep::ObjectModifyingUndoStep(Type type, Map* map)
@@ -159,6 +215,12 @@ void ObjectModifyingUndoStep::loadObject(XmlElementReader&, int)
 	// nothing
 }
 
+std::size_t ObjectModifyingUndoStep::calculateMemoryUsage() const
+{
+	return UndoStep::calculateMemoryUsage()
+	       + modified_objects.capacity() * sizeof(ObjectList::value_type);
+}
+
 
 
 // ### ObjectCreatingUndoStep ###
@@ -242,6 +304,15 @@ void ObjectCreatingUndoStep::loadImpl(QXmlStreamReader& xml, SymbolDictionary& s
 		ObjectModifyingUndoStep::loadImpl(xml, symbol_dict);
 }
 
+std::size_t ObjectCreatingUndoStep::calculateMemoryUsage() const
+{
+	auto usage = ObjectModifyingUndoStep::calculateMemoryUsage()
+	             + objects.capacity() * sizeof(Object*);
+	for (const auto* object : objects)
+		usage += objectMemoryUsage(object);
+	return usage;
+}
+
 void ObjectCreatingUndoStep::symbolChanged(int pos, const Symbol* new_symbol, const Symbol* old_symbol)
 {
 	Q_UNUSED(pos);
@@ -625,6 +696,12 @@ void SwitchSymbolUndoStep::loadImpl(QXmlStreamReader& xml, SymbolDictionary& sym
 		ObjectModifyingUndoStep::loadImpl(xml, symbol_dict);
 }
 
+std::size_t SwitchSymbolUndoStep::calculateMemoryUsage() const
+{
+	return ObjectModifyingUndoStep::calculateMemoryUsage()
+	       + target_symbols.capacity() * sizeof(const Symbol*);
+}
+
 void SwitchSymbolUndoStep::symbolChanged(int pos, const Symbol* new_symbol, const Symbol* old_symbol)
 {
 	Q_UNUSED(pos);
@@ -735,5 +812,169 @@ void ObjectTagsUndoStep::loadObject(XmlElementReader& xml, int index)
 	xml.read(object_tags_map[index]);
 }
 
+std::size_t ObjectTagsUndoStep::calculateMemoryUsage() const
+{
+	auto usage = ObjectModifyingUndoStep::calculateMemoryUsage();
+	for (const auto& object_tags : object_tags_map)
+		usage += sizeof(ObjectTagsMap::value_type) + tagsMemoryUsage(object_tags.second);
+	return usage;
+}
+
+
+
+// ### ObjectCoordsUndoStep ###
+
+ObjectCoordsUndoStep::ObjectCoordsUndoStep(Map* map)
+: ObjectModifyingUndoStep(ObjectCoordsUndoStepType, map)
+{
+	; // nothing else
+}
+
+ObjectCoordsUndoStep::~ObjectCoordsUndoStep()
+{
+	; // nothing
+}
+
+void ObjectCoordsUndoStep::addObject(int)
+{
+	qWarning("This implementation must not be called");
+}
+
+bool ObjectCoordsUndoStep::addObject(Object* existing, const Object* original)
+{
+	const auto* path = existing->asPath();
+	const auto* original_path = original->asPath();
+	if (!path || !original_path
+	    || path->getSymbol() != original_path->getSymbol()
+	    || path->getRotation() != original_path->getRotation()
+	    || path->getPatternOrigin() != original_path->getPatternOrigin()
+	    || path->tags() != original_path->tags())
+	{
+		return false;
+	}
+	
+	int const index = map->getPart(getPartIndex())->findObjectIndex(existing);
+	Q_ASSERT(index >= 0);
+	
+	const auto& original_coords = original_path->getRawCoordinateVector();
+	const auto& coords = path->getRawCoordinateVector();
+	
+	CoordsChange change;
+	if (!coords.empty() && coords.size() == original_coords.size())
+	{
+		auto const offset = original_coords.front() - coords.front();
+		auto const is_offset = [&offset](const MapCoord& o, const MapCoord& c) {
+			return o.flags() == c.flags()
+			       && o.nativeX() == c.nativeX() + offset.nativeX()
+			       && o.nativeY() == c.nativeY() + offset.nativeY();
+		};
+		if (offset != MapCoord{}
+		    && std::equal(begin(original_coords), end(original_coords), begin(coords), is_offset))
+		{
+			change.offset = offset;
+		}
+	}
+	
+	if (change.offset == MapCoord{})
+	{
+		// Common prefix
+		auto const mismatch = std::mismatch(begin(original_coords), end(original_coords), begin(coords), end(coords));
+		change.first = MapCoordVector::size_type(std::distance(begin(coords), mismatch.second));
+		// Common suffix, not overlapping the prefix
+		auto original_last = original_coords.size();
+		change.last = coords.size();
+		while (original_last > change.first && change.last > change.first
+		       && original_coords[original_last - 1] == coords[change.last - 1])
+		{
+			--original_last;
+			--change.last;
+		}
+		change.coords.assign(begin(original_coords) + MapCoordVector::difference_type(change.first),
+		                     begin(original_coords) + MapCoordVector::difference_type(original_last));
+	}
+	
+	ObjectModifyingUndoStep::addObject(index);
+	coords_changes[index] = std::move(change);
+	return true;
+}
+
+UndoStep* ObjectCoordsUndoStep::undo()
+{
+	int const part_index = getPartIndex();
+	
+	auto* redo_step = new ObjectCoordsUndoStep(map);
+	redo_step->setPartIndex(part_index);
+	
+	MapPart* const map_part = map->getPart(part_index);
+	for (auto& object_change : coords_changes)
+	{
+		auto* object = map_part->getObject(object_change.first)->asPath();
+		Q_ASSERT(object);
+		auto& change = object_change.second;
+		
+		CoordsChange redo_change;
+		if (change.coords.empty() && change.offset != MapCoord{})
+		{
+			redo_change.offset = -change.offset;
+			object->move(change.offset);
+		}
+		else
+		{
+			const auto& coords = object->getRawCoordinateVector();
+			redo_change.first = change.first;
+			redo_change.last  = change.first + change.coords.size();
+			redo_change.coords.assign(begin(coords) + MapCoordVector::difference_type(change.first),
+			                          begin(coords) + MapCoordVector::difference_type(change.last));
+			object->replaceCoordinates(change.first, change.last, change.coords);
+		}
+		object->update();
+		
+		redo_step->ObjectModifyingUndoStep::addObject(object_change.first);
+		redo_step->coords_changes[object_change.first] = std::move(redo_change);
+	}
+	
+	return redo_step;
+}
+
+void ObjectCoordsUndoStep::saveObject(XmlElementWriter& xml, int index) const
+{
+	const auto& change = coords_changes.at(index);
+	if (change.coords.empty() && change.offset != MapCoord{})
+	{
+		xml.writeAttribute(literal::dx, change.offset.nativeX());
+		xml.writeAttribute(literal::dy, change.offset.nativeY());
+	}
+	else
+	{
+		xml.writeAttribute(literal::first, change.first);
+		xml.writeAttribute(literal::last, change.last);
+		xml.write(change.coords);
+	}
+}
+
+void ObjectCoordsUndoStep::loadObject(XmlElementReader& xml, int index)
+{
+	auto& change = coords_changes[index];
+	if (xml.hasAttribute(literal::dx))
+	{
+		change.offset = MapCoord::fromNative(xml.attribute<qint32>(literal::dx), xml.attribute<qint32>(literal::dy));
+	}
+	else
+	{
+		change.first = xml.attribute<MapCoordVector::size_type>(literal::first);
+		change.last  = xml.attribute<MapCoordVector::size_type>(literal::last);
+		xml.read(change.coords);
+	}
+}
+
+std::size_t ObjectCoordsUndoStep::calculateMemoryUsage() const
+{
+	auto usage = ObjectModifyingUndoStep::calculateMemoryUsage();
+	for (const auto& object_change : coords_changes)
+		usage += sizeof(CoordsChangeMap::value_type) + object_change.second.coords.capacity() * sizeof(MapCoord);
+	return usage;
+}
+
 
 }  // namespace OpenOrienteering
+
@@ -29,6 +29,7 @@
 
 #include <QObject>
 
+#include "core/map_coord.h"
 #include "core/objects/object.h"
 #include "core/symbols/symbol.h"
 #include "undo/undo.h"
@@ -77,6 +78,11 @@ public:
 	 */
 	void setPartIndex(int part_index);
 	
+	/**
+	 * Returns the indices of the objects modified by this undo step.
+	 */
+	const std::vector<int>& getModifiedIndices() const;
+	
 	
 	/**
 	 * Returns true if no objects are modified by this undo step.
@@ -138,6 +144,11 @@ protected:
 	 */
 	virtual void loadObject(XmlElementReader& xml, int index);
 	
+	/**
+	 * @copybrief UndoStep::calculateMemoryUsage()
+	 */
+	std::size_t calculateMemoryUsage() const override;
+	
 	
 private:
 	/**
@@ -236,6 +247,11 @@ protected:
 	 */
 	void loadImpl(QXmlStreamReader& xml, SymbolDictionary& symbol_dict) override;
 	
+	/**
+	 * Adds an estimate of the memory occupied by the contained objects.
+	 */
+	std::size_t calculateMemoryUsage() const override;
+	
 	/**
 	 * A list of object instance which are currently not part of the map.
 	 */
@@ -380,6 +396,8 @@ protected:
 	
 	void loadImpl(QXmlStreamReader& xml, SymbolDictionary& symbol_dict) override;
 	
+	std::size_t calculateMemoryUsage() const override;
+	
 	std::vector<const Symbol*> target_symbols;
 	
 	bool valid;
@@ -423,12 +441,79 @@ protected:
 	
 	void loadObject(XmlElementReader& xml, int index) override;
 	
+	std::size_t calculateMemoryUsage() const override;
+	
 	typedef std::map<int, Object::Tags> ObjectTagsMap;
 	
 	ObjectTagsMap object_tags_map;
 };
 
 
+/**
+ * Undo step which restores the coordinates of path objects.
+ * 
+ * Instead of keeping a duplicate of each modified object, this step only
+ * records the range of coordinates which differs from the original object,
+ * together with the original coordinates of this range. When all coordinates
+ * were moved by the same offset, only the offset is recorded.
+ * 
+ * This is meant for edits which only touch coordinates, such as dragging
+ * points or objects, or scaling and rotating lines and areas. For other
+ * modifications, ReplaceObjectsUndoStep must be used.
+ */
+class ObjectCoordsUndoStep : public ObjectModifyingUndoStep
+{
+public:
+	ObjectCoordsUndoStep(Map* map);
+	
+	~ObjectCoordsUndoStep() override;
+	
+	/**
+	 * Must not be called.
+	 * 
+	 * Use the two-parameter signature instead of this one.
+	 */
+	void addObject(int index) override;
+	
+	/**
+	 * Adds an object of the current part by comparing it to its original state.
+	 * 
+	 * Returns false, without adding the object, if the object differs from
+	 * the original in other properties than the coordinates.
+	 */
+	bool addObject(Object* existing, const Object* original);
+	
+	UndoStep* undo() override;
+	
+protected:
+	void saveObject(XmlElementWriter& xml, int index) const override;
+	
+	void loadObject(XmlElementReader& xml, int index) override;
+	
+	std::size_t calculateMemoryUsage() const override;
+	
+	/**
+	 * The change of the coordinates of a single object.
+	 * 
+	 * If coords is empty and offset is not null, all coordinates were moved
+	 * by -offset. Otherwise, the range [first, last) of the modified object's
+	 * coordinates replaced the original coordinates in coords.
+	 */
+	struct CoordsChange
+	{
+		MapCoordVector::size_type first = 0;
+		MapCoordVector::size_type last  = 0;
+		MapCoordVector coords;
+		MapCoord offset;
+	};
+	
+	typedef std::map<int, CoordsChange> CoordsChangeMap;
+	
+	CoordsChangeMap coords_changes;
+};
+
+
+
 // ### ObjectModifyingUndoStep inline code ###
 
 inline
@@ -437,6 +522,12 @@ int ObjectModifyingUndoStep::getPartIndex() const
 	return part_index;
 }
 
+inline
+const std::vector<int>& ObjectModifyingUndoStep::getModifiedIndices() const
+{
+	return modified_objects;
+}
+
 
 }  // namespace OpenOrienteering
 
@@ -21,10 +21,23 @@
 
 #include "undo.h"
 
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <utility>
 #include <vector>
 
+#include <QBuffer>
+#include <QIODevice>
+#include <QLatin1String>
+#include <QStringRef>
 #include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 
+#include "core/map.h"
+#include "core/symbols/line_symbol.h"
+#include "core/symbols/point_symbol.h"
+#include "core/symbols/text_symbol.h"
 #include "object_undo.h"
 #include "map_part_undo.h"
 #include "util/xml_stream_util.h"
@@ -71,6 +84,9 @@ UndoStep* UndoStep::getUndoStepForType(Type type, Map* map)
 	case ObjectTagsUndoStepType:
 		return new ObjectTagsUndoStep(map);
 		
+	case ObjectCoordsUndoStepType:
+		return new ObjectCoordsUndoStep(map);
+		
 	case SwitchPartUndoStepType:
 		return new SwitchPartUndoStep(map);
 		
@@ -114,6 +130,18 @@ void UndoStep::getModifiedObjects(int, ObjectSet&) const
 	; // nothing
 }
 
+std::size_t UndoStep::memoryUsage() const
+{
+	if (memory_usage == 0)
+		memory_usage = calculateMemoryUsage();
+	return memory_usage;
+}
+
+std::size_t UndoStep::calculateMemoryUsage() const
+{
+	return sizeof(UndoStep);
+}
+
 // static
 UndoStep* UndoStep::load(QXmlStreamReader& xml, Map* map, SymbolDictionary& symbol_dict)
 {
@@ -199,6 +227,16 @@ void CombinedUndoStep::getModifiedObjects(int part_index, ObjectSet &out) const
 
 
 
+std::size_t CombinedUndoStep::calculateMemoryUsage() const
+{
+	auto usage = UndoStep::calculateMemoryUsage() + steps.capacity() * sizeof(UndoStep*);
+	for (const auto* step : steps)
+		usage += step->memoryUsage();
+	return usage;
+}
+
+
+
 void CombinedUndoStep::saveImpl(QXmlStreamWriter& xml) const
 {
 	UndoStep::saveImpl(xml);
@@ -275,5 +313,199 @@ UndoStep* NoOpUndoStep::undo()
 }
 
 
+
+// ### SpilledUndoStep ###
+
+// static
+std::unique_ptr<SpilledUndoStep> SpilledUndoStep::spill(const UndoStep& step, Map* map, QIODevice& file)
+{
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	{
+		QXmlStreamWriter xml(&buffer);
+		xml.writeStartDocument();
+		step.save(xml);
+		xml.writeEndDocument();
+	}
+	
+	// Record the symbols which are referenced in the data.
+	SymbolReferences symbols;
+	if (map)
+	{
+		auto const num_symbols = map->getNumSymbols();
+		QXmlStreamReader xml(buffer.data());
+		while (!xml.atEnd())
+		{
+			if (xml.readNext() != QXmlStreamReader::StartElement)
+				continue;
+			auto const value = xml.attributes().value(QLatin1String("symbol"));
+			bool ok = false;
+			auto const index = value.toInt(&ok);
+			if (ok && index >= 0 && index < num_symbols)
+				symbols.emplace_back(index, map->getSymbol(index));
+		}
+		std::sort(begin(symbols), end(symbols));
+		symbols.erase(std::unique(begin(symbols), end(symbols)), end(symbols));
+		symbols.shrink_to_fit();
+	}
+	
+	auto const data = qCompress(buffer.data());
+	auto const offset = file.size();
+	if (!file.seek(offset) || file.write(data) != data.size())
+		return {};
+	
+	return std::unique_ptr<SpilledUndoStep>(new SpilledUndoStep(step.getType(), map, file, offset, data.size(), std::move(symbols)));
+}
+
+
+SpilledUndoStep::SpilledUndoStep(Type type, Map* map, QIODevice& file, qint64 offset, qint64 size, SymbolReferences&& symbols)
+: UndoStep(type, map)
+, file(&file)
+, offset(offset)
+, size(size)
+, symbols(std::move(symbols))
+, valid(true)
+{
+	if (map)
+	{
+		connect(map, &Map::symbolChanged, this, &SpilledUndoStep::symbolChanged);
+		connect(map, &Map::symbolDeleted, this, &SpilledUndoStep::symbolDeleted);
+	}
+}
+
+SpilledUndoStep::~SpilledUndoStep() = default;
+
+
+bool SpilledUndoStep::isValid() const
+{
+	return valid && (!restored_step || restored_step->isValid());
+}
+
+UndoStep* SpilledUndoStep::undo()
+{
+	if (auto* step = restoredStep())
+		return step->undo();
+	
+	qWarning("SpilledUndoStep::undo(): Failed to restore the undo step");
+	return new NoOpUndoStep(map, false);
+}
+
+
+bool SpilledUndoStep::getModifiedParts(PartSet& out) const
+{
+	if (auto* step = restoredStep())
+		return step->getModifiedParts(out);
+	return false;
+}
+
+void SpilledUndoStep::getModifiedObjects(int part_index, ObjectSet& out) const
+{
+	if (auto* step = restoredStep())
+		step->getModifiedObjects(part_index, out);
+}
+
+
+void SpilledUndoStep::symbolChanged(int /*pos*/, const Symbol* new_symbol, const Symbol* old_symbol)
+{
+	for (auto& reference : symbols)
+	{
+		if (reference.second == old_symbol)
+			reference.second = new_symbol;
+	}
+}
+
+void SpilledUndoStep::symbolDeleted(int /*pos*/, const Symbol* old_symbol)
+{
+	auto const is_deleted = [old_symbol](auto const& reference) { return reference.second == old_symbol; };
+	if (std::any_of(begin(symbols), end(symbols), is_deleted))
+		valid = false;
+}
+
+
+void SpilledUndoStep::saveImpl(QXmlStreamWriter& xml) const
+{
+	// Copy the original step's child elements, but not the step element.
+	QXmlStreamReader reader(readData());
+	if (!reader.readNextStartElement())
+		return;
+	
+	for (int depth = 0; !reader.atEnd(); )
+	{
+		reader.readNext();
+		if (reader.isStartElement())
+			++depth;
+		else if (reader.isEndElement() && depth-- == 0)
+			break;
+		xml.writeCurrentToken(reader);
+	}
+}
+
+std::size_t SpilledUndoStep::calculateMemoryUsage() const
+{
+	return sizeof(SpilledUndoStep) + symbols.capacity() * sizeof(SymbolReferences::value_type);
+}
+
+
+qint64 SpilledUndoStep::dataSize() const
+{
+	return size;
+}
+
+qint64 SpilledUndoStep::copyTo(QIODevice& target) const
+{
+	if (!file->seek(offset))
+		return -1;
+	auto const data = file->read(size);
+	if (data.size() != size)
+		return -1;
+	
+	auto const target_offset = target.size();
+	if (!target.seek(target_offset) || target.write(data) != size)
+		return -1;
+	return target_offset;
+}
+
+void SpilledUndoStep::relocate(QIODevice& target, qint64 target_offset)
+{
+	file = &target;
+	offset = target_offset;
+}
+
+
+QByteArray SpilledUndoStep::readData() const
+{
+	if (!file->seek(offset))
+		return {};
+	return qUncompress(file->read(size));
+}
+
+UndoStep* SpilledUndoStep::restoredStep() const
+{
+	if (!restored_step && valid)
+	{
+		SymbolDictionary symbol_dict;
+		for (auto const& reference : symbols)
+			symbol_dict[reference.first] = const_cast<Symbol*>(reference.second);
+		symbol_dict[-2] = Map::getUndefinedPoint();
+		symbol_dict[-3] = Map::getUndefinedLine();
+		symbol_dict[-4] = Map::getUndefinedText();
+		
+		QXmlStreamReader xml(readData());
+		if (xml.readNextStartElement() && xml.name() == QLatin1String("step"))
+		{
+			try
+			{
+				restored_step.reset(UndoStep::load(xml, map, symbol_dict));
+			}
+			catch (std::exception& e)
+			{
+				qWarning("Failed to restore a spilled undo step: %s", e.what());
+			}
+		}
+	}
+	return restored_step.get();
+}
+
+
 }  // namespace OpenOrienteering
 
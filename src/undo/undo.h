@@ -24,9 +24,17 @@
 
 #include "core/symbols/symbol.h"
 
+#include <cstddef>
+#include <memory>
 #include <set>
+#include <utility>
 #include <vector>
 
+#include <QtGlobal>
+#include <QByteArray>
+#include <QObject>
+
+class QIODevice;
 class QXmlStreamReader;
 class QXmlStreamWriter;
 
@@ -67,6 +75,7 @@ public:
 		MapPartUndoStepType        =   8,
 		SwitchPartUndoStepTypeV0   =   9,
 		SwitchPartUndoStepType     =  10,
+		ObjectCoordsUndoStepType   =  11,
 		InvalidUndoStepType        = 999
 	};
 	
@@ -156,6 +165,17 @@ public:
 	virtual void getModifiedObjects(int part_index, ObjectSet& out) const;
 	
 	
+	/**
+	 * Returns an estimate of the memory occupied by this step, in bytes.
+	 * 
+	 * The value is calculated on first use and cached afterwards. That is
+	 * why this function must not be called before the step is complete.
+	 * 
+	 * @see calculateMemoryUsage()
+	 */
+	std::size_t memoryUsage() const;
+	
+	
 	/**
 	 * Loads the undo step from the stream in xml format.
 	 */
@@ -187,6 +207,15 @@ protected:
 	 * implementation.
 	 */
 	virtual void loadImpl(QXmlStreamReader& xml, SymbolDictionary& symbol_dict);
+	
+	/**
+	 * Calculates an estimate of the memory occupied by this step, in bytes.
+	 * 
+	 * Implementations in derived classes shall add the memory of their own
+	 * members to the value returned by the parent class' implementation.
+	 * The default implementation returns the size of an UndoStep.
+	 */
+	virtual std::size_t calculateMemoryUsage() const;
 
 protected:
 	/**
@@ -198,6 +227,12 @@ protected:
 	 * The map this undo step belongs.
 	 */
 	Map* const map;
+	
+private:
+	/**
+	 * The cached value of memoryUsage(), or 0 if not yet calculated.
+	 */
+	mutable std::size_t memory_usage = 0;
 };
 
 
@@ -259,6 +294,11 @@ public:
 	 */
 	UndoStep* getSubStep(int i);
 	
+	/** 
+	 * Returns the i-th sub step.
+	 */
+	const UndoStep* getSubStep(int i) const;
+	
 	
 protected:
 	/**
@@ -271,6 +311,11 @@ protected:
 	 */
 	void loadImpl(QXmlStreamReader& xml, SymbolDictionary& symbol_dict) override;
 	
+	/**
+	 * Returns the sum of the memory usage of all sub steps.
+	 */
+	std::size_t calculateMemoryUsage() const override;
+	
 private:
 	typedef std::vector<UndoStep*> StepList;
 	
@@ -322,6 +367,134 @@ private:
 
 
 
+/**
+ * An undo step which keeps another undo step in compressed form in a file.
+ * 
+ * UndoManager replaces old undo steps by SpilledUndoSteps when the memory
+ * occupied by the undo history exceeds the configured limit. The original
+ * step is restored from the file when it is needed for undo().
+ * 
+ * The step is stored in the same xml format which is used for saving the
+ * undo history with the map. The symbols which are referenced in the data
+ * are recorded together with their index at the time of spilling, and they
+ * are kept up to date when symbols are replaced. When one of these symbols
+ * is deleted, the step becomes invalid.
+ */
+class SpilledUndoStep : public QObject, public UndoStep
+{
+Q_OBJECT
+public:
+	/**
+	 * Writes the given step to the end of the given file.
+	 * 
+	 * Returns a step which refers to the written data, or nullptr on error.
+	 */
+	static std::unique_ptr<SpilledUndoStep> spill(const UndoStep& step, Map* map, QIODevice& file);
+	
+	/**
+	 * Destructor.
+	 */
+	~SpilledUndoStep() override;
+	
+	
+	/**
+	 * Returns false when a referenced symbol was deleted since the step was
+	 * spilled, or when the restored step is no longer valid.
+	 */
+	bool isValid() const override;
+	
+	/**
+	 * Restores the original step, and returns the result of its undo().
+	 */
+	UndoStep* undo() override;
+	
+	
+	/**
+	 * Adds the modified parts of the restored step to the given set.
+	 */
+	bool getModifiedParts(PartSet& out) const override;
+	
+	/**
+	 * Adds the modified objects of the restored step to the given set.
+	 */
+	void getModifiedObjects(int part_index, ObjectSet& out) const override;
+	
+	/**
+	 * Returns the original step, loading it from the file when necessary.
+	 * 
+	 * Returns nullptr if the step cannot be restored.
+	 */
+	UndoStep* restoredStep() const;
+	
+	
+	/**
+	 * Returns the size of the compressed data in the file.
+	 */
+	qint64 dataSize() const;
+	
+	/**
+	 * Appends the compressed data to the given file.
+	 * 
+	 * Returns the offset of the copy, or -1 on error.
+	 */
+	qint64 copyTo(QIODevice& target) const;
+	
+	/**
+	 * Lets the step refer to a copy of its data in another file.
+	 * 
+	 * The offset must be a value returned by copyTo() for this step.
+	 */
+	void relocate(QIODevice& target, qint64 target_offset);
+	
+	
+public slots:
+	/**
+	 * Updates the referenced symbols.
+	 */
+	void symbolChanged(int pos, const OpenOrienteering::Symbol* new_symbol, const OpenOrienteering::Symbol* old_symbol);
+	
+	/**
+	 * Invalidates the undo step if the data references the deleted symbol.
+	 */
+	void symbolDeleted(int pos, const OpenOrienteering::Symbol* old_symbol);
+	
+protected:
+	/**
+	 * The symbols referenced in the spilled data, by their index at the time of spilling.
+	 */
+	using SymbolReferences = std::vector<std::pair<qint32, const Symbol*>>;
+	
+	/**
+	 * Constructs a step which refers to data in the given file.
+	 */
+	SpilledUndoStep(Type type, Map* map, QIODevice& file, qint64 offset, qint64 size, SymbolReferences&& symbols);
+	
+	/**
+	 * Copies the original step's properties to the xml stream.
+	 */
+	void saveImpl(QXmlStreamWriter& xml) const override;
+	
+	/**
+	 * Returns the memory occupied by the step itself and the symbol references.
+	 */
+	std::size_t calculateMemoryUsage() const override;
+	
+	/**
+	 * Reads and uncompresses the data from the file.
+	 */
+	QByteArray readData() const;
+	
+private:
+	QIODevice* file;
+	qint64 offset;
+	qint64 const size;
+	SymbolReferences symbols;
+	mutable std::unique_ptr<UndoStep> restored_step;
+	bool valid;
+};
+
+
+
 // ### UndoStep inline code ###
 
 inline
@@ -351,6 +524,12 @@ UndoStep* CombinedUndoStep::getSubStep(int i)
 	return steps[i];
 }
 
+inline
+const UndoStep* CombinedUndoStep::getSubStep(int i) const
+{
+	return steps[i];
+}
+
 
 }  // namespace OpenOrienteering
 
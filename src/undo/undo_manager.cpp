@@ -22,19 +22,27 @@
 #include "undo_manager.h"
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
 #include <limits>
+#include <map>
 #include <set>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <Qt>
 #include <QtGlobal>
 #include <QLatin1String>
 #include <QMessageBox>
 #include <QStringRef>
+#include <QTemporaryFile>
 #include <QXmlStreamReader>
 
 #include "core/map.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "undo/object_undo.h"
 #include "undo/undo.h"
 #include "util/xml_stream_util.h"
 
@@ -44,6 +52,110 @@ namespace OpenOrienteering {
 Q_STATIC_ASSERT(UndoManager::max_undo_steps < std::numeric_limits<int>::max());
 
 
+namespace {
+
+/**
+ * The objects of a map part which are not modified by the tracked steps.
+ * 
+ * Objects which are modified, added or deleted by the steps are null.
+ */
+typedef std::vector<const Object*> TrackedObjects;
+
+/**
+ * Applies the effect of executing the given step to the tracked objects,
+ * without actually executing the step.
+ * 
+ * Returns false for steps whose effect cannot be tracked.
+ */
+bool trackStep(const UndoStep& step, const Map& map, std::map<int, TrackedObjects>& tracked_parts)
+{
+	if (auto* spilled = dynamic_cast<const SpilledUndoStep*>(&step))
+	{
+		auto* restored = spilled->restoredStep();
+		return restored && trackStep(*restored, map, tracked_parts);
+	}
+	
+	if (auto* combined = dynamic_cast<const CombinedUndoStep*>(&step))
+	{
+		// The sub steps are executed in reverse order.
+		for (auto i = combined->getNumSubSteps(); i > 0; )
+		{
+			if (!trackStep(*combined->getSubStep(--i), map, tracked_parts))
+				return false;
+		}
+		return true;
+	}
+	
+	switch (step.getType())
+	{
+	case UndoStep::ValidNoOpUndoStepType:
+		return true;
+	case UndoStep::ReplaceObjectsUndoStepType:
+	case UndoStep::DeleteObjectsUndoStepType:
+	case UndoStep::AddObjectsUndoStepType:
+	case UndoStep::SwitchSymbolUndoStepType:
+	case UndoStep::SwitchDashesUndoStepType:
+	case UndoStep::ObjectTagsUndoStepType:
+	case UndoStep::ObjectCoordsUndoStepType:
+		break;
+	default:
+		// Changes to map parts, and moving objects between parts
+		return false;
+	}
+	
+	auto& object_step = static_cast<const ObjectModifyingUndoStep&>(step);
+	auto const part_index = object_step.getPartIndex();
+	if (part_index < 0 || part_index >= map.getNumParts())
+		return false;
+	
+	auto tracked = tracked_parts.find(part_index);
+	if (tracked == end(tracked_parts))
+	{
+		auto const* part = map.getPart(std::size_t(part_index));
+		TrackedObjects objects;
+		objects.reserve(std::size_t(part->getNumObjects()));
+		for (int i = 0; i < part->getNumObjects(); ++i)
+			objects.push_back(part->getObject(i));
+		tracked = tracked_parts.emplace(part_index, std::move(objects)).first;
+	}
+	auto& objects = tracked->second;
+	
+	auto indices = object_step.getModifiedIndices();
+	switch (step.getType())
+	{
+	case UndoStep::DeleteObjectsUndoStepType:
+		std::sort(begin(indices), end(indices), std::greater<int>());
+		for (auto index : indices)
+		{
+			if (index < 0 || index >= int(objects.size()))
+				return false;
+			objects.erase(begin(objects) + index);
+		}
+		break;
+	case UndoStep::AddObjectsUndoStepType:
+		std::sort(begin(indices), end(indices));
+		for (auto index : indices)
+		{
+			if (index < 0 || index > int(objects.size()))
+				return false;
+			objects.insert(begin(objects) + index, nullptr);
+		}
+		break;
+	default:
+		for (auto index : indices)
+		{
+			if (index < 0 || index >= int(objects.size()))
+				return false;
+			objects[std::size_t(index)] = nullptr;
+		}
+	}
+	return true;
+}
+
+
+}  // namespace
+
+
 // ### UndoManager::State ###
 
 UndoManager::State::State(UndoManager const *manager)
@@ -91,6 +203,7 @@ void UndoManager::clear()
 		UndoManager::State const old_state(this);
 		
 		undo_steps.erase(begin(undo_steps), end(undo_steps));
+		spill_file.reset();
 		current_index = 0;
 		clean_state_index = old_state.is_clean ? 0 : -1;
 		loaded_state_index = old_state.is_loaded ? 0 : -1;
@@ -113,6 +226,7 @@ void UndoManager::push(std::unique_ptr<UndoStep>&& step)
 	undo_steps.emplace_back(std::move(step));
 	++current_index;
 	validateUndoSteps();
+	enforceMemoryLimit();
 	emitChangedSignals(old_state);
 }
 
@@ -155,6 +269,7 @@ bool UndoManager::undo(QWidget* dialog_parent)
 	
 	--current_index;
 	undo_steps[StepList::size_type(current_index)].reset(redo_step);
+	compactSpillFile();
 	
 	emitChangedSignals(old_state);
 	
@@ -192,6 +307,7 @@ bool UndoManager::redo(QWidget* dialog_parent)
 	
 	undo_steps[StepList::size_type(current_index)].reset(undo_step);
 	++current_index;
+	compactSpillFile();
 	
 	emitChangedSignals(old_state);
 	
@@ -295,6 +411,7 @@ void UndoManager::clearRedoSteps()
 			clean_state_index = -1;
 		if (loaded_state_index > StepList::difference_type(current_index))
 			loaded_state_index = -1;
+		compactSpillFile();
 		emit canRedoChanged(false);
 	}
 }
@@ -316,24 +433,32 @@ void UndoManager::validateUndoSteps()
 		if (rfirst != rlast)
 			num_removed_undo_steps += std::distance(rfirst, rlast);
 		
-		if (num_removed_undo_steps == 0)
-			return;
-		
-		auto first = begin(undo_steps);
-		undo_steps.erase(first, first + num_removed_undo_steps);
-		current_index -= StepList::size_type(num_removed_undo_steps);
-		
-		if (clean_state_index >= 0)
-			clean_state_index -= num_removed_undo_steps;
-		
-		if (loaded_state_index >= 0)
-			loaded_state_index -= num_removed_undo_steps;
-		
-		if (!canUndo())
-			emit canUndoChanged(false);
+		removeOldestUndoSteps(num_removed_undo_steps);
 	}
 }
 
+void UndoManager::removeOldestUndoSteps(int num_removed_undo_steps)
+{
+	Q_ASSERT(num_removed_undo_steps <= current_index);
+	if (num_removed_undo_steps <= 0)
+		return;
+	
+	auto first = begin(undo_steps);
+	undo_steps.erase(first, first + num_removed_undo_steps);
+	current_index -= num_removed_undo_steps;
+	
+	if (clean_state_index >= 0)
+		clean_state_index -= num_removed_undo_steps;
+	
+	if (loaded_state_index >= 0)
+		loaded_state_index -= num_removed_undo_steps;
+	
+	compactSpillFile();
+	
+	if (!canUndo())
+		emit canUndoChanged(false);
+}
+
 void UndoManager::validateRedoSteps()
 {
 	if (current_index < int(undo_steps.size()))
@@ -357,11 +482,147 @@ void UndoManager::validateRedoSteps()
 		if (loaded_state_index > StepList::difference_type(undo_steps.size()))
 			loaded_state_index = -1;
 		
+		compactSpillFile();
+		
 		if (!canRedo())
 			emit canRedoChanged(false);
 	}
 }
 
+std::size_t UndoManager::memoryUsage() const
+{
+	std::size_t usage = 0;
+	for (auto const& step : undo_steps)
+		usage += step->memoryUsage();
+	return usage;
+}
+
+std::size_t UndoManager::memoryLimit() const
+{
+	return memory_limit;
+}
+
+void UndoManager::setMemoryLimit(std::size_t bytes)
+{
+	if (memory_limit != bytes)
+	{
+		memory_limit = bytes;
+		
+		UndoManager::State const old_state(this);
+		enforceMemoryLimit();
+		emitChangedSignals(old_state);
+	}
+}
+
+bool UndoManager::isSpillingEnabled() const
+{
+	return spilling_enabled;
+}
+
+void UndoManager::setSpillingEnabled(bool enabled)
+{
+	spilling_enabled = enabled;
+}
+
+qint64 UndoManager::spillFileSize() const
+{
+	return spill_file ? spill_file->size() : 0;
+}
+
+void UndoManager::enforceMemoryLimit()
+{
+	// The next undo step is always retained in memory.
+	auto const num_candidates = current_index - 1;
+	if (memory_limit == 0 || num_candidates <= 0)
+		return;
+	
+	auto usage = memoryUsage();
+	if (usage <= memory_limit)
+		return;
+	
+	if (spilling_enabled)
+	{
+		for (int i = 0; i < num_candidates && usage > memory_limit; ++i)
+		{
+			auto& step = undo_steps[StepList::size_type(i)];
+			if (dynamic_cast<SpilledUndoStep*>(step.get()))
+				continue;
+			
+			auto spilled_step = spill(*step);
+			if (!spilled_step)
+				break;  // Fall back to removing steps
+			
+			usage = usage - step->memoryUsage() + spilled_step->memoryUsage();
+			step = std::move(spilled_step);
+		}
+	}
+	
+	int num_removed_undo_steps = 0;
+	for (; num_removed_undo_steps < num_candidates && usage > memory_limit; ++num_removed_undo_steps)
+		usage -= undo_steps[StepList::size_type(num_removed_undo_steps)]->memoryUsage();
+	removeOldestUndoSteps(num_removed_undo_steps);
+}
+
+std::unique_ptr<UndoStep> UndoManager::spill(const UndoStep& step)
+{
+	if (!spill_file)
+	{
+		spill_file = std::make_unique<QTemporaryFile>();
+		if (!spill_file->open())
+		{
+			qWarning("Cannot open a temporary file for the undo history");
+			spill_file.reset();
+			return {};
+		}
+	}
+	return SpilledUndoStep::spill(step, map, *spill_file);
+}
+
+void UndoManager::compactSpillFile()
+{
+	if (!spill_file)
+		return;
+	
+	std::vector<SpilledUndoStep*> spilled_steps;
+	qint64 used_size = 0;
+	for (auto const& step : undo_steps)
+	{
+		if (auto* spilled = dynamic_cast<SpilledUndoStep*>(step.get()))
+		{
+			spilled_steps.push_back(spilled);
+			used_size += spilled->dataSize();
+		}
+	}
+	
+	if (spilled_steps.empty())
+	{
+		spill_file.reset();
+		return;
+	}
+	
+	if (spill_file->size() <= 2 * used_size)
+		return;
+	
+	auto compacted_file = std::make_unique<QTemporaryFile>();
+	if (!compacted_file->open())
+		return;  // Keep using the current file
+	
+	std::vector<qint64> offsets;
+	offsets.reserve(spilled_steps.size());
+	for (auto const* spilled : spilled_steps)
+	{
+		auto const offset = spilled->copyTo(*compacted_file);
+		if (offset < 0)
+			return;  // Keep using the current file
+		offsets.push_back(offset);
+	}
+	
+	for (std::size_t i = 0; i < spilled_steps.size(); ++i)
+		spilled_steps[i]->relocate(*compacted_file, offsets[i]);
+	spill_file = std::move(compacted_file);
+}
+
+
 void UndoManager::emitChangedSignals(const UndoManager::State& old_state)
 {
 	bool const is_clean = isClean();
@@ -434,6 +695,69 @@ void UndoManager::saveRedo(QXmlStreamWriter& xml) const
 }
 
 
+bool UndoManager::saveChanges(QXmlStreamWriter& xml) const
+{
+	if (clean_state_index < 0 || !map)
+		return false;
+	
+	auto const first = begin(undo_steps) + std::min(clean_state_index, current_index);
+	auto const last  = begin(undo_steps) + std::max(clean_state_index, current_index);
+	if (!std::all_of(first, last, [](auto& step) { return step->isValid(); }))
+		return false;
+	
+	// Track the objects of the current state back to the clean state:
+	// Undo steps are executed from the last one, redo steps from the first one.
+	std::map<int, TrackedObjects> clean_parts;
+	auto const track = [this, &clean_parts](auto& step) {
+		return trackStep(*step, *map, clean_parts);
+	};
+	auto const tracked = (current_index > clean_state_index)
+	                     ? std::all_of(std::make_reverse_iterator(last), std::make_reverse_iterator(first), track)
+	                     : std::all_of(first, last, track);
+	if (!tracked)
+		return false;
+	
+	// In each part, delete the objects which are not unchanged in the clean
+	// state, and add the objects which are not unchanged in the current state.
+	for (auto const& clean_part : clean_parts)
+	{
+		auto const part_index = clean_part.first;
+		auto const& clean_objects = clean_part.second;
+		
+		DeleteObjectsUndoStep delete_step(map);
+		delete_step.setPartIndex(part_index);
+		for (std::size_t i = 0; i < clean_objects.size(); ++i)
+		{
+			if (!clean_objects[i])
+				delete_step.addObject(int(i));
+		}
+		
+		std::unordered_set<const Object*> unchanged(begin(clean_objects), end(clean_objects));
+		AddObjectsUndoStep add_step(map);
+		add_step.setPartIndex(part_index);
+		auto const* part = map->getPart(std::size_t(part_index));
+		for (int i = 0; i < part->getNumObjects(); ++i)
+		{
+			auto const* object = part->getObject(i);
+			if (!unchanged.count(object))
+				add_step.addObject(i, object->duplicate());
+		}
+		
+		if (!delete_step.isEmpty())
+		{
+			delete_step.save(xml);
+			writeLineBreak(xml);
+		}
+		if (!add_step.isEmpty())
+		{
+			add_step.save(xml);
+			writeLineBreak(xml);
+		}
+	}
+	return true;
+}
+
+
 void UndoManager::loadUndo(QXmlStreamReader& xml, SymbolDictionary& symbol_dict)
 {
 	Q_ASSERT(xml.name() == QLatin1String("undo"));
@@ -449,6 +773,7 @@ void UndoManager::loadUndo(QXmlStreamReader& xml, SymbolDictionary& symbol_dict)
 	current_index = int(undo_steps.size());
 	setLoaded();
 	setClean();
+	enforceMemoryLimit();
 	emitChangedSignals(old_state);
 }
 
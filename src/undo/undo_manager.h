@@ -27,11 +27,13 @@
 #include <memory>
 #include <vector>
 
+#include <QtGlobal>
 #include <QObject>
 #include <QString>
 
 #include "core/symbols/symbol.h"
 
+class QTemporaryFile;
 class QWidget;
 class QXmlStreamReader;
 class QXmlStreamWriter;
@@ -194,13 +196,74 @@ public:
 	 */
 	void loadRedo(QXmlStreamReader& xml, SymbolDictionary& symbol_dict);
 	
+	/**
+	 * Saves the changes from the clean state to the current state in xml format.
+	 * 
+	 * The changes are written as a sequence of steps. When these steps are
+	 * loaded and executed in order on the map in clean state, they produce
+	 * the current state.
+	 * 
+	 * The steps are derived without executing the steps between the clean
+	 * state and the current state: For each modified map part, the objects
+	 * which differ from the clean state are deleted, and the objects which
+	 * differ in the current state are added. The map is not modified.
+	 * 
+	 * Returns false, without writing anything, if the clean state is not
+	 * reachable through valid steps, or if these steps change map parts.
+	 */
+	bool saveChanges(QXmlStreamWriter& xml) const;
+	
+	
+	/**
+	 * Returns an estimate of the memory occupied by all undo and redo steps,
+	 * in bytes.
+	 */
+	std::size_t memoryUsage() const;
+	
+	/**
+	 * Returns the memory limit for the undo history, in bytes.
+	 * 
+	 * A value of 0 means that there is no limit other than max_undo_steps.
+	 */
+	std::size_t memoryLimit() const;
+	
+	/**
+	 * Sets the memory limit for the undo history, in bytes.
+	 * 
+	 * When the estimated memory usage exceeds this limit, the oldest undo
+	 * steps are spilled to a temporary file (if enabled), or removed.
+	 * The step for the next undo() is always retained in memory.
+	 * 
+	 * A value of 0 disables the limit.
+	 */
+	void setMemoryLimit(std::size_t bytes);
+	
+	/**
+	 * Returns true if old undo steps are spilled to a temporary file
+	 * rather than removed when the memory limit is exceeded.
+	 */
+	bool isSpillingEnabled() const;
+	
+	/**
+	 * Controls whether old undo steps are spilled to a temporary file
+	 * rather than removed when the memory limit is exceeded.
+	 */
+	void setSpillingEnabled(bool enabled);
+	
+	/**
+	 * Returns the size of the temporary file which stores spilled steps.
+	 * 
+	 * Returns 0 when there is no such file.
+	 */
+	qint64 spillFileSize() const;
+	
 	
 	/**
 	 * The maximum number of steps kept for undo() and redo(), respectively.
 	 * 
-	 * This limits the amount of memory occupied by undo steps.
+	 * This limits the number of undo steps regardless of their size.
 	 * 
-	 * @todo Make this configurable (maybe by used memory instead of step count)
+	 * @see setMemoryLimit()
 	 */
 	static constexpr std::size_t max_undo_steps = 128;
 	
@@ -258,6 +321,20 @@ protected:
 	 */
 	void validateRedoSteps();
 	
+	/**
+	 * Spills or removes the oldest undo steps while the memory usage
+	 * exceeds the memory limit.
+	 */
+	void enforceMemoryLimit();
+	
+	/**
+	 * Removes the given number of steps from the beginning of undo_steps.
+	 * 
+	 * Updates current_index, clean_state_index and loaded_state_index,
+	 * and emits canUndoChanged(false) when no undo step is left.
+	 */
+	void removeOldestUndoSteps(int num_removed_undo_steps);
+	
 	
 	/**
 	 * Keeps the state of an UndoManager.
@@ -294,6 +371,30 @@ protected:
 private:
 	StepList loadSteps(QXmlStreamReader& xml, SymbolDictionary& symbol_dict) const;
 	
+	/**
+	 * Writes the given step to the spill file.
+	 * 
+	 * Returns the replacement step, or nullptr on error.
+	 */
+	std::unique_ptr<UndoStep> spill(const UndoStep& step);
+	
+	/**
+	 * Reclaims the space of spilled steps which were removed or restored.
+	 * 
+	 * Discards the spill file when no spilled step is left. Otherwise,
+	 * when most of the file is no longer used, copies the remaining data
+	 * to a new file.
+	 */
+	void compactSpillFile();
+	
+	/**
+	 * The temporary file which stores spilled undo steps.
+	 * 
+	 * It is created when needed, compacted by compactSpillFile(),
+	 * and discarded by clear().
+	 */
+	std::unique_ptr<QTemporaryFile> spill_file;
+	
 	/**
 	 * The list of all steps available for undo() and redo().
 	 * 
@@ -335,6 +436,18 @@ private:
 	 */
 	int loaded_state_index;
 	
+	/**
+	 * The memory limit in bytes, or 0 for no limit.
+	 * 
+	 * @see setMemoryLimit()
+	 */
+	std::size_t memory_limit = 0;
+	
+	/**
+	 * Controls whether old undo steps are spilled to spill_file.
+	 */
+	bool spilling_enabled = false;
+	
 };
 
 
@@ -0,0 +1,287 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "gzip_device.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <QtGlobal>
+#include <QString>
+
+#include <zlib.h>
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/// Maximum window size, gzip header and trailer.
+constexpr int window_bits = 15 + 16;
+
+/// The size of the buffer for compressed data.
+constexpr int buffer_size = 64 * 1024;
+
+constexpr auto max_chunk_size = qint64(std::numeric_limits<uInt>::max());
+
+
+}  // namespace
+
+
+
+GzipDevice::GzipDevice(QIODevice* device, QObject* parent)
+: QIODevice(parent)
+, device(device)
+{
+	// nothing else
+}
+
+GzipDevice::~GzipDevice()
+{
+	if (isOpen())
+		close();
+}
+
+
+// static
+bool GzipDevice::isGzipData(const char* data, qint64 size)
+{
+	return size >= 2
+	       && static_cast<unsigned char>(data[0]) == 0x1f
+	       && static_cast<unsigned char>(data[1]) == 0x8b;
+}
+
+// static
+bool GzipDevice::isGzipData(QIODevice& device)
+{
+	auto const head = device.peek(2);
+	return isGzipData(head.constData(), head.size());
+}
+
+// static
+QByteArray GzipDevice::uncompressedHead(const char* data, int size, int max_size)
+{
+	z_stream head = {};
+	if (size <= 0 || max_size <= 0 || inflateInit2(&head, window_bits) != Z_OK)
+		return {};
+	
+	QByteArray result(max_size, Qt::Uninitialized);
+	head.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+	head.avail_in = uInt(size);
+	head.next_out = reinterpret_cast<Bytef*>(result.data());
+	head.avail_out = uInt(max_size);
+	// Truncated input is expected here, so the result code doesn't matter.
+	inflate(&head, Z_SYNC_FLUSH);
+	result.resize(max_size - int(head.avail_out));
+	inflateEnd(&head);
+	return result;
+}
+
+
+
+void GzipDevice::setCompressionLevel(int level)
+{
+	this->level = qBound(1, level, 9);
+}
+
+
+
+bool GzipDevice::isSequential() const
+{
+	return true;
+}
+
+
+bool GzipDevice::open(OpenMode mode)
+{
+	if (isOpen() || !device)
+		return false;
+	
+	stream = std::make_unique<z_stream>();
+	auto result = Z_VERSION_ERROR;
+	switch (mode & QIODevice::ReadWrite)
+	{
+	case QIODevice::ReadOnly:
+		if (device->isReadable())
+			result = inflateInit2(stream.get(), window_bits);
+		break;
+	case QIODevice::WriteOnly:
+		if (device->isWritable())
+			result = deflateInit2(stream.get(), level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY);
+		break;
+	default:
+		break;
+	}
+	if (result != Z_OK)
+	{
+		stream.reset();
+		setErrorString(tr("Cannot open the device for compressed data."));
+		return false;
+	}
+	
+	buffer.resize(buffer_size);
+	stream_end = false;
+	failed = false;
+	return QIODevice::open(mode);
+}
+
+
+bool GzipDevice::finish()
+{
+	if (stream && !stream_end && (openMode() & QIODevice::WriteOnly))
+	{
+		stream->next_in = nullptr;
+		stream->avail_in = 0;
+		if (!failed)
+			deflateInput(Z_FINISH);
+		stream_end = true;
+	}
+	return !failed;
+}
+
+
+void GzipDevice::close()
+{
+	if (stream)
+	{
+		if (openMode() & QIODevice::WriteOnly)
+		{
+			finish();
+			deflateEnd(stream.get());
+		}
+		else
+		{
+			inflateEnd(stream.get());
+		}
+		stream.reset();
+	}
+	QIODevice::close();
+}
+
+
+bool GzipDevice::atEnd() const
+{
+	return (stream_end || failed) && QIODevice::atEnd();
+}
+
+
+qint64 GzipDevice::readData(char* data, qint64 max_size)
+{
+	if (failed)
+		return -1;
+	if (stream_end || max_size <= 0)
+		return 0;
+	
+	auto const available = uInt(std::min(max_size, max_chunk_size));
+	stream->next_out = reinterpret_cast<Bytef*>(data);
+	stream->avail_out = available;
+	while (stream->avail_out > 0)
+	{
+		if (stream->avail_in == 0)
+		{
+			auto const size = device->read(buffer.data(), buffer.size());
+			if (size < 0)
+			{
+				setErrorString(device->errorString());
+				failed = true;
+				break;
+			}
+			if (size == 0)
+			{
+				if (device->atEnd())
+				{
+					setErrorString(tr("Unexpected end of compressed data."));
+					failed = true;
+				}
+				break;
+			}
+			stream->next_in = reinterpret_cast<Bytef*>(buffer.data());
+			stream->avail_in = uInt(size);
+		}
+		
+		auto const result = inflate(stream.get(), Z_NO_FLUSH);
+		if (result == Z_STREAM_END)
+		{
+			stream_end = true;
+			break;
+		}
+		if (result != Z_OK)
+		{
+			setErrorString(stream->msg ? QString::fromLatin1(stream->msg) : tr("Invalid compressed data."));
+			failed = true;
+			break;
+		}
+	}
+	
+	auto const count = qint64(available - stream->avail_out);
+	return (count == 0 && failed) ? -1 : count;
+}
+
+
+qint64 GzipDevice::writeData(const char* data, qint64 size)
+{
+	if (failed || stream_end)
+		return -1;
+	
+	for (auto remaining = size; remaining > 0; )
+	{
+		auto const chunk = std::min(remaining, max_chunk_size);
+		stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+		stream->avail_in = uInt(chunk);
+		if (!deflateInput(Z_NO_FLUSH))
+			return -1;
+		data += chunk;
+		remaining -= chunk;
+	}
+	return size;
+}
+
+
+bool GzipDevice::deflateInput(int flush)
+{
+	for (;;)
+	{
+		stream->next_out = reinterpret_cast<Bytef*>(buffer.data());
+		stream->avail_out = uInt(buffer.size());
+		auto const result = deflate(stream.get(), flush);
+		if (result == Z_STREAM_ERROR)
+		{
+			setErrorString(tr("Invalid compressed data."));
+			failed = true;
+			return false;
+		}
+		
+		auto const count = buffer.size() - int(stream->avail_out);
+		if (count > 0 && device->write(buffer.constData(), count) != count)
+		{
+			setErrorString(device->errorString());
+			failed = true;
+			return false;
+		}
+		
+		// Without Z_FINISH, all input is consumed when output space is left.
+		if (flush == Z_FINISH ? result == Z_STREAM_END : stream->avail_out > 0)
+			return true;
+	}
+}
+
+
+}  // namespace OpenOrienteering
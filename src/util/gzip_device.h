@@ -0,0 +1,141 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_GZIP_DEVICE_H
+#define OPENORIENTEERING_GZIP_DEVICE_H
+
+#include <memory>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QIODevice>
+
+struct z_stream_s;
+
+namespace OpenOrienteering {
+
+
+/**
+ * A sequential device which compresses or decompresses gzip data.
+ * 
+ * The device streams data to or from another device, the source or sink,
+ * which must remain valid while this device is open. Only small, fixed-size
+ * buffers are used, so memory use does not depend on the size of the data.
+ * 
+ * The device can be opened either for reading, decompressing the data read
+ * from the source, or for writing, compressing the data before it is written
+ * to the sink. When writing, the compressed stream is completed by finish()
+ * or close().
+ */
+class GzipDevice : public QIODevice
+{
+	Q_OBJECT
+	
+public:
+	/**
+	 * Constructs a device which reads from or writes to the given device.
+	 */
+	explicit GzipDevice(QIODevice* device, QObject* parent = nullptr);
+	
+	GzipDevice(const GzipDevice&) = delete;
+	GzipDevice& operator=(const GzipDevice&) = delete;
+	
+	~GzipDevice() override;
+	
+	/**
+	 * Returns true if the data starts with the gzip magic bytes.
+	 */
+	static bool isGzipData(const char* data, qint64 size);
+	
+	/**
+	 * Returns true if the device's upcoming data starts with the gzip magic bytes.
+	 * 
+	 * This does not consume any data from the device.
+	 */
+	static bool isGzipData(QIODevice& device);
+	
+	/**
+	 * Decompresses the beginning of gzip data.
+	 * 
+	 * Returns at most max_size bytes, or less if the input is too short.
+	 * This is meant for the detection of the format of compressed files.
+	 */
+	static QByteArray uncompressedHead(const char* data, int size, int max_size);
+	
+	
+	/**
+	 * Returns the compression level, from 1 (fastest) to 9 (best).
+	 */
+	int compressionLevel() const { return level; }
+	
+	/**
+	 * Sets the compression level for writing.
+	 * 
+	 * The level must be set before the device is opened.
+	 */
+	void setCompressionLevel(int level);
+	
+	
+	bool isSequential() const override;
+	
+	/**
+	 * Opens the device.
+	 * 
+	 * The mode must be either ReadOnly or WriteOnly. The underlying device
+	 * must already be open in a compatible mode.
+	 */
+	bool open(OpenMode mode) override;
+	
+	/**
+	 * Completes the compressed stream when writing.
+	 * 
+	 * Returns false on error. It is safe to call this function more than once.
+	 */
+	bool finish();
+	
+	/**
+	 * Completes the compressed stream if needed, and closes the device.
+	 * 
+	 * The underlying device is not closed.
+	 */
+	void close() override;
+	
+	bool atEnd() const override;
+
+protected:
+	qint64 readData(char* data, qint64 max_size) override;
+	
+	qint64 writeData(const char* data, qint64 size) override;
+
+private:
+	bool deflateInput(int flush);
+	
+	QIODevice* device;
+	std::unique_ptr<z_stream_s> stream;
+	QByteArray buffer;
+	int level = 6;
+	bool stream_end = false;
+	bool failed = false;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
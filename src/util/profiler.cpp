@@ -0,0 +1,220 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QIODevice>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <QThread>
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/**
+ * The recorded data.
+ * 
+ * All members are guarded by the mutex.
+ */
+struct ProfilerData
+{
+	QMutex mutex;
+	std::vector<Profiler::Event> trace;         ///< ring buffer
+	std::size_t trace_next = 0;                 ///< next slot in the ring buffer
+	std::unordered_map<const char*, Profiler::Statistics> frame;
+	qint64 frame_start = 0;
+};
+
+ProfilerData& data()
+{
+	static ProfilerData instance;
+	return instance;
+}
+
+const QElapsedTimer& epoch()
+{
+	static auto const timer = []() { QElapsedTimer t; t.start(); return t; }();
+	return timer;
+}
+
+QString trace_path;
+
+void writeTraceOnExit()
+{
+	if (!Profiler::writeChromeTrace(trace_path))
+		qWarning("Could not write the profiler trace to %s", qPrintable(trace_path));
+}
+
+}  // namespace
+
+
+
+std::atomic<bool> Profiler::enabled { false };
+
+constexpr std::size_t Profiler::trace_capacity;
+
+
+// static
+void Profiler::setEnabled(bool value)
+{
+	if (value)
+		epoch();  // Initialize the epoch before the first measurement.
+	enabled.store(value);
+}
+
+
+// static
+void Profiler::setupFromEnvironment()
+{
+	if (qEnvironmentVariableIsSet("MAPPER_PROFILE"))
+		setEnabled(true);
+	
+	if (qEnvironmentVariableIsSet("MAPPER_PROFILE_TRACE"))
+	{
+		trace_path = QString::fromLocal8Bit(qgetenv("MAPPER_PROFILE_TRACE"));
+		setEnabled(true);
+		qAddPostRoutine(&writeTraceOnExit);
+	}
+}
+
+
+// static
+qint64 Profiler::now() noexcept
+{
+	return epoch().nsecsElapsed();
+}
+
+
+// static
+void Profiler::record(const char* name, qint64 start, qint64 duration)
+{
+	auto const thread = quintptr(QThread::currentThreadId());
+	auto& d = data();
+	QMutexLocker lock(&d.mutex);
+	
+	if (d.trace.size() < trace_capacity)
+	{
+		d.trace.push_back({ name, start, duration, thread });
+	}
+	else
+	{
+		d.trace[d.trace_next] = { name, start, duration, thread };
+		d.trace_next = (d.trace_next + 1) % trace_capacity;
+	}
+	
+	auto& statistics = d.frame[name];
+	statistics.name = name;
+	++statistics.count;
+	statistics.total += duration;
+	statistics.maximum = std::max(statistics.maximum, duration);
+}
+
+
+// static
+Profiler::Frame Profiler::takeFrame()
+{
+	auto const frame_end = now();
+	auto& d = data();
+	QMutexLocker lock(&d.mutex);
+	
+	auto result = Frame { frame_end - d.frame_start, {} };
+	result.scopes.reserve(d.frame.size());
+	for (auto const& entry : d.frame)
+		result.scopes.push_back(entry.second);
+	std::sort(begin(result.scopes), end(result.scopes), [](auto const& a, auto const& b) {
+		return a.total > b.total;
+	});
+	
+	d.frame.clear();
+	d.frame_start = frame_end;
+	return result;
+}
+
+
+// static
+void Profiler::clear()
+{
+	auto& d = data();
+	QMutexLocker lock(&d.mutex);
+	d.trace.clear();
+	d.trace_next = 0;
+	d.frame.clear();
+	d.frame_start = now();
+}
+
+
+// static
+bool Profiler::writeChromeTrace(QIODevice& device)
+{
+	auto& d = data();
+	QMutexLocker lock(&d.mutex);
+	
+	// Oldest events first
+	auto events = std::vector<Event>();
+	events.reserve(d.trace.size());
+	events.insert(events.end(), d.trace.begin() + std::ptrdiff_t(d.trace_next), d.trace.end());
+	events.insert(events.end(), d.trace.begin(), d.trace.begin() + std::ptrdiff_t(d.trace_next));
+	lock.unlock();
+	
+	auto const pid = QByteArray::number(QCoreApplication::applicationPid());
+	QByteArray line;
+	bool ok = device.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n") >= 0;
+	for (auto it = events.begin(); ok && it != events.end(); ++it)
+	{
+		// Complete events ("ph":"X"), with timestamps in microseconds
+		line = "{\"name\":\"";
+		line.append(it->name);
+		line.append("\",\"ph\":\"X\",\"ts\":");
+		line.append(QByteArray::number(double(it->start) / 1000, 'f', 3));
+		line.append(",\"dur\":");
+		line.append(QByteArray::number(double(it->duration) / 1000, 'f', 3));
+		line.append(",\"pid\":");
+		line.append(pid);
+		line.append(",\"tid\":");
+		line.append(QByteArray::number(quint64(it->thread)));
+		line.append(std::next(it) == events.end() ? "}\n" : "},\n");
+		ok = device.write(line) == line.size();
+	}
+	return ok && device.write("]}\n") >= 0;
+}
+
+
+// static
+bool Profiler::writeChromeTrace(const QString& path)
+{
+	QFile file(path);
+	return file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+	       && writeChromeTrace(file)
+	       && file.flush();
+}
+
+
+}  // namespace OpenOrienteering
@@ -0,0 +1,189 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef OPENORIENTEERING_UTIL_PROFILER_H
+#define OPENORIENTEERING_UTIL_PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <QtGlobal>
+
+class QIODevice;
+class QString;
+
+namespace OpenOrienteering {
+
+
+/**
+ * @brief A lightweight instrumentation facility for hot paths.
+ * 
+ * Code regions are measured by Profiler::Scope objects. When the profiler
+ * is disabled (the default), a scope costs a single relaxed atomic load.
+ * 
+ * The profiler aggregates the measurements into per-frame statistics which
+ * MapWidget shows as an overlay, and it keeps a bounded trace of recent
+ * events which can be written in the Chrome trace event format for offline
+ * analysis (chrome://tracing, Perfetto).
+ * 
+ * The profiler is enabled at startup when the environment variable
+ * MAPPER_PROFILE is set. If MAPPER_PROFILE_TRACE is set to a file path,
+ * the trace is written to this file when the application exits.
+ * 
+ * Synopsis:
+ * 
+ *     void Object::update() const
+ *     {
+ *         Profiler::Scope profile("Object::update");
+ *         ...
+ *     }
+ * 
+ * Scope names must be string literals (or otherwise outlive the profiler),
+ * and they must not contain characters which need escaping in JSON.
+ * Recording is thread-safe.
+ */
+class Profiler
+{
+public:
+	/**
+	 * A single measurement.
+	 */
+	struct Event
+	{
+		const char* name;
+		qint64 start;     ///< in nanoseconds since the profiler's epoch
+		qint64 duration;  ///< in nanoseconds
+		quintptr thread;
+	};
+	
+	/**
+	 * Aggregated measurements of a single scope name.
+	 */
+	struct Statistics
+	{
+		const char* name;
+		int count;
+		qint64 total;    ///< in nanoseconds
+		qint64 maximum;  ///< in nanoseconds
+	};
+	
+	/**
+	 * Aggregated measurements since the end of the previous frame.
+	 */
+	struct Frame
+	{
+		qint64 duration;  ///< in nanoseconds
+		std::vector<Statistics> scopes;  ///< sorted by decreasing total time
+	};
+	
+	
+	/**
+	 * Measures the lifetime of the object, if the profiler is enabled.
+	 */
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name) noexcept
+		: name(isEnabled() ? name : nullptr)
+		, start(this->name ? now() : 0)
+		{}
+		
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		
+		~Scope()
+		{
+			if (name)
+				record(name, start, now() - start);
+		}
+		
+	private:
+		const char* const name;
+		const qint64 start;
+	};
+	
+	
+	/**
+	 * Returns true if measurements are recorded.
+	 */
+	static bool isEnabled() noexcept { return enabled.load(std::memory_order_relaxed); }
+	
+	/**
+	 * Enables or disables recording.
+	 */
+	static void setEnabled(bool value);
+	
+	/**
+	 * Configures the profiler from the environment.
+	 * 
+	 * \see Profiler
+	 */
+	static void setupFromEnvironment();
+	
+	/**
+	 * Returns the time in nanoseconds since the profiler's epoch.
+	 */
+	static qint64 now() noexcept;
+	
+	/**
+	 * Records a measurement.
+	 */
+	static void record(const char* name, qint64 start, qint64 duration);
+	
+	/**
+	 * Returns the statistics since the previous call, and starts a new frame.
+	 */
+	static Frame takeFrame();
+	
+	/**
+	 * Discards all recorded measurements.
+	 */
+	static void clear();
+	
+	/**
+	 * Writes the recorded trace in the Chrome trace event format.
+	 * 
+	 * Returns false on error.
+	 */
+	static bool writeChromeTrace(QIODevice& device);
+	
+	/**
+	 * Writes the recorded trace to the file with the given path.
+	 * 
+	 * Returns false on error.
+	 */
+	static bool writeChromeTrace(const QString& path);
+	
+	/**
+	 * The maximum number of events kept for the trace.
+	 * 
+	 * When this number is exceeded, the oldest events are discarded.
+	 */
+	static constexpr std::size_t trace_capacity = 1u << 18;
+	
+private:
+	static std::atomic<bool> enabled;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
@@ -22,9 +22,12 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <exception>
+#include <iterator>
 #include <limits>
 #include <stdexcept>
+#include <vector>
 
 #include <QtGlobal>
 #include <QBuffer>
@@ -33,6 +36,7 @@
 #include <QIODevice>
 #include <QLatin1Char>
 #include <QScopedValueRollback>
+#include <QString>
 #include <QTextCodec>
 // IWYU pragma: no_include <qxmlstream.h>
 
@@ -44,6 +48,14 @@
 
 namespace OpenOrienteering {
 
+namespace {
+
+/// The number of coordinates which are formatted in a single chunk.
+constexpr std::size_t coords_per_chunk = 256;
+
+}  // namespace
+
+
 void writeLineBreak(QXmlStreamWriter& xml)
 {
 	if (!xml.autoFormatting())
@@ -188,17 +200,31 @@ void XmlElementWriter::write(const MapCoordVector& coords)
 		// Default: efficient plain text format
 		// Direct UTF-8 writing without unnecessary allocations, escaping or
 		// conversions, but also without handling of device errors.
+		// The text is written in chunks of many coordinates.
 		xml.writeCharacters({});  // Finish the start element
-		MapCoord::StringBuffer<char> buffer;
-		for (auto& coord : coords)
-			device->write(coord.toUtf8(buffer));
+		std::array<char, coords_per_chunk * sizeof(MapCoord::StringBuffer<char>)> buffer;
+		for (auto first = begin(coords); first != end(coords); )
+		{
+			auto const last = first + std::min(std::ptrdiff_t(coords_per_chunk), std::distance(first, end(coords)));
+			auto out = buffer.data();
+			for (; first != last; ++first)
+				out = first->write(out);
+			device->write(buffer.data(), std::distance(buffer.data(), out));
+		}
 	}
 	else
 	{
 		// Default: efficient plain text format
-		MapCoord::StringBuffer<QChar> buffer;
-		for (auto& coord : coords)
-			xml.writeCharacters(coord.toString(buffer));
+		auto const buffer_size = std::min(coords_per_chunk, coords.size()) * std::tuple_size<MapCoord::StringBuffer<QChar>>::value;
+		std::vector<QChar> buffer(buffer_size);
+		for (auto first = begin(coords); first != end(coords); )
+		{
+			auto const last = first + std::min(std::ptrdiff_t(coords_per_chunk), std::distance(first, end(coords)));
+			auto out = buffer.data();
+			for (; first != last; ++first)
+				out = first->write(out);
+			xml.writeCharacters(QString::fromRawData(buffer.data(), int(std::distance(buffer.data(), out))));
+		}
 	}
 }
 
@@ -226,13 +252,9 @@ void XmlElementReader::read(MapCoordVector& coords)
 			}
 			else if (token == QXmlStreamReader::Characters && !xml.isWhitespace())
 			{
-				QStringRef text = xml.text();
 				try
 				{
-					while (text.length())
-					{
-						coords.emplace_back(text);
-					}
+					MapCoord::parse(xml.text(), coords);
 				}
 				catch (std::exception& e)
 				{
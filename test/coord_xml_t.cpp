@@ -20,6 +20,8 @@
 #include "coord_xml_t.h"
 
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 #include <QtTest>
 
@@ -1062,6 +1064,104 @@ void CoordXmlTest::readFastImplementation()
 }
 
 
+void CoordXmlTest::verifyFastImplementation()
+{
+	auto const values = {
+	    0, 1, -1, 9, -10, 99, -100, 12345, -6789, 1000000000,
+	    std::numeric_limits<qint32>::max(), std::numeric_limits<qint32>::min()
+	};
+	
+	MapCoordVector coords;
+	QString expected;
+	for (auto x : values)
+	{
+		for (auto y : values)
+		{
+			for (auto flags : { 0, 1, 16, 255 })
+			{
+				coords.push_back(MapCoord::fromNative(x, y, MapCoord::Flags(flags)));
+				expected += QString::number(x) + QLatin1Char(' ') + QString::number(y);
+				if (flags)
+					expected += QLatin1Char(' ') + QString::number(flags);
+				expected += QLatin1Char(';');
+			}
+		}
+	}
+	
+	XMLFileFormat::active_version = 6; // Activate fast text format.
+	
+	// Writing to a device, as UTF-8
+	QBuffer device;
+	device.open(QBuffer::ReadWrite);
+	{
+		QXmlStreamWriter xml(&device);
+		xml.writeStartElement(QLatin1String("root"));
+		{
+			XmlElementWriter element(xml, QLatin1String("coords"));
+			element.write(coords);
+		}
+		xml.writeEndElement();
+	}
+	QVERIFY(device.data().contains(expected.toUtf8()));
+	
+	// Writing to a string
+	QString string;
+	{
+		QXmlStreamWriter xml(&string);
+		xml.writeStartElement(QLatin1String("root"));
+		{
+			XmlElementWriter element(xml, QLatin1String("coords"));
+			element.write(coords);
+		}
+		xml.writeEndElement();
+	}
+	QVERIFY(string.contains(expected));
+	
+	// Reading
+	for (const auto& data : { device.data(), string.toUtf8() })
+	{
+		QXmlStreamReader xml(data);
+		QVERIFY(xml.readNextStartElement());
+		QVERIFY(xml.readNextStartElement());
+		QCOMPARE(xml.name().toString(), QString::fromLatin1("coords"));
+		MapCoordVector actual;
+		{
+			XmlElementReader element(xml);
+			element.read(actual);
+		}
+		QVERIFY(actual == coords);
+	}
+	
+	// Parsing directly, with whitespace between coordinates
+	auto const text = QString::fromLatin1(" 1 2;\n-3 -4 1;\t5 6 2; ");
+	MapCoordVector parsed;
+	MapCoord::parse(QStringRef(&text), parsed);
+	QCOMPARE(int(parsed.size()), 3);
+	QVERIFY(parsed[1] == MapCoord::fromNative(-3, -4, MapCoord::Flags(1)));
+	
+	// Flags up to max_flags
+	auto const max_flags = QString::fromLatin1("1 2 255;");
+	MapCoord::parse(QStringRef(&max_flags), parsed);
+	QCOMPARE(int(parsed.back().flags()), 255);
+	
+	// Parsing errors
+	for (auto const* invalid : { "1", "1 2", "1 2 ", "1;", "1 -;", "1 2 -1;", "1  2;", "a 2;", "1 2 3 4;", "12345678901234567890 0;",
+	                             "1 2 256;", "1 2 4294967297;", "1 2 123456789012345678;" })
+	{
+		auto const text = QString::fromLatin1(invalid);
+		QVERIFY_EXCEPTION_THROWN(MapCoord::parse(QStringRef(&text), parsed), std::invalid_argument);
+	}
+	for (auto const* invalid : { "1 2 256;", "1 2 4294967297;" })
+	{
+		auto const text = QString::fromLatin1(invalid);
+		auto text_ref = QStringRef(&text);
+		QVERIFY_EXCEPTION_THROWN(MapCoord{text_ref}, std::invalid_argument);
+	}
+	auto const out_of_bounds = QString::fromLatin1("2147483648 0;");
+	QVERIFY_EXCEPTION_THROWN(MapCoord::parse(QStringRef(&out_of_bounds), parsed), std::range_error);
+}
+
+
 bool CoordXmlTest::compare_all(MapCoordVector& coords, MapCoord& expected) const
 {
 	return std::all_of(begin(coords), end(coords), [expected](const MapCoord& coord){ return coord == expected; });
@@ -82,6 +82,9 @@ private slots:
 	void readFastImplementation();
 	void readFastImplementation_data();
 	
+	/** Verifies the fast implementation against QString number conversion. */
+	void verifyFastImplementation();
+
 private:
 	/** The common test data setup. */
 	void common_data();
@@ -20,6 +20,7 @@
 
 #include "file_format_t.h"
 
+#include <algorithm>
 #include <array>
 #include <initializer_list>
 #include <limits>
@@ -30,13 +31,16 @@
 #include <Qt>
 #include <QtGlobal>
 #include <QtTest>
+#include <QApplication>
 #include <QBuffer>
 #include <QByteArray>
+#include <QColor>
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
+#include <QImage>
 #include <QLatin1String>
 #include <QPageSize>
 #include <QPoint>
@@ -45,7 +49,10 @@
 #include <QSize>
 #include <QSizeF>
 #include <QString>
+#include <QStringList>
 #include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
 #include <QVariant>
 
 #include "global.h"
@@ -60,14 +67,22 @@
 #include "core/map_printer.h"
 #include "core/objects/object.h"
 #include "core/objects/text_object.h"
+#include "core/symbols/line_symbol.h"
 #include "core/symbols/symbol.h"
+#include "core/symbols/text_symbol.h"
+#include "fileformats/batch_converter.h"
 #include "fileformats/file_format.h"
 #include "fileformats/file_format_registry.h"
 #include "fileformats/file_import_export.h"
 #include "fileformats/ocd_file_export.h"
 #include "fileformats/ocd_file_format.h"
+#include "fileformats/ocd_types.h"
+#include "fileformats/ocd_types_v12.h"
+#include "fileformats/save_journal.h"
 #include "fileformats/xml_file_format.h"
+#include "fileformats/xml_file_format_p.h"
 #include "templates/template.h"
+#include "undo/object_undo.h"
 #include "undo/undo.h"
 #include "undo/undo_manager.h"
 #include "util/backports.h"  // IWYU pragma: keep
@@ -726,6 +741,510 @@ void FileFormatTest::pristineMapTest()
 
 
 
+void FileFormatTest::parallelLoadTest_data()
+{
+	QTest::addColumn<double>("offset");
+	
+	QTest::newRow("origin") << 0.0;
+	QTest::newRow("out of bounds") << 1000000.0;  // cf. issue_513_high_coordinates
+}
+
+void FileFormatTest::parallelLoadTest()
+{
+	QFETCH(double, offset);
+	
+	Map map {};
+	auto color = new MapColor(QString::fromLatin1("black"), 0);
+	map.addColor(color, 0);
+	auto text_symbol = new TextSymbol();
+	text_symbol->setColor(color);
+	map.addSymbol(text_symbol, 0);
+	auto line_symbol = new LineSymbol();
+	line_symbol->setColor(color);
+	line_symbol->setLineWidth(0.1);
+	map.addSymbol(line_symbol, 1);
+	
+	for (int i = 0; i < 5000; ++i)
+	{
+		auto const x = offset + 10.0 * (i % 100);
+		auto const y = offset + 10.0 * (i / 100);
+		auto text = new TextObject(text_symbol);
+		text->setAnchorPosition(MapCoord(x, y));
+		text->setText(QString::fromUtf8("Text \u00e4 %1 <&>").arg(i));
+		map.addObject(text);
+		
+		auto path = new PathObject(line_symbol);
+		for (int j = 0; j < 10; ++j)
+			path->addCoordinate(MapCoord(x + j, y + (j % 3)));
+		map.addObject(path);
+	}
+	
+	XMLFileFormat format;
+	QBuffer buffer;
+	auto exporter = format.makeExporter({}, &map, nullptr);
+	QVERIFY(bool(exporter));
+	exporter->setDevice(&buffer);
+	QVERIFY(buffer.open(QIODevice::ReadWrite));
+	QVERIFY(exporter->doExport());
+	
+	int parallel_chunks = 0;
+	QString message;
+	auto const load = [&format, &buffer, &parallel_chunks, &message](Map& map, bool parallel) {
+		auto importer = format.makeImporter({}, &map, nullptr);
+		importer->setOption(QStringLiteral("parallelObjects"), parallel);
+		importer->setDevice(&buffer);
+		auto const imported = buffer.seek(0) && importer->doImport();
+		parallel_chunks = static_cast<XMLFileImporter*>(importer.get())->parallelChunkCount();
+		message = importer->warnings().empty() ? QString{} : importer->warnings().back();
+		return imported;
+	};
+	
+	Map sequential_map {};
+	QVERIFY(load(sequential_map, false));
+	QCOMPARE(parallel_chunks, 0);
+	QCOMPARE(sequential_map.getNumObjects(), map.getNumObjects());
+	
+	Map parallel_map {};
+	QVERIFY(load(parallel_map, true));
+	if (QThread::idealThreadCount() > 1)
+		QVERIFY(parallel_chunks > 1);
+	compareMaps(parallel_map, sequential_map);
+	QCOMPARE(parallel_map.printerConfig().print_area, sequential_map.printerConfig().print_area);
+	
+	// Error messages refer to the lines of the document.
+	auto const symbol_pos = buffer.data().lastIndexOf("symbol=\"1\"");
+	QVERIFY(symbol_pos > 0);
+	buffer.buffer()[symbol_pos + 8] = 'x';
+	
+	Map broken_sequential_map {};
+	QVERIFY(!load(broken_sequential_map, false));
+	auto const expected_message = message;
+	auto const line = QString::number(buffer.data().left(symbol_pos).count('\n') + 1);
+	QVERIFY2(expected_message.contains(line), qPrintable(expected_message));
+	
+	Map broken_parallel_map {};
+	QVERIFY(!load(broken_parallel_map, true));
+	QCOMPARE(message, expected_message);
+}
+
+
+void FileFormatTest::compressedFileTest()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto const plain_path = QString{dir.path() + QLatin1String("/map.omap")};
+	auto const compressed_path = QString{dir.path() + QLatin1String("/map.omapz")};
+	
+	Map original {};
+	QVERIFY(original.loadFrom(QStringLiteral("data:/examples/forest sample.omap")));
+	
+	for (auto const& path : { plain_path, compressed_path })
+	{
+		auto exporter = FileFormats.makeExporter(path, &original, nullptr);
+		QVERIFY(bool(exporter));
+		QVERIFY(exporter->doExport());
+	}
+	
+	QFile file(compressed_path);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	auto const head = file.read(2);
+	QCOMPARE(head, QByteArray("\x1f\x8b"));
+	QVERIFY(file.size() < QFileInfo(plain_path).size() / 2);
+	file.close();
+	
+	auto const* format = FileFormats.findFormatForData(compressed_path, FileFormat::MapFile);
+	QVERIFY(format);
+	QCOMPARE(format->id(), "XML");
+	
+	Map compressed_map {};
+	QVERIFY(compressed_map.loadFrom(compressed_path));
+	Map plain_map {};
+	QVERIFY(plain_map.loadFrom(plain_path));
+	compareMaps(compressed_map, plain_map);
+	
+	// Truncated data must not be accepted.
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.resize(file.size() / 2));
+	file.close();
+	Map truncated_map {};
+	auto importer = FileFormats.makeImporter(compressed_path, truncated_map, nullptr);
+	QVERIFY(bool(importer));
+	QVERIFY(!importer->doImport());
+}
+
+
+void FileFormatTest::saveJournalTest()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto const path = QString{dir.path() + QLatin1String("/map.omap")};
+	auto const journal_path = SaveJournal::journalPath(path);
+	
+	Map map {};
+	QVERIFY(map.loadFrom(QStringLiteral("data:/examples/complete map.omap")));
+	map.clearObjectSelection(false);
+	
+	auto const save_map = [&map, &path]() {
+		auto exporter = FileFormats.makeExporter(path, &map, nullptr);
+		return exporter && exporter->doExport();
+	};
+	auto const set_saved = [&map]() {
+		map.setHasUnsavedChanges(false);
+		map.undoManager().setClean();
+	};
+	auto const load_map = [&path](Map& loaded_map) {
+		auto importer = FileFormats.makeImporter(path, loaded_map);
+		QStringList messages;
+		if (!importer || !importer->doImport())
+			messages.append(QStringLiteral("Import failed"));
+		else
+			for (const auto& warning : importer->warnings())
+				messages.append(warning);
+		return messages;
+	};
+	
+	QVERIFY(save_map());
+	set_saved();
+	auto const map_size = QFileInfo(path).size();
+	
+	// The journal must be started after a full save.
+	QVERIFY(!SaveJournal::append(map, path));
+	QVERIFY(SaveJournal::reset(path));
+	
+	// Nothing to append
+	QVERIFY(SaveJournal::append(map, path));
+	
+	auto* part = map.getCurrentPart();
+	QVERIFY(part->getNumObjects() > 10);
+	
+	// Modify an object, and delete two objects
+	{
+		auto* object = part->getObject(5);
+		auto* undo_step = new ReplaceObjectsUndoStep(&map);
+		undo_step->addObject(5, object->duplicate());
+		object->move(1000, -2000);
+		object->update();
+		map.setObjectsDirty();
+		map.push(undo_step);
+	}
+	map.addObjectToSelection(part->getObject(1), false);
+	map.addObjectToSelection(part->getObject(7), false);
+	map.deleteSelectedObjects();
+	{
+		// Appending must not execute the undo steps.
+		QSignalSpy spy(&map, &Map::objectSelectionChanged);
+		QVERIFY(SaveJournal::append(map, path));
+		QCOMPARE(spy.count(), 0);
+	}
+	set_saved();
+	
+	// Undo the deletion
+	QVERIFY(map.undoManager().undo());
+	QVERIFY(SaveJournal::append(map, path));
+	set_saved();
+	
+	// Add an object
+	{
+		auto* object = part->getObject(0)->duplicate();
+		object->move(-3000, 500);
+		part->addObject(object);
+		auto* undo_step = new DeleteObjectsUndoStep(&map);
+		undo_step->addObject(part->findObjectIndex(object));
+		map.setObjectsDirty();
+		map.push(undo_step);
+	}
+	map.addObjectToSelection(part->getObject(3), false);
+	QVERIFY(SaveJournal::append(map, path));
+	QCOMPARE(map.getNumSelectedObjects(), 1);
+	set_saved();
+	map.clearObjectSelection(false);
+	
+	QCOMPARE(QFileInfo(path).size(), map_size);
+	QVERIFY(QFileInfo::exists(journal_path));
+	
+	{
+		Map loaded_map {};
+		QCOMPARE(load_map(loaded_map), QStringList{});
+		compareMaps(loaded_map, map);
+	}
+	
+	// Non-object changes need a full save.
+	map.setColorsDirty();
+	QVERIFY(!SaveJournal::append(map, path));
+	set_saved();
+	
+	// An incomplete entry is ignored.
+	{
+		QFile journal(journal_path);
+		QVERIFY(journal.open(QIODevice::Append));
+		QVERIFY(journal.write("OMJE\x00\x10", 6) == 6);
+	}
+	{
+		Map loaded_map {};
+		QCOMPARE(load_map(loaded_map).size(), 1);
+		compareMaps(loaded_map, map);
+	}
+	
+	// A journal for a different map file is ignored.
+	map.getCurrentPart()->deleteObject(0);
+	QVERIFY(save_map());
+	QVERIFY(!SaveJournal::append(map, path));
+	{
+		Map loaded_map {};
+		QCOMPARE(load_map(loaded_map).size(), 1);
+		compareMaps(loaded_map, map);
+	}
+	QVERIFY(SaveJournal::remove(path));
+	QVERIFY(!QFileInfo::exists(journal_path));
+}
+
+
+void FileFormatTest::autosaveJournalTest()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto const path = QString{dir.path() + QLatin1String("/map.omap")};
+	auto const autosave_path = QString{path + QLatin1String(".autosave")};
+	
+	Map map {};
+	QVERIFY(map.loadFrom(QStringLiteral("data:/examples/complete map.omap")));
+	map.clearObjectSelection(false);
+	auto const num_objects = map.getNumObjects();
+	QVERIFY(num_objects > 2);
+	
+	auto const save_map = [](Map& saved_map, const QString& save_path) {
+		auto exporter = FileFormats.makeExporter(save_path, &saved_map, nullptr);
+		return exporter && exporter->doExport();
+	};
+	auto const load_map = [](Map& loaded_map, const QString& load_path) {
+		auto importer = FileFormats.makeImporter(load_path, loaded_map);
+		return importer && importer->doImport() && importer->warnings().empty();
+	};
+	auto const delete_object = [&map]() {
+		map.addObjectToSelection(map.getCurrentPart()->getObject(0), false);
+		map.deleteSelectedObjects();
+	};
+	
+	// Journal one deletion.
+	QVERIFY(save_map(map, path));
+	QVERIFY(SaveJournal::reset(path));
+	map.undoManager().setClean();
+	delete_object();
+	QVERIFY(SaveJournal::append(map, path));
+	map.undoManager().setClean();
+	
+	// Autosave after another deletion.
+	delete_object();
+	QVERIFY(save_map(map, autosave_path));
+	
+	// Loading the map file replays its journal, for editing as well as for
+	// templates, imports and conversions.
+	{
+		Map loaded_map {};
+		QVERIFY(load_map(loaded_map, path));
+		QCOMPARE(loaded_map.getNumObjects(), num_objects - 1);
+	}
+	{
+		Map template_map {};
+		QVERIFY(template_map.loadFrom(path));
+		QCOMPARE(template_map.getNumObjects(), num_objects - 1);
+	}
+	
+	// Replaying can be disabled.
+	{
+		Map loaded_map {};
+		auto importer = FileFormats.makeImporter(path, loaded_map);
+		QVERIFY(importer);
+		importer->setOption(QString::fromLatin1("replayJournal"), false);
+		QVERIFY(importer->doImport());
+		QCOMPARE(loaded_map.getNumObjects(), num_objects);
+	}
+	
+	// Recovering the autosave file doesn't replay the map file's journal.
+	Map recovered_map {};
+	QVERIFY(load_map(recovered_map, autosave_path));
+	QCOMPARE(recovered_map.getNumObjects(), num_objects - 2);
+	compareMaps(recovered_map, map);
+	
+	// Saving the recovered map needs a full save, which outdates the journal.
+	QVERIFY(save_map(recovered_map, path));
+	{
+		Map loaded_map {};
+		QVERIFY(!load_map(loaded_map, path));
+		QCOMPARE(loaded_map.getNumObjects(), num_objects - 2);
+	}
+	QVERIFY(SaveJournal::reset(path));
+	{
+		Map loaded_map {};
+		QVERIFY(load_map(loaded_map, path));
+		QCOMPARE(loaded_map.getNumObjects(), num_objects - 2);
+		compareMaps(loaded_map, map);
+	}
+}
+
+
+void FileFormatTest::batchConverterTest()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto const input = QString{dir.path() + QLatin1String("/complete map.omap")};
+	QVERIFY(QFile::copy(QStringLiteral("data:/examples/complete map.omap"), input));
+	
+	Map original;
+	QVERIFY(original.loadFrom(input));
+	
+	auto options = BatchConverter::Options{};
+	options.target = QStringLiteral("xmap");
+	options.output_dir = dir.path() + QLatin1String("/out");
+	QVERIFY(QDir(dir.path()).mkdir(QStringLiteral("out")));
+	{
+		BatchConverter converter(options);
+		QVERIFY(!converter.isPrintTarget());
+		QVERIFY(converter.exportFormat());
+		QCOMPARE(converter.outputPath(input), QString{options.output_dir + QLatin1String("/complete map.xmap")});
+		
+		auto const result = converter.convert(input);
+		QVERIFY2(result.success, qPrintable(result.messages.join(QLatin1Char('\n'))));
+		
+		Map converted;
+		QVERIFY(converted.loadFrom(result.output));
+		QCOMPARE(converted.getNumObjects(), original.getNumObjects());
+		QCOMPARE(converted.getNumSymbols(), original.getNumSymbols());
+	}
+	
+	// A format ID selects the format's primary extension.
+	options.target = QStringLiteral("OCD12");
+	{
+		BatchConverter converter(options);
+		QCOMPARE(converter.outputPath(input), QString{options.output_dir + QLatin1String("/complete map.ocd")});
+		auto const result = converter.convert(input);
+		QVERIFY2(result.success, qPrintable(result.messages.join(QLatin1Char('\n'))));
+		
+		// The object index needs the object extents.
+		QFile file(result.output);
+		QVERIFY(file.open(QIODevice::ReadOnly));
+		auto const data = file.readAll();
+		const OcdFile<Ocd::FormatV12> ocd_file(data);
+		auto num_entries = 0;
+		for (auto ocd_object : ocd_file.objects())
+		{
+			const auto& entry = *ocd_object.entry;
+			QVERIFY(entry.bottom_left_bound.x >> 8 <= entry.top_right_bound.x >> 8);
+			QVERIFY(entry.bottom_left_bound.y >> 8 <= entry.top_right_bound.y >> 8);
+			QVERIFY(entry.bottom_left_bound.x != entry.top_right_bound.x
+			        || entry.bottom_left_bound.y != entry.top_right_bound.y);
+			++num_entries;
+		}
+		QVERIFY(num_entries > 0);
+		
+		// Some objects may be split, cf. fuzzyCompareMaps().
+		Map converted;
+		QVERIFY(converted.loadFrom(result.output));
+		QVERIFY(converted.getNumObjects() >= original.getNumObjects());
+		QVERIFY(converted.getNumObjects() <= 2 * original.getNumObjects());
+		auto const converted_extent = converted.calculateExtent();
+		auto const original_extent = original.calculateExtent();
+		QVERIFY(converted_extent.isValid());
+		QVERIFY(qAbs(converted_extent.left() - original_extent.left()) < 2.0);
+		QVERIFY(qAbs(converted_extent.top() - original_extent.top()) < 2.0);
+		QVERIFY(qAbs(converted_extent.right() - original_extent.right()) < 2.0);
+		QVERIFY(qAbs(converted_extent.bottom() - original_extent.bottom()) < 2.0);
+	}
+	
+	// Never overwrite the input.
+	options.target = QStringLiteral("omap");
+	options.output_dir.clear();
+	{
+		BatchConverter converter(options);
+		auto const result = converter.convert(input);
+		QVERIFY(!result.success);
+		QVERIFY(!result.messages.isEmpty());
+	}
+	
+	// Never let conversions write the same file.
+	options.target = QStringLiteral("xmap");
+	options.output_dir = dir.path() + QLatin1String("/out");
+	options.jobs = 2;
+	QVERIFY(QDir(dir.path()).mkdir(QStringLiteral("other")));
+	auto const other_input = QString{dir.path() + QLatin1String("/other/complete map.omap")};
+	QVERIFY(QFile::copy(input, other_input));
+	{
+		BatchConverter converter(options);
+		QVERIFY(converter.outputCollisions({ input }).isEmpty());
+		QCOMPARE(converter.outputCollisions({ input, other_input }).size(), 1);
+		
+		auto const output = converter.outputPath(input);
+		QVERIFY(QFile::remove(output));
+		QString report_text;
+		QTextStream report(&report_text);
+		auto const results = converter.convertAll({ input, other_input }, report);
+		QCOMPARE(int(results.size()), 2);
+		QVERIFY(std::none_of(begin(results), end(results), [](const auto& result) { return result.success; }));
+		QVERIFY(!results.front().messages.isEmpty());
+		QVERIFY(!QFileInfo::exists(output));
+	}
+	
+	// Workers run this executable, cf. main().
+	auto const copy_input = QString{dir.path() + QLatin1String("/copy.omap")};
+	QVERIFY(QFile::copy(input, copy_input));
+	{
+		BatchConverter converter(options);
+		QString report_text;
+		QTextStream report(&report_text);
+		auto const results = converter.convertAll({ input, copy_input }, report);
+		QCOMPARE(int(results.size()), 2);
+		for (const auto& result : results)
+		{
+			QVERIFY2(result.success, qPrintable(result.messages.join(QLatin1Char('\n'))));
+			Map converted;
+			QVERIFY(converted.loadFrom(result.output));
+			QCOMPARE(converted.getNumObjects(), original.getNumObjects());
+		}
+	}
+	
+	options.target = QStringLiteral("no-such-format");
+	QVERIFY(!BatchConverter(options).exportFormat());
+	
+	// Printing, in this process
+	options.jobs = 1;
+	options.resolution = 50;
+	options.target = QStringLiteral("png");
+	if (!BatchConverter(options).isPrintTarget())
+		return;  // No print support
+	
+	{
+		BatchConverter converter(options);
+		auto const result = converter.convert(input);
+		QVERIFY2(result.success, qPrintable(result.messages.join(QLatin1Char('\n'))));
+		QImage image;
+		QVERIFY(image.load(result.output));
+		QVERIFY(!image.isNull());
+		QVERIFY(image.width() > 0);
+		QVERIFY(image.height() > 0);
+		// Not just the white paper
+		auto const white = QColor(Qt::white).rgb();
+		auto has_map_pixels = false;
+		for (int y = 0; y < image.height() && !has_map_pixels; ++y)
+		{
+			for (int x = 0; x < image.width() && !has_map_pixels; ++x)
+				has_map_pixels = image.pixel(x, y) != white;
+		}
+		QVERIFY(has_map_pixels);
+	}
+	
+	options.target = QStringLiteral("pdf");
+	{
+		BatchConverter converter(options);
+		auto const result = converter.convert(input);
+		QVERIFY2(result.success, qPrintable(result.messages.join(QLatin1Char('\n'))));
+		QFile file(result.output);
+		QVERIFY(file.open(QIODevice::ReadOnly));
+		QVERIFY(file.read(5) == "%PDF-");
+	}
+}
+
+
+
 void FileFormatTest::ogrExportTest_data()
 {
 	QTest::addColumn<QString>("map_filepath");
@@ -800,4 +1319,21 @@ namespace  {
 #endif
 
 
-QTEST_MAIN(FileFormatTest)
+/*
+ * The batch converter test runs this executable as a worker process.
+ * Otherwise, this is what QTEST_MAIN does.
+ */
+int main(int argc, char** argv)
+{
+	QApplication app(argc, argv);
+	if (BatchConverter::isRequested(argc, argv))
+	{
+		doStaticInitializations();
+		return BatchConverter::exec(QCoreApplication::arguments());
+	}
+	
+	app.setAttribute(Qt::AA_Use96Dpi, true);
+	FileFormatTest test;
+	QTEST_SET_MAIN_SOURCE_PATH
+	return QTest::qExec(&test, argc, argv);
+}
@@ -76,6 +76,33 @@ private slots:
 	 */
 	void pristineMapTest();
 	
+	/**
+	 * Tests that loading objects in parallel gives the same result as
+	 * sequential loading.
+	 */
+	void parallelLoadTest();
+	void parallelLoadTest_data();
+	
+	/**
+	 * Tests saving and loading the compressed variant of the XML format.
+	 */
+	void compressedFileTest();
+	
+	/**
+	 * Tests appending changes to the save journal, and replaying them.
+	 */
+	void saveJournalTest();
+	
+	/**
+	 * Tests loading and recovering a map file which has a journal.
+	 */
+	void autosaveJournalTest();
+	
+	/**
+	 * Tests the command line batch converter, in-process and with workers.
+	 */
+	void batchConverterTest();
+	
 	/**
 	 * Tests export of geospatial vector data via OGR.
 	 */
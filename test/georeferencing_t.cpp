@@ -21,18 +21,21 @@
 
 #include <cmath>
 #include <cstddef>
+#include <vector>
 
 #include <QtMath>
 #include <QtTest>
 #include <QLineF>
 #include <QPoint>
 #include <QPointF>
+#include <QRectF>
 
 #include <geodesic.h>
 #ifndef ACCEPT_USE_OF_DEPRECATED_PROJ_API_H
 #  include <proj.h>
 #endif
 
+#include "core/approximate_transform.h"
 #include "core/crs_template.h"
 #include "core/georeferencing.h"
 #include "core/latlon.h"
@@ -336,6 +339,120 @@ void GeoreferencingTest::testProjection()
 }
 
 
+void GeoreferencingTest::testBatchProjection()
+{
+	Georeferencing georef;
+	QVERIFY(georef.setProjectedCRS(utm32_spec, utm32_spec));
+	georef.setScaleDenominator(10000);
+	georef.setProjectedRefPoint({ 398125.0, 5579523.0 });
+	georef.setGrivation(2.5);
+	
+	std::vector<LatLon> lat_lon;
+	for (int i = 0; i < 20; ++i)
+	{
+		for (int j = 0; j < 20; ++j)
+			lat_lon.emplace_back(50.0 + 0.01 * i, 7.5 + 0.01 * j);
+	}
+	
+	bool ok = false;
+	auto map_coords = georef.toMapCoordF(lat_lon, &ok);
+	QVERIFY(ok);
+	QCOMPARE(map_coords.size(), lat_lon.size());
+	for (std::size_t i = 0; i < lat_lon.size(); ++i)
+	{
+		bool single_ok = false;
+		auto expected = georef.toMapCoordF(lat_lon[i], &single_ok);
+		QVERIFY(single_ok);
+		QVERIFY(map_coords[i].distanceTo(expected) < 0.001);  // mm
+	}
+	
+	ok = false;
+	auto geographic = georef.toGeographicCoords(map_coords, &ok);
+	QVERIFY(ok);
+	QCOMPARE(geographic.size(), map_coords.size());
+	for (std::size_t i = 0; i < map_coords.size(); ++i)
+	{
+		QVERIFY(std::fabs(geographic[i].latitude() - lat_lon[i].latitude()) < 1e-7);
+		QVERIFY(std::fabs(geographic[i].longitude() - lat_lon[i].longitude()) < 1e-7);
+	}
+	
+	// Empty input is valid.
+	ok = false;
+	QVERIFY(georef.toMapCoordF(std::vector<LatLon>{}, &ok).empty());
+	QVERIFY(ok);
+}
+
+
+void GeoreferencingTest::testApproximateTransform_data()
+{
+	QTest::addColumn<int>("scale");
+	QTest::addColumn<double>("max_error");
+	
+	QTest::newRow("1:10000, 0.1 mm")    << 10000 << 0.1;
+	QTest::newRow("1:10000, 0.01 mm")   << 10000 << 0.01;
+	QTest::newRow("1:10000, 0.001 mm")  << 10000 << 0.001;
+	QTest::newRow("1:100000, 0.01 mm")  << 100000 << 0.01;
+}
+
+void GeoreferencingTest::testApproximateTransform()
+{
+	QFETCH(int, scale);
+	QFETCH(double, max_error);
+	
+	Georeferencing georef;
+	QVERIFY(georef.setProjectedCRS(utm32_spec, utm32_spec));
+	georef.setScaleDenominator(scale);
+	georef.setProjectedRefPoint({ 398125.0, 5579523.0 });
+	georef.setGrivation(2.5);
+	
+	// About 20 km x 20 km
+	auto const domain = QRectF { 7.4, 50.3, 0.3, 0.2 };
+	auto transform = georef.approximateMapTransform(domain, max_error);
+	QCOMPARE(transform.maxError(), max_error);
+	
+	auto const n = 100;
+	for (int i = 0; i <= n; ++i)
+	{
+		for (int j = 0; j <= n; ++j)
+		{
+			// Irregular steps, not aligned to the grid
+			auto const lon = domain.left() + domain.width() * std::pow(double(i) / n, 1.1);
+			auto const lat = domain.top() + domain.height() * std::pow(double(j) / n, 0.9);
+			QPointF approximate;
+			QVERIFY(transform.transform({ lon, lat }, approximate));
+			bool ok = false;
+			auto const exact = georef.toMapCoordF(LatLon(lat, lon), &ok);
+			QVERIFY(ok);
+			auto const error = QLineF(exact, approximate).length();
+			if (error > max_error)
+				QCOMPARE(error, max_error);
+		}
+	}
+	QVERIFY(transform.exactEvaluations() < (n+1) * (n+1) / 4);
+	
+	// Points outside of the domain are transformed exactly.
+	auto const outside = LatLon { 50.25, 7.55 };
+	QPointF approximate;
+	QVERIFY(transform.transform({ outside.longitude(), outside.latitude() }, approximate));
+	QCOMPARE(approximate, QPointF(georef.toMapCoordF(outside)));
+	
+	// Bulk conversion
+	std::vector<LatLon> lat_lon;
+	for (int i = 0; i < 1000; ++i)
+		lat_lon.emplace_back(50.3 + 0.0002 * i, 7.4 + 0.0003 * i - 0.0000002 * i * i);
+	bool ok = false;
+	auto const map_coords = georef.toMapCoordFApproximate(lat_lon, max_error, &ok);
+	QVERIFY(ok);
+	QCOMPARE(map_coords.size(), lat_lon.size());
+	for (std::size_t i = 0; i < lat_lon.size(); ++i)
+	{
+		auto const error = map_coords[i].distanceTo(georef.toMapCoordF(lat_lon[i]));
+		if (error > max_error)
+			QCOMPARE(error, max_error);
+	}
+}
+
+
 
 #ifndef ACCEPT_USE_OF_DEPRECATED_PROJ_API_H
 
@@ -69,6 +69,18 @@ private slots:
 	
 	void testProjection_data();
 	
+	/**
+	 * Tests whether batch transformations match single point transformations.
+	 */
+	void testBatchProjection();
+	
+	/**
+	 * Tests whether the approximate transformation meets the estimated error bound.
+	 */
+	void testApproximateTransform();
+	
+	void testApproximateTransform_data();
+	
 #ifndef ACCEPT_USE_OF_DEPRECATED_PROJ_API_H
 	/**
 	 * Tests whether the `proj_context_set_file_finder()` function is working.
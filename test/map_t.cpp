@@ -19,9 +19,21 @@
 
 #include "map_t.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
 #include <QtTest>
 #include <QBuffer>
+#include <QColor>
+#include <QImage>
 #include <QMessageBox>
+#include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QSizeF>
 #include <QTextStream>
 
 #include "test_config.h"
@@ -29,10 +41,12 @@
 #include "global.h"
 #include "core/map.h"
 #include "core/map_color.h"
+#include "core/map_part.h"
 #include "core/map_printer.h" // IWYU pragma: keep
 #include "core/map_view.h"
 #include "core/objects/object.h"
 #include "core/objects/symbol_rule_set.h"
+#include "core/renderables/renderable.h"
 #include "core/symbols/symbol.h"
 #include "core/symbols/point_symbol.h"
 
@@ -172,6 +186,383 @@ void MapTest::specialColorsTest()
 	QCOMPARE(cmap.getColor(cmap.getNumColors()), static_cast<MapColor*>(nullptr));
 }
 
+void MapTest::findIndexTest()
+{
+	Map map;
+	for (int i = 0; i < 4; ++i)
+		map.addSymbol(new PointSymbol(), i);
+	auto* const s0 = map.getSymbol(0);
+	auto* const s1 = map.getSymbol(1);
+	auto* const s2 = map.getSymbol(2);
+	auto* const s3 = map.getSymbol(3);
+	QCOMPARE(map.findSymbolIndex(s0), 0);
+	QCOMPARE(map.findSymbolIndex(s3), 3);
+	QCOMPARE(map.findSymbolIndex(nullptr), -1);
+	QCOMPARE(map.findSymbolIndex(map.getUndefinedPoint()), -2);
+	QCOMPARE(map.findSymbolIndex(map.getUndefinedLine()), -3);
+	
+	map.moveSymbol(0, 3);
+	QCOMPARE(map.findSymbolIndex(s0), 2);
+	QCOMPARE(map.findSymbolIndex(s1), 0);
+	QCOMPARE(map.findSymbolIndex(s2), 1);
+	QCOMPARE(map.findSymbolIndex(s3), 3);
+	
+	auto* const replacement = new PointSymbol();
+	map.setSymbol(replacement, 1);
+	QCOMPARE(map.findSymbolIndex(replacement), 1);
+	QCOMPARE(map.findSymbolIndex(s1), 0);
+	QCOMPARE(map.findSymbolIndex(s3), 3);
+	
+	map.deleteSymbol(0);
+	QCOMPARE(map.findSymbolIndex(replacement), 0);
+	QCOMPARE(map.findSymbolIndex(s0), 1);
+	QCOMPARE(map.findSymbolIndex(s3), 2);
+	
+	auto* const inserted = new PointSymbol();
+	map.addSymbol(inserted, 0);
+	QCOMPARE(map.findSymbolIndex(inserted), 0);
+	QCOMPARE(map.findSymbolIndex(s3), 3);
+	
+	// Reordering the symbol vector directly leaves stale entries.
+	std::swap(map.symbols[0], map.symbols[3]);
+	QCOMPARE(map.findSymbolIndex(inserted), 3);
+	QCOMPARE(map.findSymbolIndex(s3), 0);
+	std::swap(map.symbols[0], map.symbols[3]);
+	
+	for (int i = 0; i < 3; ++i)
+		map.addColor(new MapColor(QString::number(i), i), i);
+	auto* const c0 = map.getColor(0);
+	auto* const c2 = map.getColor(2);
+	QCOMPARE(map.findColorIndex(c0), 0);
+	QCOMPARE(map.findColorIndex(c2), 2);
+	map.deleteColor(1);
+	QCOMPARE(map.findColorIndex(c0), 0);
+	QCOMPARE(map.findColorIndex(c2), 1);
+	QCOMPARE(map.findColorIndex(nullptr), -1);
+	QCOMPARE(map.findColorIndex(Map::getRegistrationColor()), static_cast<int>(MapColor::Registration));
+}
+
+void MapTest::sortSymbolsTest()
+{
+	Map map;
+	QVERIFY(map.loadFrom(examples_dir.absoluteFilePath(QStringLiteral("complete map.omap"))));
+	QVERIFY(map.getNumSymbols() > 2);
+	QVERIFY(map.getNumObjects() > 0);
+	
+	// Build the index before sorting.
+	auto* const last = map.getSymbol(map.getNumSymbols() - 1);
+	QCOMPARE(map.findSymbolIndex(last), map.getNumSymbols() - 1);
+	
+	map.sortSymbols([](const Symbol* s1, const Symbol* s2) { return Symbol::lessByNumber(s2, s1); });
+	QVERIFY(map.getSymbol(map.getNumSymbols() - 1) != last);
+	for (int i = 0; i < map.getNumSymbols(); ++i)
+		QCOMPARE(map.findSymbolIndex(map.getSymbol(i)), i);
+	
+	auto symbol_numbers = QStringList();
+	map.applyOnAllObjects([&symbol_numbers](Object* object) {
+		symbol_numbers.append(object->getSymbol()->getNumberAsString());
+	});
+	
+	QBuffer buffer;
+	QVERIFY(map.exportToIODevice(buffer));
+	buffer.open(QIODevice::ReadOnly);
+	Map copy;
+	QVERIFY(copy.importFromIODevice(buffer));
+	QCOMPARE(copy.getNumSymbols(), map.getNumSymbols());
+	for (int i = 0; i < map.getNumSymbols(); ++i)
+		QCOMPARE(copy.getSymbol(i)->getNumberAsString(), map.getSymbol(i)->getNumberAsString());
+	
+	auto copy_symbol_numbers = QStringList();
+	copy.applyOnAllObjects([&copy_symbol_numbers](Object* object) {
+		copy_symbol_numbers.append(object->getSymbol()->getNumberAsString());
+	});
+	QCOMPARE(copy_symbol_numbers, symbol_numbers);
+}
+
+
+
+void MapTest::selectedSymbolCountsTest()
+{
+	Map map;
+	map.addSymbol(new PointSymbol(), 0);
+	map.addSymbol(new PointSymbol(), 1);
+	auto* const s0 = map.getSymbol(0);
+	auto* const s1 = map.getSymbol(1);
+	
+	std::vector<Object*> objects;
+	for (int i = 0; i < 3; ++i)
+	{
+		objects.push_back(new PointObject(s0));
+		map.addObject(objects.back());
+		map.addObjectToSelection(objects.back(), false);
+	}
+	const auto& counts = map.selectedSymbolCounts();
+	QCOMPARE(counts.size(), 1);
+	QCOMPARE(counts.value(s0), 3);
+	
+	objects[0]->setSymbol(s1, true);
+	QCOMPARE(counts.size(), 2);
+	QCOMPARE(counts.value(s0), 2);
+	QCOMPARE(counts.value(s1), 1);
+	
+	map.removeObjectFromSelection(objects[1], false);
+	QCOMPARE(counts.value(s0), 1);
+	
+	map.removeSymbolFromSelection(s0, false);
+	QCOMPARE(counts.size(), 1);
+	QCOMPARE(counts.value(s1), 1);
+	
+	map.clearObjectSelection(false);
+	QVERIFY(counts.isEmpty());
+	
+	// Not selected: no change
+	objects[1]->setSymbol(s1, true);
+	QVERIFY(counts.isEmpty());
+}
+
+
+
+void MapTest::batchSelectionTest()
+{
+	Map map;
+	map.addSymbol(new PointSymbol(), 0);
+	map.addSymbol(new PointSymbol(), 1);
+	auto* const visible_symbol = map.getSymbol(0);
+	auto* const hidden_symbol = map.getSymbol(1);
+	hidden_symbol->setHidden(true);
+	
+	std::vector<Object*> objects;
+	for (int i = 0; i < 10; ++i)
+	{
+		objects.push_back(new PointObject(i == 9 ? hidden_symbol : visible_symbol));
+		map.addObject(objects.back());
+	}
+	
+	QSignalSpy spy(&map, &Map::objectSelectionChanged);
+	map.addObjectToSelection(objects[0], false);
+	QCOMPARE(map.addObjectsToSelection(objects, true), std::size_t(8));
+	QCOMPARE(spy.count(), 1);
+	QCOMPARE(map.getNumSelectedObjects(), 9);
+	QVERIFY(!map.isObjectSelected(objects[9]));
+	QCOMPARE(map.selectedSymbolCounts().value(visible_symbol), 9);
+	QCOMPARE(map.addObjectsToSelection(objects, true), std::size_t(0));
+	QCOMPARE(spy.count(), 1);
+	
+	auto const removed = std::vector<Object*>(objects.begin(), objects.begin() + 5);
+	QCOMPARE(map.removeObjectsFromSelection(removed, true), std::size_t(5));
+	QCOMPARE(spy.count(), 2);
+	QCOMPARE(map.getNumSelectedObjects(), 4);
+	QVERIFY(map.getFirstSelectedObject());
+	QVERIFY(map.isObjectSelected(map.getFirstSelectedObject()));
+	QCOMPARE(map.selectedSymbolCounts().value(visible_symbol), 4);
+	QCOMPARE(map.removeObjectsFromSelection(removed, true), std::size_t(0));
+	QCOMPARE(spy.count(), 2);
+}
+
+
+
+void MapTest::deferredUpdatesTest()
+{
+	Map map;
+	map.addSymbol(new PointSymbol(), 0);
+	auto* const symbol = map.getSymbol(0);
+	
+	auto* const eager_object = new PointObject(symbol);
+	map.addObject(eager_object);
+	QVERIFY(!eager_object->isOutputDirty());
+	
+	map.setObjectUpdatesDeferred(true);
+	QVERIFY(map.areObjectUpdatesDeferred());
+	auto* const near_object = new PointObject(symbol);
+	near_object->setPosition(MapCoordF{5, 5});
+	map.addObject(near_object);
+	auto* const far_object = new PointObject(symbol);
+	far_object->setPosition(MapCoordF{1000, 1000});
+	map.addObject(far_object);
+	QVERIFY(near_object->isOutputDirty());
+	QVERIFY(far_object->isOutputDirty());
+	
+	map.updateObjects(QRectF{0, 0, 10, 10});
+	QVERIFY(!near_object->isOutputDirty());
+	QVERIFY(far_object->isOutputDirty());
+	QVERIFY(map.hasDeferredObjectUpdates());
+	
+	// Objects which are deleted before their update leave the list.
+	auto* const deleted_object = new PointObject(symbol);
+	deleted_object->setPosition(MapCoordF{2000, 2000});
+	map.addObject(deleted_object);
+	QVERIFY(map.getPart(0)->deleteObject(deleted_object));
+	
+	// Changed objects which were not deferred are updated by drawing.
+	eager_object->setPosition(MapCoordF{3000, 3000});
+	QVERIFY(eager_object->isOutputDirty());
+	map.updateObjects(QRectF{0, 0, 10, 10});
+	QVERIFY(!eager_object->isOutputDirty());
+	
+	// The remaining objects are updated when the event loop is idle.
+	QCoreApplication::processEvents();
+	QVERIFY(far_object->isOutputDirty());
+	map.setObjectUpdatesDeferred(false);
+	QTRY_VERIFY(!far_object->isOutputDirty());
+	QVERIFY(!map.hasDeferredObjectUpdates());
+}
+
+
+void MapTest::dataOnlyTest()
+{
+	Map map;
+	map.setDataOnly(true);
+	QVERIFY(map.isDataOnly());
+	QVERIFY(map.areObjectUpdatesDeferred());
+	map.addSymbol(new PointSymbol(), 0);
+	
+	for (int i = 0; i < 10; ++i)
+	{
+		auto* object = new PointObject(map.getSymbol(0));
+		object->setPosition(MapCoordF{qreal(i), 0});
+		map.addObject(object);
+		QVERIFY(object->isOutputDirty());
+	}
+	
+	map.updateAllObjects();
+	QVERIFY(map.getPart(0)->getObject(0)->isOutputDirty());
+	
+	// Explicit updates are still possible.
+	QVERIFY(map.getPart(0)->getObject(0)->update());
+	QVERIFY(!map.getPart(0)->getObject(0)->isOutputDirty());
+	
+	QBuffer buffer;
+	QVERIFY(map.exportToIODevice(buffer));
+	QVERIFY(map.getPart(0)->getObject(1)->isOutputDirty());
+	
+	buffer.open(QIODevice::ReadOnly);
+	Map copy;
+	copy.setDataOnly(true);
+	QVERIFY(copy.importFromIODevice(buffer));
+	QCOMPARE(copy.getNumObjects(), map.getNumObjects());
+	QVERIFY(copy.getPart(0)->getObject(9)->isOutputDirty());
+}
+
+
+void MapTest::colorSeparationIndexTest()
+{
+	Map map;
+	QVERIFY(map.loadFrom(examples_dir.absoluteFilePath(QStringLiteral("overprinting.omap"))));
+	
+	std::vector<const MapColor*> separations;
+	for (int i = map.getNumColors() - 1; i >= 0; --i)
+	{
+		if (map.getColor(i)->getSpotColorMethod() == MapColor::SpotColor)
+			separations.push_back(map.getColor(i));
+	}
+	QVERIFY(separations.size() > 1);
+	
+	// A grid of 2 x 2 pages, overlapping the map's extent
+	auto const extent = map.calculateExtent();
+	auto const page_size = extent.size() * 0.6;
+	std::vector<QRectF> pages;
+	for (int i = 0; i < 4; ++i)
+	{
+		pages.emplace_back(QPointF(), page_size);
+		pages.back().moveCenter({ extent.left() + extent.width() * (i % 2 + 0.5) / 2,
+		                          extent.top() + extent.height() * (i / 2 + 0.5) / 2 });
+	}
+	
+	auto const indexes = map.prepareColorSeparations(separations, pages);
+	QCOMPARE(indexes.size(), separations.size());
+	
+	auto const pixel_per_mm = qreal(2);
+	auto const image_size = (page_size * pixel_per_mm).toSize();
+	auto const draw_page = [&map, image_size, pixel_per_mm](const QRectF& page, auto draw_separation) {
+		QImage image(image_size, QImage::Format_ARGB32_Premultiplied);
+		image.fill(QColor(Qt::white));
+		QPainter painter(&image);
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.scale(pixel_per_mm, pixel_per_mm);
+		painter.translate(-page.topLeft());
+		draw_separation(&painter, RenderConfig { map, page, pixel_per_mm, RenderConfig::NoOptions, 1.0 });
+		return image;
+	};
+	
+	for (std::size_t tile = 0; tile < pages.size(); ++tile)
+	{
+		for (std::size_t i = 0; i < separations.size(); ++i)
+		{
+			auto const expected = draw_page(pages[tile], [&map, &separations, i](QPainter* painter, const RenderConfig& config) {
+				map.drawColorSeparation(painter, config, separations[i]);
+			});
+			auto const actual = draw_page(pages[tile], [&indexes, i, tile](QPainter* painter, const RenderConfig& config) {
+				indexes[i].draw(painter, config, tile);
+			});
+			QCOMPARE(actual, expected);
+		}
+	}
+}
+
+
+void MapTest::renderableArenaTest()
+{
+	RenderableArena arena;
+	QCOMPARE(arena.capacity(), std::size_t(0));
+	
+	auto const allocate_all = [&arena]() {
+		std::vector<std::pair<char*, std::size_t>> allocations;
+		for (std::size_t i = 0; i < 200; ++i)
+		{
+			auto const size = 1 + (i * 37) % 120;
+			allocations.emplace_back(static_cast<char*>(arena.allocate(size)), size);
+		}
+		return allocations;
+	};
+	
+	// The allocations are aligned, and they don't overlap.
+	auto const allocations = allocate_all();
+	for (std::size_t i = 0; i < allocations.size(); ++i)
+	{
+		auto const address = reinterpret_cast<std::uintptr_t>(allocations[i].first);
+		QCOMPARE(address % alignof(std::max_align_t), std::uintptr_t(0));
+		std::memset(allocations[i].first, int(i), allocations[i].second);
+	}
+	for (std::size_t i = 0; i < allocations.size(); ++i)
+	{
+		QCOMPARE(allocations[i].first[0], char(i));
+		QCOMPARE(allocations[i].first[allocations[i].second - 1], char(i));
+	}
+	auto const capacity = arena.capacity();
+	QVERIFY(capacity >= 200);
+	
+	// After a reset, a single block takes the same allocations,
+	// and further resets reuse this block.
+	arena.reset();
+	allocate_all();
+	QCOMPARE(arena.capacity(), capacity);
+	arena.reset();
+	allocate_all();
+	QCOMPARE(arena.capacity(), capacity);
+	
+	// Objects reuse their memory when they are updated.
+	Map map;
+	QVERIFY(map.loadFrom(examples_dir.absoluteFilePath(QStringLiteral("overprinting.omap"))));
+	auto const extent = map.calculateExtent();
+	auto const pixel_per_mm = qreal(2);
+	auto const draw_map = [&map, &extent, pixel_per_mm]() {
+		QImage image((extent.size() * pixel_per_mm).toSize(), QImage::Format_ARGB32_Premultiplied);
+		image.fill(QColor(Qt::white));
+		QPainter painter(&image);
+		painter.scale(pixel_per_mm, pixel_per_mm);
+		painter.translate(-extent.topLeft());
+		map.draw(&painter, RenderConfig { map, extent, pixel_per_mm, RenderConfig::NoOptions, 1.0 });
+		return image;
+	};
+	auto const expected = draw_map();
+	map.updateAllObjects();
+	map.updateAllObjects();
+	QCOMPARE(draw_map(), expected);
+	QCOMPARE(map.calculateExtent(), extent);
+}
+
+
+
 void MapTest::importTest_data()
 {
 	QTest::addColumn<QString>("first_file");
@@ -44,6 +44,30 @@ private slots:
 	/** Tests if special colors are correctly handled. */
 	void specialColorsTest();
 	
+	/** Tests symbol and color index lookup after modifications. */
+	void findIndexTest();
+	
+	/** Tests symbol index lookup and saving after sorting the symbols. */
+	void sortSymbolsTest();
+	
+	/** Tests the incremental symbol counts of the object selection. */
+	void selectedSymbolCountsTest();
+	
+	/** Tests adding and removing multiple objects to and from the selection. */
+	void batchSelectionTest();
+	
+	/** Tests deferred object updates and updates limited to the drawn area. */
+	void deferredUpdatesTest();
+	
+	/** Tests data-only maps. */
+	void dataOnlyTest();
+	
+	/** Tests that indexed color separations are drawn like unindexed ones. */
+	void colorSeparationIndexTest();
+	
+	/** Tests the memory for renderables, and reusing it for updated objects. */
+	void renderableArenaTest();
+	
 	/** Tests various modes of Map::importMap(). */
 	void importTest_data();
 	void importTest();
@@ -0,0 +1,579 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "render_benchmark_t.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+#include <Qt>
+#include <QtGlobal>
+#include <QtTest>
+#include <QBuffer>
+#include <QByteArray>
+#include <QColor>
+#include <QCoreApplication>
+#include <QDir>
+#include <QIODevice>
+#include <QImage>
+#include <QLatin1Char>
+#include <QPainter>
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <QSizeF>
+#include <QString>
+#include <QTemporaryDir>
+
+#include "global.h"
+#include "test_config.h"
+#include "core/map.h"
+#include "core/map_color.h"
+#include "core/map_coord.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "core/objects/text_object.h"
+#include "core/renderables/renderable.h"
+#include "core/symbols/line_symbol.h"
+#include "core/symbols/text_symbol.h"
+#include "fileformats/file_format.h"
+#include "fileformats/file_format_registry.h"
+#include "fileformats/file_import_export.h"
+#include "fileformats/xml_file_format.h"
+
+
+namespace OpenOrienteering {
+
+namespace {
+
+/// The example map which provides the symbols and objects for most benchmarks.
+const auto* const source_map = "data:/examples/forest sample.omap";
+
+/// An example map with spot colors.
+const auto* const spot_color_map = "data:/examples/overprinting.omap";
+
+/// The size of the rendered images, in pixel.
+const auto viewport_size = QSize { 1024, 768 };
+
+/// Returns a viewport of the given scale, centered on the map.
+QRectF viewport(const Map& map, qreal pixel_per_mm)
+{
+	auto rect = QRectF { QPointF(), QSizeF(viewport_size) / pixel_per_mm };
+	rect.moveCenter(map.calculateExtent().center());
+	return rect;
+}
+
+}  // namespace
+
+
+
+RenderBenchmark::RenderBenchmark(QObject* parent)
+: QObject(parent)
+{
+	// nothing
+}
+
+RenderBenchmark::~RenderBenchmark() = default;
+
+
+void RenderBenchmark::initTestCase()
+{
+	QCoreApplication::setOrganizationName(QString::fromLatin1("OpenOrienteering.org"));
+	QCoreApplication::setApplicationName(QString::fromLatin1("RenderBenchmark"));
+	
+	doStaticInitializations();
+	
+	QDir::addSearchPath(QStringLiteral("data"), QDir(QString::fromUtf8(MAPPER_TEST_SOURCE_DIR)).absoluteFilePath(QStringLiteral("..")));
+	QDir::addSearchPath(QStringLiteral("testdata"), QDir(QString::fromUtf8(MAPPER_TEST_SOURCE_DIR)).absoluteFilePath(QStringLiteral("data")));
+}
+
+
+
+void RenderBenchmark::common_data()
+{
+	QTest::addColumn<int>("num_objects");
+	
+	QTest::newRow("10k") << 10000;
+	QTest::newRow("100k") << 100000;
+	if (qEnvironmentVariableIsSet("MAPPER_BENCHMARK_LARGE"))
+		QTest::newRow("1M") << 1000000;
+}
+
+
+void RenderBenchmark::format_data()
+{
+	QTest::addColumn<int>("num_objects");
+	QTest::addColumn<QByteArray>("format_id");
+	
+	static const auto format_ids = {
+	    "XML",
+#ifndef MAPPER_BIG_ENDIAN
+	    "OCD",
+#endif
+	};
+	static const auto sizes = { 10000, 100000, 1000000 };
+	
+	for (auto num_objects : sizes)
+	{
+		if (num_objects > 100000 && !qEnvironmentVariableIsSet("MAPPER_BENCHMARK_LARGE"))
+			continue;
+		for (auto format_id : format_ids)
+		{
+			auto id = QByteArray::number(num_objects / 1000) + "k " + format_id;
+			QTest::newRow(id) << num_objects << QByteArray{format_id};
+		}
+	}
+}
+
+
+Map* RenderBenchmark::syntheticMap(const QString& source, int num_objects)
+{
+	auto& map = maps[source + QLatin1Char('#') + QString::number(num_objects)];
+	if (map)
+		return map.get();
+	
+	map.reset(new Map());
+	if (!map->loadFrom(source))
+	{
+		map.reset();
+		return nullptr;
+	}
+	
+	auto originals = std::vector<const Object*>();
+	originals.reserve(std::size_t(map->getNumObjects()));
+	const auto& const_map = *map;
+	const_map.applyOnAllObjects([&originals](const Object* object) { originals.push_back(object); });
+	if (originals.empty())
+	{
+		map.reset();
+		return nullptr;
+	}
+	
+	// Tile copies of the original objects in a square grid.
+	auto const extent = map->calculateExtent();
+	auto const tile_width = std::ceil(extent.width()) + 10;
+	auto const tile_height = std::ceil(extent.height()) + 10;
+	auto const tiles_per_row = std::max(1, int(std::ceil(std::sqrt(qreal(num_objects) / originals.size()))));
+	for (int tile = 1; map->getNumObjects() < num_objects; ++tile)
+	{
+		auto const offset = MapCoord { tile_width * (tile % tiles_per_row), tile_height * (tile / tiles_per_row) };
+		for (const auto* original : originals)
+		{
+			auto* object = original->duplicate();
+			object->move(offset);
+			map->addObject(object);
+			if (map->getNumObjects() >= num_objects)
+				break;
+		}
+	}
+	map->updateAllObjects();
+	
+	return map.get();
+}
+
+
+
+void RenderBenchmark::updateAllObjects_data()
+{
+	common_data();
+}
+
+void RenderBenchmark::updateAllObjects()
+{
+	QFETCH(int, num_objects);
+	auto* map = syntheticMap(QString::fromLatin1(source_map), num_objects);
+	QVERIFY(map);
+	
+	QBENCHMARK
+	{
+		map->updateAllObjects();
+	}
+}
+
+
+
+void RenderBenchmark::draw_data()
+{
+	QTest::addColumn<int>("num_objects");
+	QTest::addColumn<qreal>("pixel_per_mm");
+	
+	static const auto sizes = { 10000, 100000, 1000000 };
+	static const auto zoom_levels = { 0.25, 1.0, 4.0, 16.0 };
+	for (auto num_objects : sizes)
+	{
+		if (num_objects > 100000 && !qEnvironmentVariableIsSet("MAPPER_BENCHMARK_LARGE"))
+			continue;
+		for (auto pixel_per_mm : zoom_levels)
+		{
+			auto id = QByteArray::number(num_objects / 1000) + "k @ " + QByteArray::number(pixel_per_mm) + " px/mm";
+			QTest::newRow(id) << num_objects << qreal(pixel_per_mm);
+		}
+	}
+}
+
+void RenderBenchmark::draw()
+{
+	QFETCH(int, num_objects);
+	QFETCH(qreal, pixel_per_mm);
+	auto* map = syntheticMap(QString::fromLatin1(source_map), num_objects);
+	QVERIFY(map);
+	
+	auto const bbox = viewport(*map, pixel_per_mm);
+	auto image = QImage { viewport_size, QImage::Format_ARGB32_Premultiplied };
+	QBENCHMARK
+	{
+		image.fill(QColor(Qt::white));
+		QPainter painter(&image);
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.scale(pixel_per_mm, pixel_per_mm);
+		painter.translate(-bbox.topLeft());
+		map->draw(&painter, RenderConfig { *map, bbox, pixel_per_mm, RenderConfig::Screen, 1.0 });
+	}
+}
+
+
+
+void RenderBenchmark::drawOverprintingSimulation_data()
+{
+	common_data();
+}
+
+void RenderBenchmark::drawOverprintingSimulation()
+{
+	QFETCH(int, num_objects);
+	auto* map = syntheticMap(QString::fromLatin1(spot_color_map), num_objects);
+	QVERIFY(map);
+	
+	auto const pixel_per_mm = qreal(4);
+	auto const bbox = viewport(*map, pixel_per_mm);
+	auto image = QImage { viewport_size, QImage::Format_ARGB32_Premultiplied };
+	QBENCHMARK
+	{
+		image.fill(QColor(Qt::white));
+		QPainter painter(&image);
+		painter.scale(pixel_per_mm, pixel_per_mm);
+		painter.translate(-bbox.topLeft());
+		map->drawOverprintingSimulation(&painter, RenderConfig { *map, bbox, pixel_per_mm, RenderConfig::Screen, 1.0 });
+	}
+}
+
+
+
+void RenderBenchmark::drawColorSeparations_data()
+{
+	QTest::addColumn<int>("num_objects");
+	QTest::addColumn<bool>("indexed");
+	
+	static const auto sizes = { 10000, 100000, 1000000 };
+	for (auto num_objects : sizes)
+	{
+		if (num_objects > 100000 && !qEnvironmentVariableIsSet("MAPPER_BENCHMARK_LARGE"))
+			continue;
+		auto id = QByteArray::number(num_objects / 1000) + "k";
+		QTest::newRow(id + ", per page") << num_objects << false;
+		QTest::newRow(id + ", indexed") << num_objects << true;
+	}
+}
+
+void RenderBenchmark::drawColorSeparations()
+{
+	QFETCH(int, num_objects);
+	QFETCH(bool, indexed);
+	auto* map = syntheticMap(QString::fromLatin1(spot_color_map), num_objects);
+	QVERIFY(map);
+	
+	// A grid of 4 x 4 pages covering the map, like printing does.
+	auto const pixel_per_mm = qreal(1);
+	auto const extent = map->calculateExtent();
+	auto const page_size = QSizeF(viewport_size) / pixel_per_mm;
+	auto pages = std::vector<QRectF>();
+	for (int i = 0; i < 16; ++i)
+	{
+		auto const center = QPointF { extent.left() + extent.width() * (i % 4 + 0.5) / 4,
+		                              extent.top() + extent.height() * (i / 4 + 0.5) / 4 };
+		pages.emplace_back(QPointF(), page_size);
+		pages.back().moveCenter(center);
+	}
+	
+	auto separations = std::vector<const MapColor*>();
+	for (int i = map->getNumColors() - 1; i >= 0; --i)
+	{
+		if (map->getColor(i)->getSpotColorMethod() == MapColor::SpotColor)
+			separations.push_back(map->getColor(i));
+	}
+	QVERIFY(!separations.empty());
+	
+	auto image = QImage { viewport_size, QImage::Format_ARGB32_Premultiplied };
+	auto const draw_page = [&image, map, pixel_per_mm](const QRectF& page, auto draw_separation) {
+		image.fill(QColor(Qt::white));
+		QPainter painter(&image);
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.scale(pixel_per_mm, pixel_per_mm);
+		painter.translate(-page.topLeft());
+		draw_separation(&painter, RenderConfig { *map, page, pixel_per_mm, RenderConfig::NoOptions, 1.0 });
+	};
+	
+	// The equivalence of both ways is tested in MapTest::colorSeparationIndexTest().
+	QBENCHMARK
+	{
+		if (indexed)
+		{
+			auto const indexes = map->prepareColorSeparations(separations, pages);
+			for (std::size_t tile = 0; tile < pages.size(); ++tile)
+			{
+				for (const auto& index : indexes)
+				{
+					draw_page(pages[tile], [&index, tile](QPainter* painter, const RenderConfig& config) {
+						index.draw(painter, config, tile);
+					});
+				}
+			}
+		}
+		else
+		{
+			for (const auto& page : pages)
+			{
+				for (const auto* separation : separations)
+				{
+					draw_page(page, [map, separation](QPainter* painter, const RenderConfig& config) {
+						map->drawColorSeparation(painter, config, separation);
+					});
+				}
+			}
+		}
+	}
+}
+
+
+
+void RenderBenchmark::findObjectsAt_data()
+{
+	common_data();
+}
+
+void RenderBenchmark::findObjectsAt()
+{
+	QFETCH(int, num_objects);
+	auto* map = syntheticMap(QString::fromLatin1(source_map), num_objects);
+	QVERIFY(map);
+	
+	auto const extent = map->calculateExtent();
+	auto found = SelectionInfoVector();
+	QBENCHMARK
+	{
+		for (int i = 0; i < 100; ++i)
+		{
+			auto const coord = MapCoordF { extent.left() + extent.width() * (i % 10 + 0.5) / 10,
+			                               extent.top() + extent.height() * (i / 10 + 0.5) / 10 };
+			found.clear();
+			map->findObjectsAt(coord, 0.5, false, false, false, true, found);
+		}
+	}
+}
+
+
+
+void RenderBenchmark::save_data()
+{
+	format_data();
+}
+
+void RenderBenchmark::save()
+{
+	QFETCH(int, num_objects);
+	QFETCH(QByteArray, format_id);
+	auto* map = syntheticMap(QString::fromLatin1(source_map), num_objects);
+	QVERIFY(map);
+	
+	auto const* format = FileFormats.findFormat(format_id);
+	QVERIFY(format);
+	QVERIFY(format->supportsWriting());
+	
+	QBENCHMARK
+	{
+		QBuffer buffer;
+		QVERIFY(buffer.open(QIODevice::WriteOnly));
+		auto exporter = format->makeExporter({}, map, nullptr);
+		QVERIFY(bool(exporter));
+		exporter->setDevice(&buffer);
+		QVERIFY(exporter->doExport());
+	}
+}
+
+
+
+void RenderBenchmark::load_data()
+{
+	format_data();
+}
+
+void RenderBenchmark::load()
+{
+	QFETCH(int, num_objects);
+	QFETCH(QByteArray, format_id);
+	auto* map = syntheticMap(QString::fromLatin1(source_map), num_objects);
+	QVERIFY(map);
+	
+	auto const* format = FileFormats.findFormat(format_id);
+	QVERIFY(format);
+	QVERIFY(format->supportsReading());
+	
+	QBuffer buffer;
+	QVERIFY(buffer.open(QIODevice::ReadWrite));
+	auto exporter = format->makeExporter({}, map, nullptr);
+	QVERIFY(bool(exporter));
+	exporter->setDevice(&buffer);
+	QVERIFY(exporter->doExport());
+	
+	QBENCHMARK
+	{
+		Map loaded_map;
+		auto importer = format->makeImporter({}, &loaded_map, nullptr);
+		QVERIFY(bool(importer));
+		importer->setDevice(&buffer);
+		QVERIFY(buffer.seek(0));
+		QVERIFY(importer->doImport());
+		QVERIFY(loaded_map.getNumObjects() > 0);  // OCD may split some objects
+	}
+}
+
+
+
+void RenderBenchmark::loadTextObjects()
+{
+	Map map {};
+	auto color = new MapColor(QString::fromLatin1("black"), 0);
+	map.addColor(color, 0);
+	auto symbol = new TextSymbol();
+	symbol->setColor(color);
+	map.addSymbol(symbol, 0);
+	
+	// Like control numbers and spot heights
+	for (int i = 0; i < 5000; ++i)
+	{
+		auto object = new TextObject(symbol);
+		object->setAnchorPosition(MapCoord(10.0 * (i % 100), 10.0 * (i / 100)));
+		object->setText(QString::number(100 + i));
+		map.addObject(object);
+	}
+	
+	XMLFileFormat format;
+	QBuffer buffer;
+	auto exporter = format.makeExporter({}, &map, nullptr);
+	QVERIFY(bool(exporter));
+	exporter->setDevice(&buffer);
+	QVERIFY(buffer.open(QIODevice::ReadWrite));
+	QVERIFY(exporter->doExport());
+	
+	QBENCHMARK
+	{
+		Map reloaded_map {};
+		auto importer = format.makeImporter({}, &reloaded_map, nullptr);
+		QVERIFY(bool(importer));
+		importer->setDevice(&buffer);
+		QVERIFY(buffer.seek(0));
+		QVERIFY(importer->doImport());
+		QCOMPARE(reloaded_map.getNumObjects(), map.getNumObjects());
+	}
+}
+
+
+
+void RenderBenchmark::compressedFile_data()
+{
+	QTest::addColumn<bool>("compressed");
+	QTest::addColumn<bool>("save");
+	
+	QTest::newRow("save omap") << false << true;
+	QTest::newRow("save omapz") << true << true;
+	QTest::newRow("load omap") << false << false;
+	QTest::newRow("load omapz") << true << false;
+}
+
+void RenderBenchmark::compressedFile()
+{
+	QFETCH(bool, compressed);
+	QFETCH(bool, save);
+	
+	Map map {};
+	auto color = new MapColor(QString::fromLatin1("black"), 0);
+	map.addColor(color, 0);
+	auto line_symbol = new LineSymbol();
+	line_symbol->setColor(color);
+	line_symbol->setLineWidth(0.1);
+	map.addSymbol(line_symbol, 0);
+	
+	for (int i = 0; i < 20000; ++i)
+	{
+		auto path = new PathObject(line_symbol);
+		for (int j = 0; j < 50; ++j)
+			path->addCoordinate(MapCoord(10.0 * (i % 100) + 0.1 * j, 10.0 * (i / 100) + 0.01 * (j % 7)));
+		map.addObject(path);
+	}
+	
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto const path = QString{dir.path() + (compressed ? QLatin1String("/map.omapz") : QLatin1String("/map.omap"))};
+	
+	auto const save_map = [&map, &path]() {
+		auto exporter = FileFormats.makeExporter(path, &map, nullptr);
+		return exporter && exporter->doExport();
+	};
+	
+	if (save)
+	{
+		QBENCHMARK
+		{
+			QVERIFY(save_map());
+		}
+	}
+	else
+	{
+		QVERIFY(save_map());
+		QBENCHMARK
+		{
+			Map reloaded_map {};
+			QVERIFY(reloaded_map.loadFrom(path));
+			QCOMPARE(reloaded_map.getNumObjects(), map.getNumObjects());
+		}
+	}
+}
+
+
+}  // namespace OpenOrienteering
+
+
+
+/*
+ * We don't need a real GUI window.
+ * 
+ * But we discovered QTBUG-58768 macOS: Crash when using QPrinter
+ * while running with "minimal" platform plugin.
+ */
+#ifndef Q_OS_MACOS
+namespace  {
+	auto Q_DECL_UNUSED qpa_selected = qputenv("QT_QPA_PLATFORM", "minimal");  // clazy:exclude=non-pod-global-static
+}
+#endif
+
+
+QTEST_MAIN(OpenOrienteering::RenderBenchmark)
@@ -0,0 +1,112 @@
+/*
+ *    Copyright 2026 The OpenOrienteering developers
+ *
+ *    This file is part of OpenOrienteering.
+ *
+ *    OpenOrienteering is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    OpenOrienteering is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENORIENTEERING_RENDER_BENCHMARK_T_H
+#define OPENORIENTEERING_RENDER_BENCHMARK_T_H
+
+#include <map>
+#include <memory>
+
+#include <QObject>
+#include <QString>
+
+namespace OpenOrienteering {
+
+class Map;
+
+
+/**
+ * @test Benchmarks the rendering hot paths and the file formats on large maps.
+ * 
+ * The maps are generated by tiling the objects of the example maps until
+ * the requested number of objects is reached. Maps with one million objects
+ * are used only when the environment variable MAPPER_BENCHMARK_LARGE is set.
+ * 
+ * Machine-readable results are available via QTest's output options, e.g.
+ * `render_benchmark_t -o results.xml,xml` or `render_benchmark_t -csv`.
+ * The render_benchmark_t-results target writes render_benchmark_t.xml.
+ */
+class RenderBenchmark : public QObject
+{
+Q_OBJECT
+public:
+	explicit RenderBenchmark(QObject* parent = nullptr);
+	~RenderBenchmark() override;
+	
+private slots:
+	/** Initialization. */
+	void initTestCase();
+	
+	/** Benchmarks Map::updateAllObjects(). */
+	void updateAllObjects();
+	void updateAllObjects_data();
+	
+	/** Benchmarks Map::draw() at different zoom levels. */
+	void draw();
+	void draw_data();
+	
+	/** Benchmarks Map::drawOverprintingSimulation(). */
+	void drawOverprintingSimulation();
+	void drawOverprintingSimulation_data();
+	
+	/** Benchmarks drawing the color separations of multiple pages. */
+	void drawColorSeparations();
+	void drawColorSeparations_data();
+	
+	/** Benchmarks Map::findObjectsAt() for a grid of positions. */
+	void findObjectsAt();
+	void findObjectsAt_data();
+	
+	/** Benchmarks saving in each format which supports reading and writing. */
+	void save();
+	void save_data();
+	
+	/** Benchmarks loading in each format which supports reading and writing. */
+	void load();
+	void load_data();
+	
+	/** Benchmarks loading a map with many text objects. */
+	void loadTextObjects();
+	
+	/** Benchmarks saving and loading compressed and uncompressed XML files. */
+	void compressedFile();
+	void compressedFile_data();
+	
+private:
+	/** Adds the num_objects column and rows. */
+	void common_data();
+	
+	/** Adds the num_objects and format_id columns and rows. */
+	void format_data();
+	
+	/**
+	 * Returns a map with at least the given number of objects.
+	 * 
+	 * The map is created from the source map on first use, and kept for
+	 * subsequent benchmarks. Returns nullptr on error.
+	 */
+	Map* syntheticMap(const QString& source, int num_objects);
+	
+	std::map<QString, std::unique_ptr<Map>> maps;
+};
+
+
+}  // namespace OpenOrienteering
+
+#endif
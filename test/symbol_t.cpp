@@ -17,8 +17,12 @@
  *    along with OpenOrienteering.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cstddef>
 #include <initializer_list>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <Qt>
 #include <QtGlobal>
@@ -32,19 +36,24 @@
 #include <QLatin1String>
 #include <QObject>
 #include <QPainter>
+#include <QPainterPath>
 #include <QPoint>
 #include <QRect>
 #include <QRectF>
 #include <QRgb>
 #include <QSize>
 #include <QString>
+#include <QTemporaryDir>
 
 #include "global.h"
 #include "test_config.h"
 #include "core/map.h"
 #include "core/map_color.h"
+#include "core/objects/object.h"
 #include "core/renderables/renderable.h"
 #include "core/symbols/symbol.h"
+#include "core/symbols/symbol_icon_cache.h"
+#include "core/symbols/text_symbol.h"
 
 using namespace OpenOrienteering;
 
@@ -152,6 +161,7 @@ private slots:
 		QDir::addSearchPath(QStringLiteral("data"), QDir(QString::fromUtf8(MAPPER_TEST_SOURCE_DIR)).absoluteFilePath(QStringLiteral("..")));
 		QDir::addSearchPath(QStringLiteral("testdata"), QDir(QString::fromUtf8(MAPPER_TEST_SOURCE_DIR)).absoluteFilePath(QStringLiteral("data")));
 		doStaticInitializations();
+		SymbolIconCache::instance().setDirectory({});
 	}
 	
 	
@@ -321,8 +331,192 @@ private slots:
 			
 			QVERIFY(!symbol->containsSymbol(symbol));
 			
+			QVERIFY(symbol->detailSize() >= 0);
 		}
 	}
+	
+	
+	void levelOfDetailTest_data()
+	{
+		invariantTest_data();
+	}
+	
+	void levelOfDetailTest()
+	{
+		QFETCH(QString, map_filename);
+		Map map {};
+		QVERIFY(map.loadFrom(map_filename));
+		
+		auto const extent = map.calculateExtent();
+		auto make_config = [&map, &extent](qreal scaling, qreal level_of_detail) {
+			auto config = RenderConfig { map, extent, scaling, RenderConfig::Screen, 1 };
+			config.level_of_detail = level_of_detail;
+			return config;
+		};
+		
+		// Zooming out simplifies more symbols, but only those with details.
+		auto const level_of_detail = 3;
+		auto previous = std::vector<int>{};
+		for (auto scaling : { 64.0, 8.0, 2.0, 0.5 })
+		{
+			auto const config = make_config(scaling, level_of_detail);
+			auto simplified = std::vector<int>{};
+			for (int i = 0; i < map.getNumSymbols(); ++i)
+			{
+				const auto* symbol = map.getSymbol(i);
+				auto const detail_size = symbol->detailSize();
+				QCOMPARE(config.simplifies(symbol), detail_size > 0 && detail_size * scaling < level_of_detail);
+				if (config.simplifies(symbol))
+					simplified.push_back(i);
+			}
+			QVERIFY(std::includes(begin(simplified), end(simplified), begin(previous), end(previous)));
+			previous = std::move(simplified);
+		}
+		QVERIFY(!previous.empty());
+		
+		// Off, or when not drawing for the screen, nothing is simplified.
+		auto const off = make_config(0.5, 0);
+		auto printing = make_config(0.5, level_of_detail);
+		printing.options = RenderConfig::NoOptions;
+		for (int i = 0; i < map.getNumSymbols(); ++i)
+		{
+			QVERIFY(!off.simplifies(map.getSymbol(i)));
+			QVERIFY(!printing.simplifies(map.getSymbol(i)));
+		}
+		
+		// When off, the output is unchanged, even after drawing simplified.
+		// Larger images and a coarse level of detail make the difference obvious.
+		auto draw = [&map, &extent](const RenderConfig& config) {
+			QImage image((extent.size() * config.scaling).toSize() + QSize(1, 1), QImage::Format_ARGB32_Premultiplied);
+			image.fill(Qt::white);
+			QPainter painter(&image);
+			painter.scale(config.scaling, config.scaling);
+			painter.translate(-extent.topLeft());
+			map.draw(&painter, config);
+			return image;
+		};
+		auto const original = draw(make_config(2, 0));
+		auto const simplified = draw(make_config(2, Symbol::max_level_of_detail));
+		QVERIFY(simplified != original);
+		QCOMPARE(draw(make_config(2, 0)), original);
+	}
+	
+	
+	void createIconsTest_data()
+	{
+		invariantTest_data();
+	}
+	
+	void createIconsTest()
+	{
+		QFETCH(QString, map_filename);
+		Map map {};
+		QVERIFY(map.loadFrom(map_filename));
+		
+		auto symbols = std::vector<const Symbol*>();
+		for (int i = 0; i < map.getNumSymbols(); ++i)
+			symbols.push_back(map.getSymbol(i));
+		
+		auto const side_length = 32;
+		auto const icons = Symbol::createIcons(map, symbols, side_length);
+		QCOMPARE(icons.size(), symbols.size());
+		for (std::size_t i = 0; i < symbols.size(); ++i)
+			QCOMPARE(icons[i], symbols[i]->createIcon(map, side_length));
+	}
+	
+	
+	void iconCacheTest()
+	{
+		Map map {};
+		QVERIFY(map.loadFrom(QString::fromUtf8(*example_files.begin())));
+		QVERIFY(map.getNumSymbols() > 1);
+		
+		const auto* symbol = map.getSymbol(0);
+		auto const key = SymbolIconCache::key(map, *symbol, 32, true, 1);
+		QCOMPARE(SymbolIconCache::key(map, *symbol, 32, true, 1), key);
+		QVERIFY(SymbolIconCache::key(map, *symbol, 48, true, 1) != key);
+		QVERIFY(SymbolIconCache::key(map, *symbol, 32, true, 2) != key);
+		
+		QTemporaryDir dir;
+		QVERIFY(dir.isValid());
+		SymbolIconCache cache(dir.path() + QLatin1String("/icons"));
+		QVERIFY(cache.isEnabled());
+		QVERIFY(cache.load(key).isNull());
+		
+		auto const icon = symbol->createIcon(map, 32, true, 1);
+		cache.store(key, icon);
+		QCOMPARE(cache.load(key), icon);
+		
+		cache.prune(0);
+		QVERIFY(cache.load(key).isNull());
+		
+		SymbolIconCache small_cache(dir.path() + QLatin1String("/small"), 0);
+		small_cache.store(key, icon);
+		QVERIFY(small_cache.load(key).isNull());
+		
+		SymbolIconCache disabled_cache(QString{});
+		QVERIFY(!disabled_cache.isEnabled());
+		disabled_cache.store(key, icon);
+		QVERIFY(disabled_cache.load(key).isNull());
+	}
+	
+	
+	void textOutlineTest()
+	{
+		TextSymbol symbol;
+		auto const text = QString::fromUtf8("Mapper 1:15000 – AVA fi ÄÖÜ");
+		
+		QPainterPath expected;
+		expected.addText(10, 20, symbol.getQFont(), text);
+		if (expected.isEmpty())
+			QSKIP("No fonts available");
+		
+		QPainterPath actual;
+		symbol.addTextOutline(actual, 10, 20, text);
+		QVERIFY(!actual.isEmpty());
+		
+		// The second time, all glyphs are taken from the cache.
+		QPainterPath cached;
+		symbol.addTextOutline(cached, 10, 20, text);
+		QVERIFY(cached == actual);
+		
+		auto const expected_bounds = expected.boundingRect();
+		auto const actual_bounds = actual.boundingRect();
+		auto const tolerance = expected_bounds.height() / 100;
+		QVERIFY(qAbs(actual_bounds.left() - expected_bounds.left()) <= tolerance);
+		QVERIFY(qAbs(actual_bounds.top() - expected_bounds.top()) <= tolerance);
+		QVERIFY(qAbs(actual_bounds.right() - expected_bounds.right()) <= tolerance);
+		QVERIFY(qAbs(actual_bounds.bottom() - expected_bounds.bottom()) <= tolerance);
+		
+		// Rasterized, the outlines must cover (almost) the same pixels.
+		auto const scale = 1000 / expected_bounds.width();
+		auto const size = (expected_bounds.size() * scale).toSize() + QSize(2, 2);
+		auto rasterize = [&](const QPainterPath& path) {
+			QImage image(size, QImage::Format_ARGB32_Premultiplied);
+			image.fill(Qt::white);
+			QPainter painter(&image);
+			painter.translate(1, 1);
+			painter.scale(scale, scale);
+			painter.translate(-expected_bounds.topLeft());
+			painter.fillPath(path, Qt::black);
+			return image;
+		};
+		auto const expected_image = rasterize(expected);
+		auto const actual_image = rasterize(actual);
+		auto num_covered = 0;
+		auto num_different = 0;
+		for (int y = 0; y < size.height(); ++y)
+		{
+			for (int x = 0; x < size.width(); ++x)
+			{
+				auto const expected_pixel = qGray(expected_image.pixel(x, y));
+				num_covered += expected_pixel < 128;
+				num_different += qAbs(expected_pixel - qGray(actual_image.pixel(x, y))) >= 128;
+			}
+		}
+		QVERIFY(num_covered > 0);
+		QVERIFY2(num_different <= num_covered / 100, qPrintable(QString::fromLatin1("%1 of %2").arg(num_different).arg(num_covered)));
+	}
 };
 
 
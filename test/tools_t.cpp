@@ -36,12 +36,15 @@
 #include "core/map_coord.h"
 #include "core/objects/object.h"
 #include "core/symbols/line_symbol.h"
+#include "core/symbols/symbol_icon_cache.h"
 #include "global.h"
 #include "gui/main_window.h"
 #include "gui/map/map_editor.h"
 #include "gui/map/map_widget.h"
 #include "tools/edit_point_tool.h"
 #include "tools/edit_tool.h"
+#include "undo/undo.h"
+#include "undo/undo_manager.h"
 
 using namespace OpenOrienteering;
 
@@ -166,6 +169,7 @@ void ToolsTest::initTestCase()
 {
 	Q_INIT_RESOURCE(resources);
 	doStaticInitializations();
+	SymbolIconCache::instance().setDirectory({});
 }
 
 
@@ -200,6 +204,17 @@ void ToolsTest::editTool()
 	QCOMPARE(qMax(qAbs(difference.x()), 0.1), 0.1);
 	QCOMPARE(qMax(qAbs(difference.y()), 0.1), 0.1);
 	
+	// The change is recorded as a compact coordinate change, and can be undone
+	auto& undo_manager = map.map->undoManager();
+	QVERIFY(undo_manager.canUndo());
+	QCOMPARE(undo_manager.nextUndoStep()->getType(), UndoStep::ObjectCoordsUndoStepType);
+	auto const modified_coord = object->getCoordinate(0);
+	QVERIFY(undo_manager.undo());
+	QCOMPARE(object->getCoordinate(0), MapCoord(10, 10));
+	QCOMPARE(object->getCoordinateCount(), MapCoordVector::size_type(5));
+	QVERIFY(undo_manager.redo());
+	QCOMPARE(object->getCoordinate(0), modified_coord);
+	
 	// Cleanup
 	editor.editor->setTool(nullptr);
 }
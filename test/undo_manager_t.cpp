@@ -19,16 +19,46 @@
 
 #include "undo_manager_t.h"
 
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include <QtTest>
 
+#include "core/map.h"
+#include "core/map_coord.h"
+#include "core/map_part.h"
+#include "core/objects/object.h"
+#include "core/symbols/point_symbol.h"
+#include "core/symbols/symbol.h"
+#include "undo/object_undo.h"
 #include "undo/undo.h"
 #include "undo/undo_manager.h"
 
-namespace OpenOrienteering { class Map; }
-
 using namespace OpenOrienteering;
 
 
+namespace
+{
+
+/**
+ * A NoOpUndoStep which pretends to occupy a lot of memory.
+ */
+class LargeUndoStep : public NoOpUndoStep
+{
+public:
+	using NoOpUndoStep::NoOpUndoStep;
+	
+	static constexpr std::size_t size = 1000000;
+	
+protected:
+	std::size_t calculateMemoryUsage() const override { return size; }
+};
+
+}  // namespace
+
+
 // test
 void UndoManagerTest::testUndoRedo()
 {
@@ -207,6 +237,113 @@ void UndoManagerTest::testUndoRedo()
 	QVERIFY(!undo_manager.canRedo());
 }
 
+void UndoManagerTest::testMemoryLimit()
+{
+	Map* const map = nullptr;
+	UndoManager undo_manager(map);
+	QCOMPARE(undo_manager.memoryLimit(), std::size_t(0));
+	
+	undo_manager.setMemoryLimit(3 * LargeUndoStep::size + LargeUndoStep::size / 2);
+	for (int i = 0; i < 10; ++i)
+		undo_manager.push(std::make_unique<LargeUndoStep>(map, true));
+	QCOMPARE(undo_manager.undoStepCount(), 3);
+	QVERIFY(undo_manager.memoryUsage() <= undo_manager.memoryLimit());
+	
+	// The next undo step is always retained.
+	undo_manager.setMemoryLimit(1);
+	QCOMPARE(undo_manager.undoStepCount(), 1);
+	QVERIFY(undo_manager.canUndo());
+	
+	undo_manager.clear();
+	undo_manager.setMemoryLimit(3 * LargeUndoStep::size + LargeUndoStep::size / 2);
+	undo_manager.setSpillingEnabled(true);
+	for (int i = 0; i < 10; ++i)
+		undo_manager.push(std::make_unique<LargeUndoStep>(map, true));
+	QCOMPARE(undo_manager.undoStepCount(), 10);
+	QVERIFY(undo_manager.memoryUsage() <= undo_manager.memoryLimit());
+	
+	for (int i = 0; i < 10; ++i)
+		QVERIFY(undo_manager.undo());
+	QVERIFY(!undo_manager.canUndo());
+	QCOMPARE(undo_manager.redoStepCount(), 10);
+	QVERIFY(undo_manager.canRedo());
+	QCOMPARE(undo_manager.spillFileSize(), qint64(0));
+}
+
+void UndoManagerTest::testSpilledUndoSteps()
+{
+	Map map;
+	for (int i = 0; i < 4; ++i)
+		map.addSymbol(new PointSymbol(), i);
+	auto* const symbol_a = map.getSymbol(0);
+	auto* const symbol_b = map.getSymbol(1);
+	
+	std::vector<std::pair<const Symbol*, MapCoord>> const original = {
+	    { symbol_a, MapCoord(0, 0) },
+	    { symbol_b, MapCoord(10, 0) },
+	    { symbol_a, MapCoord(20, 0) },
+	};
+	for (auto const& item : original)
+	{
+		auto* object = new PointObject(item.first);
+		object->setPosition(item.second);
+		map.addObject(object);
+	}
+	
+	UndoManager undo_manager(&map);
+	undo_manager.setSpillingEnabled(true);
+	undo_manager.setMemoryLimit(1);
+	
+	auto* const part = map.getCurrentPart();
+	auto const delete_object = [&map, &undo_manager, part](int index) {
+		auto step = std::make_unique<AddObjectsUndoStep>(&map);
+		step->setPartIndex(int(map.getCurrentPartIndex()));
+		step->addObject(index, part->getObject(index)->duplicate());
+		part->deleteObject(index);
+		undo_manager.push(std::move(step));
+	};
+	
+	// The first step references only symbol B, the others only symbol A.
+	delete_object(1);
+	delete_object(0);
+	delete_object(0);
+	QCOMPARE(part->getNumObjects(), 0);
+	QCOMPARE(undo_manager.undoStepCount(), 3);
+	QVERIFY(undo_manager.spillFileSize() > 0);
+	
+	// Deleting unreferenced symbols leaves the spilled steps valid.
+	map.deleteSymbol(3);
+	map.deleteSymbol(2);
+	for (int i = 0; i < 3; ++i)
+		QVERIFY(undo_manager.undo());
+	QCOMPARE(part->getNumObjects(), int(original.size()));
+	for (std::size_t i = 0; i < original.size(); ++i)
+	{
+		auto const* object = part->getObject(int(i));
+		QCOMPARE(object->getSymbol(), original[i].first);
+		QVERIFY(object->getRawCoordinateVector().front() == original[i].second);
+	}
+	QVERIFY(!undo_manager.canUndo());
+	QCOMPARE(undo_manager.spillFileSize(), qint64(0));
+	
+	for (int i = 0; i < 3; ++i)
+		QVERIFY(undo_manager.redo());
+	QCOMPARE(part->getNumObjects(), 0);
+	undo_manager.setMemoryLimit(0);
+	undo_manager.setMemoryLimit(1);
+	QVERIFY(undo_manager.spillFileSize() > 0);
+	
+	// Deleting symbol B invalidates only the first step.
+	map.deleteSymbol(1);
+	QVERIFY(undo_manager.undo());
+	QVERIFY(undo_manager.undo());
+	QCOMPARE(part->getNumObjects(), 2);
+	QCOMPARE(part->getObject(0)->getSymbol(), symbol_a);
+	QCOMPARE(part->getObject(1)->getSymbol(), symbol_a);
+	QCOMPARE(undo_manager.undoStepCount(), 1);
+	QVERIFY(!undo_manager.canUndo());
+}
+
 void UndoManagerTest::resetAllChanged()
 {
 	loaded_changed   = false;
@@ -244,4 +381,4 @@ void UndoManagerTest::canRedoChanged(bool can_redo)
 }
 
 
-QTEST_GUILESS_MAIN(UndoManagerTest)
+QTEST_MAIN(UndoManagerTest)
@@ -36,6 +36,16 @@ private slots:
 	 */
 	void testUndoRedo();
 	
+	/**
+	 * Tests the memory limit, with and without spilling to a temporary file.
+	 */
+	void testMemoryLimit();
+	
+	/**
+	 * Tests restoring and invalidating undo steps which were spilled to a file.
+	 */
+	void testSpilledUndoSteps();
+	
 private:
 	bool clean_changed;
 	bool clean;
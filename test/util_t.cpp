@@ -18,12 +18,21 @@
  */
 
 
+#include <algorithm>
+
 #include <QtTest>
+#include <QBuffer>
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLatin1String>
 #include <QObject>
 #include <QPointF>
 #include <QRectF>
 
 #include "core/map_coord.h"
+#include "util/profiler.h"
 #include "util/util.h"
 
 using namespace OpenOrienteering;
@@ -43,6 +52,7 @@ private slots:
 	void rectIncludeSafeTest();
 	void pointsFormCorner_data();
 	void pointsFormCorner();
+	void profilerTest();
 };
 
 
@@ -177,5 +187,54 @@ void UtilTest::pointsFormCorner()
 }
 
 
+void UtilTest::profilerTest()
+{
+	Profiler::clear();
+	QVERIFY(!Profiler::isEnabled());
+	{
+		Profiler::Scope profile("disabled");
+	}
+	QVERIFY(Profiler::takeFrame().scopes.empty());
+	
+	Profiler::setEnabled(true);
+	for (int i = 0; i < 3; ++i)
+	{
+		Profiler::Scope outer("outer");
+		Profiler::Scope inner("inner");
+	}
+	Profiler::setEnabled(false);
+	
+	auto const frame = Profiler::takeFrame();
+	QCOMPARE(int(frame.scopes.size()), 2);
+	// Equal totals may come in any order.
+	auto const find = [&frame](const char* name) {
+		return std::find_if(begin(frame.scopes), end(frame.scopes), [name](const auto& scope) {
+			return QLatin1String(scope.name) == QLatin1String(name);
+		});
+	};
+	auto const outer = find("outer");
+	auto const inner = find("inner");
+	QVERIFY(outer != end(frame.scopes));
+	QVERIFY(inner != end(frame.scopes));
+	QCOMPARE(outer->count, 3);
+	QCOMPARE(inner->count, 3);
+	QVERIFY(outer->total >= inner->total);
+	QVERIFY(outer->maximum <= outer->total);
+	QVERIFY(frame.scopes.front().total >= frame.scopes.back().total);
+	QVERIFY(Profiler::takeFrame().scopes.empty());
+	
+	QBuffer buffer;
+	QVERIFY(buffer.open(QIODevice::WriteOnly));
+	QVERIFY(Profiler::writeChromeTrace(buffer));
+	auto const trace = QJsonDocument::fromJson(buffer.data());
+	QVERIFY(trace.isObject());
+	auto const events = trace.object().value(QLatin1String("traceEvents")).toArray();
+	QCOMPARE(events.size(), 6);
+	QCOMPARE(events.first().toObject().value(QLatin1String("ph")).toString(), QString::fromLatin1("X"));
+	
+	Profiler::clear();
+}
+
+
 QTEST_APPLESS_MAIN(UtilTest)
 #include "util_t.moc"  // IWYU pragma: keep